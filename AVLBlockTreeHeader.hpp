@@ -0,0 +1,209 @@
+#ifndef AVLBLOCKTREEHPP
+#define AVLBLOCKTREEHPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "AVLTreeHeader.hpp"
+
+/***************************************
+ * AVLSimdSearchable
+ *
+ * True for key/comparator pairs whose order is the machine order of a
+ * 4- or 8-byte arithmetic type: int32_t, uint64_t, float, double and
+ * the like under std::less<T> or std::less<>. Blocks of such keys are
+ * searched with vector compares.
+ ***************************************/
+template <typename T, typename Compare>
+struct AVLSimdSearchable
+    : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                       (sizeof(T) == 4 || sizeof(T) == 8) &&
+                                       (std::is_same<Compare, std::less<T> >::value ||
+                                        std::is_same<Compare, std::less<> >::value)> {};
+
+
+/***************************************
+ * AVLBlockTree
+ *
+ * An AVL set whose nodes each hold a sorted block of up to block_keys
+ * keys instead of one. The tree orders blocks by their key ranges,
+ * so it is block_keys times smaller and about four levels shorter
+ * than an AVLTree of the same keys. Each level costs at most two
+ * comparisons against the block's ends. The block that can hold the
+ * key is then searched in one go: with vector compares for
+ * AVLSimdSearchable keys (AVX2 when compiled with it, otherwise a
+ * branchless loop the compiler vectorizes), or by binary search for
+ * any other key type.
+ *
+ * A full block splits in two as it overflows (appending to the
+ * largest block starts a new one, so ascending input fills blocks
+ * completely). A block that drains below a quarter merges with a
+ * neighbour. Keys move within and between blocks, so unlike
+ * AVLTree, every insert or erase invalidates all iterators.
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class AVLBlockTree {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_default_constructible<T>::value,
+                  "AVLBlockTree shifts keys within blocks as plain values");
+
+public:
+    static constexpr std::size_t block_keys = 16;
+
+private:
+    // The keys come first so that a block starts on the node's
+    // allocation boundary. Slots from count on repeat the largest key,
+    // so a full-width compare never needs a mask.
+    struct Node {
+        T keys[block_keys];
+        Node* left;
+        Node* right;
+        Node* parent;
+        std::uint8_t count;
+        std::int8_t height;
+
+        explicit Node(Node* par) : left(nullptr), right(nullptr), parent(par), count(0), height(1) {}
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+    static constexpr bool simd_keys = AVLSimdSearchable<T, Compare>::value;
+
+    Node* root;
+    std::size_t tree_size;
+    Compare comp;
+    NodeAllocator node_alloc;
+
+    Node* createNode(Node* parent);
+    void destroyNode(Node* node);
+    Node* cloneSubtree(const Node* source, Node* parent);
+    void clear(Node* node);
+    static int height(const Node* node);
+    static int getBalanceFactor(const Node* node);
+    static void updateHeight(Node* node);
+    static Node* rightRotate(Node* y);
+    static Node* leftRotate(Node* x);
+    void replaceChild(Node* parent, Node* oldChild, Node* newChild);
+    Node* rebalance(Node* node);
+    void retraceInsert(Node* node);
+    void retraceErase(Node* node);
+    static Node* minValueNode(Node* node);
+    static Node* maxValueNode(Node* node);
+    static Node* nextNode(Node* node);
+    static Node* prevNode(Node* node);
+    void linkAfter(Node* node, Node* block);
+    void unlinkNode(Node* node);
+    static void setKeys(Node* node, const T* keys, std::size_t n);
+    static std::size_t vectorCountLess(const T* keys, T key);
+    static std::size_t vectorCountNotGreater(const T* keys, T key);
+    std::size_t countLess(const Node* node, const T& key) const;
+    std::size_t countNotGreater(const Node* node, const T& key) const;
+    Node* findBlock(const T& key) const;
+    Node* insertAt(Node* node, std::size_t& pos, const T& key);
+    void mergeIfSparse(Node* node);
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    class const_iterator {
+        friend class AVLBlockTree;
+    private:
+        const Node* node;
+        std::size_t index;
+        const AVLBlockTree* tree;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : node(nullptr), index(0), tree(nullptr) {}
+        const_iterator(const Node* n, std::size_t i, const AVLBlockTree* t) : node(n), index(i), tree(t) {}
+
+        reference operator*() const {
+            return node->keys[index];
+        }
+        pointer operator->() const {
+            return &node->keys[index];
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+
+        bool operator==(const const_iterator& other) const {
+            return node == other.node && index == other.index;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // Keys are immutable once stored, so both names refer to one type.
+    using iterator = const_iterator;
+
+    AVLBlockTree();
+    explicit AVLBlockTree(const Compare& compare, const Allocator& alloc = Allocator());
+    AVLBlockTree(const AVLBlockTree& other);
+    AVLBlockTree(AVLBlockTree&& other) noexcept;
+    ~AVLBlockTree();
+
+    AVLBlockTree& operator=(const AVLBlockTree& other);
+    AVLBlockTree& operator=(AVLBlockTree&& other) noexcept;
+    void swap(AVLBlockTree& other) noexcept;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    std::size_t size() const;
+    std::pair<iterator, bool> insert(const T& key);
+    std::size_t erase(const T& key);
+    void clear();
+    const_iterator find(const T& key) const;
+    const_iterator lower_bound(const T& key) const;
+    const_iterator upper_bound(const T& key) const;
+    bool contains(const T& key) const;
+    std::size_t count(const T& key) const;
+};
+
+template <typename T, typename Compare, typename Allocator>
+void swap(AVLBlockTree<T, Compare, Allocator>& a, AVLBlockTree<T, Compare, Allocator>& b) noexcept {
+    a.swap(b);
+}
+
+
+/***************************************
+ * AVLFastSet
+ *
+ * Picks a set layout from the key type at compile time: AVLBlockTree
+ * for AVLSimdSearchable keys, the generic one-key-per-node AVLTree
+ * for everything else. Both offer the same lookup and iteration
+ * interface.
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+using AVLFastSet = typename std::conditional<AVLSimdSearchable<T, Compare>::value,
+                                             AVLBlockTree<T, Compare, Allocator>,
+                                             AVLTree<T, Compare, Allocator> >::type;
+
+#include "AVLBlockTreeImplementation.tpp"
+
+#endif
@@ -0,0 +1,1093 @@
+#include "AVLBlockTreeHeader.hpp"
+
+/***************************************
+ * AVLBlockTree Constructor
+ *
+ * Initializes an empty block tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>::AVLBlockTree()
+    : root(nullptr), tree_size(0), comp(Compare()), node_alloc(Allocator()) {}
+
+
+/***************************************
+ * AVLBlockTree Constructor (comparator and allocator)
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>::AVLBlockTree(const Compare& compare, const Allocator& alloc)
+    : root(nullptr), tree_size(0), comp(compare), node_alloc(alloc) {}
+
+
+/***************************************
+ * AVLBlockTree Copy Constructor
+ *
+ * Clones the block structure of another tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>::AVLBlockTree(const AVLBlockTree& other)
+    : root(nullptr), tree_size(0), comp(other.comp),
+      node_alloc(NodeAllocTraits::select_on_container_copy_construction(other.node_alloc)) {
+    root = cloneSubtree(other.root, nullptr);
+    tree_size = other.tree_size;
+}
+
+
+/***************************************
+ * AVLBlockTree Move Constructor
+ *
+ * Takes over another tree's blocks in O(1), leaving it empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>::AVLBlockTree(AVLBlockTree&& other) noexcept
+    : root(other.root), tree_size(other.tree_size), comp(other.comp), node_alloc(other.node_alloc) {
+    other.root = nullptr;
+    other.tree_size = 0;
+}
+
+
+/***************************************
+ * AVLBlockTree Destructor
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>::~AVLBlockTree() {
+    clear();
+}
+
+
+/***************************************
+ * operator= (copy assignment)
+ *
+ * Replaces the contents with a deep copy of another tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>& AVLBlockTree<T, Compare, Allocator>::operator=(const AVLBlockTree& other) {
+    if (this != &other) {
+        AVLBlockTree copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+
+/***************************************
+ * operator= (move assignment)
+ *
+ * Swaps contents with other; other's old blocks are freed when it is
+ * destroyed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLBlockTree<T, Compare, Allocator>& AVLBlockTree<T, Compare, Allocator>::operator=(AVLBlockTree&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+
+/***************************************
+ * swap
+ *
+ * Exchanges the contents of two trees in O(1).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::swap(AVLBlockTree& other) noexcept {
+    using std::swap;
+    swap(root, other.root);
+    swap(tree_size, other.tree_size);
+    swap(comp, other.comp);
+    swap(node_alloc, other.node_alloc);
+}
+
+
+/***************************************
+ * createNode (private helper)
+ *
+ * Allocates an empty block.
+ *
+ * Parameters:
+ *  - parent: Pointer to the parent node.
+ *
+ * Returns:
+ *  - Pointer to the new leaf node; its keys are set by the caller.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::createNode(Node* parent) {
+    Node* node = NodeAllocTraits::allocate(node_alloc, 1);
+    NodeAllocTraits::construct(node_alloc, node, parent);
+    return node;
+}
+
+
+/***************************************
+ * destroyNode (private helper)
+ *
+ * Destroys a single node and returns its storage.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::destroyNode(Node* node) {
+    NodeAllocTraits::destroy(node_alloc, node);
+    NodeAllocTraits::deallocate(node_alloc, node, 1);
+}
+
+
+/***************************************
+ * cloneSubtree (private helper)
+ *
+ * Recursively copies a subtree; recursion depth is the tree height.
+ *
+ * Parameters:
+ *  - source: Root of the subtree to copy.
+ *  - parent: Parent for the copied root.
+ *
+ * Returns:
+ *  - Root of the copy. If an allocation throws, the partial copy is
+ *    freed before rethrowing.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::cloneSubtree(const Node* source, Node* parent) {
+    if (!source) {
+        return nullptr;
+    }
+    Node* node = createNode(parent);
+    std::copy(source->keys, source->keys + block_keys, node->keys);
+    node->count = source->count;
+    node->height = source->height;
+    try {
+        node->left = cloneSubtree(source->left, node);
+        node->right = cloneSubtree(source->right, node);
+    }
+    catch (...) {
+        clear(node);
+        throw;
+    }
+    return node;
+}
+
+
+/***************************************
+ * clear (private recursive helper)
+ *
+ * Frees every block in a subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::clear(Node* node) {
+    if (!node) {
+        return;
+    }
+    clear(node->left);
+    clear(node->right);
+    destroyNode(node);
+}
+
+
+/***************************************
+ * height (private helper)
+ *
+ * Returns:
+ *  - The node's height, or 0 if the node is nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLBlockTree<T, Compare, Allocator>::height(const Node* node) {
+    return node ? node->height : 0;
+}
+
+
+/***************************************
+ * getBalanceFactor (private helper)
+ *
+ * Returns:
+ *  - Height of the left subtree minus height of the right subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLBlockTree<T, Compare, Allocator>::getBalanceFactor(const Node* node) {
+    return node ? height(node->left) - height(node->right) : 0;
+}
+
+
+/***************************************
+ * updateHeight (private helper)
+ *
+ * Recomputes a node's height from its children.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::updateHeight(Node* node) {
+    node->height = static_cast<std::int8_t>(1 + std::max(height(node->left), height(node->right)));
+}
+
+
+/***************************************
+ * rightRotate (private helper)
+ *
+ * Performs a right rotation on the subtree rooted at y.
+ *
+ * Returns:
+ *  - The new root after rotation; its parent link is taken over
+ *    from y, but the parent's child pointer is left to the caller.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::rightRotate(Node* y) {
+    Node* x = y->left;
+    Node* T2 = x->right;
+
+    x->right = y;
+    y->left = T2;
+
+    x->parent = y->parent;
+    y->parent = x;
+    if (T2) {
+        T2->parent = y;
+    }
+
+    updateHeight(y);
+    updateHeight(x);
+    return x;
+}
+
+
+/***************************************
+ * leftRotate (private helper)
+ *
+ * Mirror image of rightRotate.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::leftRotate(Node* x) {
+    Node* y = x->right;
+    Node* T2 = y->left;
+
+    y->left = x;
+    x->right = T2;
+
+    y->parent = x->parent;
+    x->parent = y;
+    if (T2) {
+        T2->parent = x;
+    }
+
+    updateHeight(x);
+    updateHeight(y);
+    return y;
+}
+
+
+/***************************************
+ * replaceChild (private helper)
+ *
+ * Re-points the parent link that referred to oldChild; updates root
+ * when parent is nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::replaceChild(Node* parent, Node* oldChild, Node* newChild) {
+    if (!parent) {
+        root = newChild;
+    }
+    else if (parent->left == oldChild) {
+        parent->left = newChild;
+    }
+    else {
+        parent->right = newChild;
+    }
+}
+
+
+/***************************************
+ * rebalance (private helper)
+ *
+ * Restores the AVL property at a node whose balance factor is +-2.
+ *
+ * Returns:
+ *  - The new root of the subtree, already linked into node's parent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::rebalance(Node* node) {
+    Node* parent = node->parent;
+    Node* subtree;
+    if (getBalanceFactor(node) > 1) {
+        if (getBalanceFactor(node->left) < 0) {
+            node->left = leftRotate(node->left);
+        }
+        subtree = rightRotate(node);
+    }
+    else {
+        if (getBalanceFactor(node->right) > 0) {
+            node->right = rightRotate(node->right);
+        }
+        subtree = leftRotate(node);
+    }
+    replaceChild(parent, node, subtree);
+    return subtree;
+}
+
+
+/***************************************
+ * retraceInsert (private helper)
+ *
+ * Walks from a freshly linked block towards the root fixing heights;
+ * stops at the first rotation or unchanged height.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::retraceInsert(Node* node) {
+    for (Node* p = node->parent; p; p = p->parent) {
+        int oldHeight = p->height;
+        updateHeight(p);
+        int balance = getBalanceFactor(p);
+        if (balance > 1 || balance < -1) {
+            rebalance(p);
+            break;
+        }
+        if (p->height == oldHeight) {
+            break;
+        }
+    }
+}
+
+
+/***************************************
+ * retraceErase (private helper)
+ *
+ * Walks from the lowest node that lost a descendant towards the root,
+ * rebalancing until a subtree's height comes out unchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::retraceErase(Node* node) {
+    while (node) {
+        int oldHeight = node->height;
+        updateHeight(node);
+        int balance = getBalanceFactor(node);
+        if (balance > 1 || balance < -1) {
+            node = rebalance(node);
+        }
+        bool unchanged = node->height == oldHeight;
+        node = node->parent;
+        if (unchanged) {
+            break;
+        }
+    }
+}
+
+
+/***************************************
+ * minValueNode / maxValueNode (private helpers)
+ *
+ * Returns:
+ *  - The first or last block of a subtree, or nullptr if it is empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::minValueNode(Node* node) {
+    while (node && node->left) {
+        node = node->left;
+    }
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::maxValueNode(Node* node) {
+    while (node && node->right) {
+        node = node->right;
+    }
+    return node;
+}
+
+
+/***************************************
+ * nextNode / prevNode (private helpers)
+ *
+ * Returns:
+ *  - The in-order successor or predecessor block, or nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::nextNode(Node* node) {
+    if (node->right) {
+        return minValueNode(node->right);
+    }
+    Node* parent = node->parent;
+    while (parent && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::prevNode(Node* node) {
+    if (node->left) {
+        return maxValueNode(node->left);
+    }
+    Node* parent = node->parent;
+    while (parent && node == parent->left) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+
+/***************************************
+ * linkAfter (private helper)
+ *
+ * Links a new block as the in-order successor of another and
+ * rebalances.
+ *
+ * Parameters:
+ *  - node: The new, detached block.
+ *  - block: The block it follows; linked.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::linkAfter(Node* node, Node* block) {
+    if (!block->right) {
+        block->right = node;
+        node->parent = block;
+    }
+    else {
+        Node* first = minValueNode(block->right);
+        first->left = node;
+        node->parent = first;
+    }
+    retraceInsert(node);
+}
+
+
+/***************************************
+ * unlinkNode (private helper)
+ *
+ * Detaches a block from the tree and rebalances bottom-up.
+ *
+ * Behavior:
+ *  - A block with two children is replaced by its in-order successor,
+ *    which is relinked into its place, so no keys are copied.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::unlinkNode(Node* node) {
+    if (node->left && node->right) {
+        Node* successor = minValueNode(node->right);
+        Node* retraceFrom = successor;
+        if (successor->parent != node) {
+            retraceFrom = successor->parent;
+            retraceFrom->left = successor->right;
+            if (successor->right) {
+                successor->right->parent = retraceFrom;
+            }
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->parent = node->parent;
+        successor->height = node->height;
+        replaceChild(node->parent, node, successor);
+        retraceErase(retraceFrom);
+        return;
+    }
+
+    Node* child = node->left ? node->left : node->right;
+    Node* parent = node->parent;
+    if (child) {
+        child->parent = parent;
+    }
+    replaceChild(parent, node, child);
+    retraceErase(parent);
+}
+
+
+/***************************************
+ * setKeys (private helper)
+ *
+ * Fills a block with n sorted keys and pads the unused slots with
+ * the largest one.
+ *
+ * Parameters:
+ *  - node: The block.
+ *  - keys: The keys; may alias node->keys.
+ *  - n: How many; 1 to block_keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::setKeys(Node* node, const T* keys, std::size_t n) {
+    if (keys != node->keys) {
+        std::copy(keys, keys + n, node->keys);
+    }
+    std::fill(node->keys + n, node->keys + block_keys, node->keys[n - 1]);
+    node->count = static_cast<std::uint8_t>(n);
+}
+
+
+/***************************************
+ * vectorCountLess (private helper)
+ *
+ * Counts the keys below key across all block_keys slots of an
+ * AVLSimdSearchable block.
+ *
+ * Behavior:
+ *  - With AVX2, one compare and movemask per 32 bytes of keys;
+ *    unsigned integers are compared as signed after flipping their
+ *    sign bits. Otherwise a fixed-length branchless loop, which the
+ *    compiler turns into SSE or NEON compares at -O2 and above.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::vectorCountLess(const T* keys, T key) {
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    std::size_t n = 0;
+    if constexpr (std::is_same<T, float>::value) {
+        const __m256 probe = _mm256_set1_ps(key);
+        for (std::size_t i = 0; i < block_keys; i += 8) {
+            const __m256 less = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), probe, _CMP_LT_OQ);
+            n += static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_ps(less)));
+        }
+        return n;
+    }
+    else if constexpr (std::is_same<T, double>::value) {
+        const __m256d probe = _mm256_set1_pd(key);
+        for (std::size_t i = 0; i < block_keys; i += 4) {
+            const __m256d less = _mm256_cmp_pd(_mm256_loadu_pd(keys + i), probe, _CMP_LT_OQ);
+            n += static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_pd(less)));
+        }
+        return n;
+    }
+    else if constexpr (std::is_integral<T>::value && sizeof(T) == 4) {
+        const __m256i bias = _mm256_set1_epi32(std::is_signed<T>::value ? 0 : INT32_MIN);
+        const __m256i probe = _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(key)), bias);
+        for (std::size_t i = 0; i < block_keys; i += 8) {
+            const __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            const __m256i less = _mm256_cmpgt_epi32(probe, block);
+            n += static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(less))));
+        }
+        return n;
+    }
+    else if constexpr (std::is_integral<T>::value && sizeof(T) == 8) {
+        const __m256i bias = _mm256_set1_epi64x(std::is_signed<T>::value ? 0 : INT64_MIN);
+        const __m256i probe = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<std::int64_t>(key)), bias);
+        for (std::size_t i = 0; i < block_keys; i += 4) {
+            const __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            const __m256i less = _mm256_cmpgt_epi64(probe, block);
+            n += static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less))));
+        }
+        return n;
+    }
+#endif
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < block_keys; ++i) {
+        count += static_cast<std::size_t>(keys[i] < key);
+    }
+    return count;
+}
+
+
+/***************************************
+ * vectorCountNotGreater (private helper)
+ *
+ * Counts the keys not greater than key; the counterpart of
+ * vectorCountLess for upper_bound.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::vectorCountNotGreater(const T* keys, T key) {
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    std::size_t n = 0;
+    if constexpr (std::is_same<T, float>::value) {
+        const __m256 probe = _mm256_set1_ps(key);
+        for (std::size_t i = 0; i < block_keys; i += 8) {
+            const __m256 notGreater = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), probe, _CMP_LE_OQ);
+            n += static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_ps(notGreater)));
+        }
+        return n;
+    }
+    else if constexpr (std::is_same<T, double>::value) {
+        const __m256d probe = _mm256_set1_pd(key);
+        for (std::size_t i = 0; i < block_keys; i += 4) {
+            const __m256d notGreater = _mm256_cmp_pd(_mm256_loadu_pd(keys + i), probe, _CMP_LE_OQ);
+            n += static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_pd(notGreater)));
+        }
+        return n;
+    }
+    else if constexpr (std::is_integral<T>::value && sizeof(T) == 4) {
+        const __m256i bias = _mm256_set1_epi32(std::is_signed<T>::value ? 0 : INT32_MIN);
+        const __m256i probe = _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(key)), bias);
+        for (std::size_t i = 0; i < block_keys; i += 8) {
+            const __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            const __m256i greater = _mm256_cmpgt_epi32(block, probe);
+            n += 8 - static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(greater))));
+        }
+        return n;
+    }
+    else if constexpr (std::is_integral<T>::value && sizeof(T) == 8) {
+        const __m256i bias = _mm256_set1_epi64x(std::is_signed<T>::value ? 0 : INT64_MIN);
+        const __m256i probe = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<std::int64_t>(key)), bias);
+        for (std::size_t i = 0; i < block_keys; i += 4) {
+            const __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            const __m256i greater = _mm256_cmpgt_epi64(block, probe);
+            n += 4 - static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(greater))));
+        }
+        return n;
+    }
+#endif
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < block_keys; ++i) {
+        count += static_cast<std::size_t>(!(key < keys[i]));
+    }
+    return count;
+}
+
+
+/***************************************
+ * countLess (private helper)
+ *
+ * Returns:
+ *  - The position of the first key in the block not less than key.
+ *    key must not exceed the block's largest key, so the padding
+ *    slots never count.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::countLess(const Node* node, const T& key) const {
+    if constexpr (simd_keys) {
+        return vectorCountLess(node->keys, key);
+    }
+    else {
+        return static_cast<std::size_t>(std::lower_bound(node->keys, node->keys + node->count, key, comp) - node->keys);
+    }
+}
+
+
+/***************************************
+ * countNotGreater (private helper)
+ *
+ * Returns:
+ *  - The position of the first key in the block greater than key,
+ *    which must be less than the block's largest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::countNotGreater(const Node* node, const T& key) const {
+    if constexpr (simd_keys) {
+        return vectorCountNotGreater(node->keys, key);
+    }
+    else {
+        return static_cast<std::size_t>(std::upper_bound(node->keys, node->keys + node->count, key, comp) - node->keys);
+    }
+}
+
+
+/***************************************
+ * findBlock (private helper)
+ *
+ * Descends to the block a key belongs in. The tree must not be
+ * empty.
+ *
+ * Returns:
+ *  - The block whose range holds key, or failing that the block at
+ *    which the descent ran out; key lies between that block and its
+ *    neighbour in the direction it would have gone.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::findBlock(const T& key) const {
+    Node* node = root;
+    while (true) {
+        if (comp(key, node->keys[0])) {
+            if (!node->left) {
+                return node;
+            }
+            node = node->left;
+        }
+        else if (comp(node->keys[node->count - 1], key)) {
+            if (!node->right) {
+                return node;
+            }
+            node = node->right;
+        }
+        else {
+            return node;
+        }
+    }
+}
+
+
+/***************************************
+ * insertAt (private helper)
+ *
+ * Inserts a key into a block at a position, splitting a full block.
+ *
+ * Parameters:
+ *  - node: The block key belongs in.
+ *  - pos: Where key goes among the block's keys; on return, its
+ *    position in the block that holds it.
+ *  - key: The new key.
+ *
+ * Returns:
+ *  - The block that holds key.
+ *
+ * Behavior:
+ *  - A full block keeps its lower half and moves the upper half into
+ *    a new successor block. A key appended past the end of a full
+ *    block starts the new block by itself instead, so ascending
+ *    insertion leaves every block full.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::Node* AVLBlockTree<T, Compare, Allocator>::insertAt(Node* node, std::size_t& pos, const T& key) {
+    const std::size_t n = node->count;
+    if (n < block_keys) {
+        std::copy_backward(node->keys + pos, node->keys + n, node->keys + n + 1);
+        node->keys[pos] = key;
+        setKeys(node, node->keys, n + 1);
+        return node;
+    }
+
+    Node* fresh = createNode(nullptr);
+    Node* holder;
+    if (pos == n) {
+        setKeys(fresh, &key, 1);
+        holder = fresh;
+        pos = 0;
+    }
+    else {
+        T merged[block_keys + 1];
+        std::copy(node->keys, node->keys + pos, merged);
+        merged[pos] = key;
+        std::copy(node->keys + pos, node->keys + n, merged + pos + 1);
+        const std::size_t keep = (block_keys + 1) / 2;
+        setKeys(node, merged, keep);
+        setKeys(fresh, merged + keep, block_keys + 1 - keep);
+        holder = pos < keep ? node : fresh;
+        if (pos >= keep) {
+            pos -= keep;
+        }
+    }
+    linkAfter(fresh, node);
+    return holder;
+}
+
+
+/***************************************
+ * mergeIfSparse (private helper)
+ *
+ * Folds a block that has drained below a quarter into a neighbour
+ * when their keys fit into one block.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::mergeIfSparse(Node* node) {
+    if (node->count >= block_keys / 4) {
+        return;
+    }
+    Node* next = nextNode(node);
+    if (next && node->count + next->count <= block_keys) {
+        std::copy(next->keys, next->keys + next->count, node->keys + node->count);
+        setKeys(node, node->keys, node->count + next->count);
+        unlinkNode(next);
+        destroyNode(next);
+        return;
+    }
+    Node* prev = prevNode(node);
+    if (prev && prev->count + node->count <= block_keys) {
+        std::copy(node->keys, node->keys + node->count, prev->keys + prev->count);
+        setKeys(prev, prev->keys, prev->count + node->count);
+        unlinkNode(node);
+        destroyNode(node);
+    }
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::begin() const {
+    return const_iterator(minValueNode(root), 0, this);
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - The past-the-end iterator.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::end() const {
+    return const_iterator(nullptr, 0, this);
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the tree holds no keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLBlockTree<T, Compare, Allocator>::empty() const {
+    return tree_size == 0;
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::size() const {
+    return tree_size;
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a key unless an equivalent one is present.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - O(log n): one descent over the blocks, a search within one
+ *    block and a shift of at most block_keys keys. Invalidates all
+ *    iterators when it inserts.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLBlockTree<T, Compare, Allocator>::iterator, bool> AVLBlockTree<T, Compare, Allocator>::insert(const T& key) {
+    if (!root) {
+        root = createNode(nullptr);
+        setKeys(root, &key, 1);
+        tree_size = 1;
+        return std::make_pair(iterator(root, 0, this), true);
+    }
+    Node* node = findBlock(key);
+    std::size_t pos = comp(node->keys[node->count - 1], key) ? node->count : countLess(node, key);
+    if (pos < node->count && !comp(key, node->keys[pos])) {
+        return std::make_pair(iterator(node, pos, this), false);
+    }
+    Node* holder = insertAt(node, pos, key);
+    ++tree_size;
+    return std::make_pair(iterator(holder, pos, this), true);
+}
+
+
+/***************************************
+ * erase
+ *
+ * Removes a key if present.
+ *
+ * Returns:
+ *  - The number of keys removed (0 or 1).
+ *
+ * Behavior:
+ *  - An emptied block is unlinked and a sparse one merged into a
+ *    neighbour. Invalidates all iterators when it removes a key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::erase(const T& key) {
+    const_iterator it = find(key);
+    if (it == end()) {
+        return 0;
+    }
+    Node* node = const_cast<Node*>(it.node);
+    const std::size_t n = node->count;
+    --tree_size;
+    if (n == 1) {
+        unlinkNode(node);
+        destroyNode(node);
+        return 1;
+    }
+    std::copy(node->keys + it.index + 1, node->keys + n, node->keys + it.index);
+    setKeys(node, node->keys, n - 1);
+    mergeIfSparse(node);
+    return 1;
+}
+
+
+/***************************************
+ * clear
+ *
+ * Removes every key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLBlockTree<T, Compare, Allocator>::clear() {
+    clear(root);
+    root = nullptr;
+    tree_size = 0;
+}
+
+
+/***************************************
+ * find
+ *
+ * Searches for a key.
+ *
+ * Returns:
+ *  - An iterator to the key, or end().
+ *
+ * Behavior:
+ *  - Compares against the ends of each block on the way down and
+ *    searches the one block that spans key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::find(const T& key) const {
+    const Node* node = root;
+    while (node) {
+        if (comp(key, node->keys[0])) {
+            node = node->left;
+        }
+        else if (comp(node->keys[node->count - 1], key)) {
+            node = node->right;
+        }
+        else {
+            const std::size_t pos = countLess(node, key);
+            return comp(key, node->keys[pos]) ? end() : const_iterator(node, pos, this);
+        }
+    }
+    return end();
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Returns:
+ *  - An iterator to the first key not less than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::lower_bound(const T& key) const {
+    const Node* node = root;
+    const Node* result = nullptr;
+    while (node) {
+        if (!comp(node->keys[0], key)) {
+            result = node;
+            node = node->left;
+        }
+        else if (comp(node->keys[node->count - 1], key)) {
+            node = node->right;
+        }
+        else {
+            return const_iterator(node, countLess(node, key), this);
+        }
+    }
+    return const_iterator(result, 0, this);
+}
+
+
+/***************************************
+ * upper_bound
+ *
+ * Returns:
+ *  - An iterator to the first key greater than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::upper_bound(const T& key) const {
+    const Node* node = root;
+    const Node* result = nullptr;
+    while (node) {
+        if (comp(key, node->keys[0])) {
+            result = node;
+            node = node->left;
+        }
+        else if (!comp(key, node->keys[node->count - 1])) {
+            node = node->right;
+        }
+        else {
+            return const_iterator(node, countNotGreater(node, key), this);
+        }
+    }
+    return const_iterator(result, 0, this);
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLBlockTree<T, Compare, Allocator>::contains(const T& key) const {
+    return find(key) != end();
+}
+
+
+/***************************************
+ * count
+ *
+ * Returns:
+ *  - 1 if key is present, 0 otherwise.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLBlockTree<T, Compare, Allocator>::count(const T& key) const {
+    return contains(key) ? 1 : 0;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Steps within the block, then on to the first key of the next one.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator& AVLBlockTree<T, Compare, Allocator>::const_iterator::operator++() {
+    if (++index == node->count) {
+        node = nextNode(const_cast<Node*>(node));
+        index = 0;
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Pre-decrement)
+ *
+ * Steps back within the block, or to the last key of the previous
+ * one; from end() it moves to the largest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator& AVLBlockTree<T, Compare, Allocator>::const_iterator::operator--() {
+    if (!node) {
+        node = maxValueNode(tree->root);
+        index = node->count - 1;
+    }
+    else if (index > 0) {
+        --index;
+    }
+    else {
+        node = prevNode(const_cast<Node*>(node));
+        index = node->count - 1;
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Post-decrement)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLBlockTree<T, Compare, Allocator>::const_iterator AVLBlockTree<T, Compare, Allocator>::const_iterator::operator--(int) {
+    const_iterator temp = *this;
+    --(*this);
+    return temp;
+}
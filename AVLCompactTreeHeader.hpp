@@ -0,0 +1,148 @@
+#ifndef AVLCOMPACTTREEHPP
+#define AVLCOMPACTTREEHPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+/***************************************
+ * AVLCompactTree
+ *
+ * A parent-pointer-free AVL set with a one-byte height per node.
+ * For AVLTree<uint32_t> a node shrinks from 32 to 24 bytes. Insert
+ * and erase retrace along an explicit path instead of parent links,
+ * and iterators carry the root-to-node path in a fixed-size stack.
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class AVLCompactTree {
+private:
+    struct Node {
+        Node* left;
+        Node* right;
+        T key;
+        std::int8_t height;
+
+        template <typename... Args>
+        explicit Node(Args&&... args)
+            : left(nullptr), right(nullptr), key(std::forward<Args>(args)...), height(1) {}
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+public:
+    // An AVL tree of height 64 holds at least F(66) - 1 > 2.7e13 nodes,
+    // far beyond any addressable tree of this layout.
+    static constexpr std::size_t max_depth = 64;
+
+private:
+    Node* root;
+    std::size_t tree_size;
+    Compare comp;
+    NodeAllocator node_alloc;
+
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+    void destroyNode(Node* node);
+    Node* cloneSubtree(const Node* source);
+    static int height(const Node* node);
+    static int getBalanceFactor(const Node* node);
+    static void updateHeight(Node* node);
+    static Node* rightRotate(Node* y);
+    static Node* leftRotate(Node* x);
+    static Node* rebalance(Node* node);
+    void clear(Node* node);
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    class const_iterator {
+        friend class AVLCompactTree;
+    private:
+        const Node* path[max_depth];
+        std::size_t depth;
+        const AVLCompactTree* tree;
+
+        void pushLeftSpine(const Node* node);
+        void pushRightSpine(const Node* node);
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : depth(0), tree(nullptr) {}
+        explicit const_iterator(const AVLCompactTree* t) : depth(0), tree(t) {}
+
+        reference operator*() const {
+            return path[depth - 1]->key;
+        }
+        pointer operator->() const {
+            return &(path[depth - 1]->key);
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+
+        bool operator==(const const_iterator& other) const {
+            return (depth ? path[depth - 1] : nullptr) == (other.depth ? other.path[other.depth - 1] : nullptr);
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // Keys are immutable once stored, so both names refer to one type.
+    using iterator = const_iterator;
+
+    AVLCompactTree();
+    explicit AVLCompactTree(const Compare& compare, const Allocator& alloc = Allocator());
+    AVLCompactTree(const AVLCompactTree& other);
+    AVLCompactTree(AVLCompactTree&& other) noexcept;
+    ~AVLCompactTree();
+
+    AVLCompactTree& operator=(const AVLCompactTree& other);
+    AVLCompactTree& operator=(AVLCompactTree&& other) noexcept;
+    void swap(AVLCompactTree& other) noexcept;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    std::size_t size() const;
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    std::pair<iterator, bool> insert(const T& key);
+    std::pair<iterator, bool> insert(T&& key);
+    std::size_t erase(const T& key);
+    void clear();
+    const_iterator find(const T& key) const;
+    const_iterator lower_bound(const T& key) const;
+    bool contains(const T& key) const;
+
+private:
+    template <typename Make>
+    std::pair<iterator, bool> insertWith(const T& key, Make&& make);
+};
+
+template <typename T, typename Compare, typename Allocator>
+void swap(AVLCompactTree<T, Compare, Allocator>& a, AVLCompactTree<T, Compare, Allocator>& b) noexcept {
+    a.swap(b);
+}
+
+#include "AVLCompactTreeImplementation.tpp"
+
+#endif
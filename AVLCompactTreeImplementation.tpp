@@ -0,0 +1,743 @@
+#include "AVLCompactTreeHeader.hpp"
+
+/***************************************
+ * AVLCompactTree Constructor
+ *
+ * Initializes an empty compact AVL tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>::AVLCompactTree()
+    : root(nullptr), tree_size(0), comp(Compare()), node_alloc(Allocator()) {}
+
+
+/***************************************
+ * AVLCompactTree Constructor (comparator and allocator)
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>::AVLCompactTree(const Compare& compare, const Allocator& alloc)
+    : root(nullptr), tree_size(0), comp(compare), node_alloc(alloc) {}
+
+
+/***************************************
+ * AVLCompactTree Copy Constructor
+ *
+ * Clones the node structure of another tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>::AVLCompactTree(const AVLCompactTree& other)
+    : root(nullptr), tree_size(0), comp(other.comp),
+      node_alloc(NodeAllocTraits::select_on_container_copy_construction(other.node_alloc)) {
+    root = cloneSubtree(other.root);
+    tree_size = other.tree_size;
+}
+
+
+/***************************************
+ * AVLCompactTree Move Constructor
+ *
+ * Takes over another tree's nodes in O(1), leaving it empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>::AVLCompactTree(AVLCompactTree&& other) noexcept
+    : root(other.root), tree_size(other.tree_size), comp(other.comp), node_alloc(other.node_alloc) {
+    other.root = nullptr;
+    other.tree_size = 0;
+}
+
+
+/***************************************
+ * AVLCompactTree Destructor
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>::~AVLCompactTree() {
+    clear();
+}
+
+
+/***************************************
+ * operator= (copy assignment)
+ *
+ * Replaces the contents with a deep copy of another tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>& AVLCompactTree<T, Compare, Allocator>::operator=(const AVLCompactTree& other) {
+    if (this != &other) {
+        AVLCompactTree copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+
+/***************************************
+ * operator= (move assignment)
+ *
+ * Swaps contents with other; other's old nodes are freed when it is
+ * destroyed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLCompactTree<T, Compare, Allocator>& AVLCompactTree<T, Compare, Allocator>::operator=(AVLCompactTree&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+
+/***************************************
+ * swap
+ *
+ * Exchanges the contents of two trees in O(1).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::swap(AVLCompactTree& other) noexcept {
+    using std::swap;
+    swap(root, other.root);
+    swap(tree_size, other.tree_size);
+    swap(comp, other.comp);
+    swap(node_alloc, other.node_alloc);
+}
+
+
+/***************************************
+ * createNode (private helper)
+ *
+ * Allocates and constructs a single node.
+ *
+ * Parameters:
+ *  - args: Arguments forwarded to the key's constructor.
+ *
+ * Returns:
+ *  - Pointer to the new leaf node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+typename AVLCompactTree<T, Compare, Allocator>::Node* AVLCompactTree<T, Compare, Allocator>::createNode(Args&&... args) {
+    Node* node = NodeAllocTraits::allocate(node_alloc, 1);
+    try {
+        NodeAllocTraits::construct(node_alloc, node, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        NodeAllocTraits::deallocate(node_alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+
+/***************************************
+ * destroyNode (private helper)
+ *
+ * Destroys a single node and returns its storage.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::destroyNode(Node* node) {
+    NodeAllocTraits::destroy(node_alloc, node);
+    NodeAllocTraits::deallocate(node_alloc, node, 1);
+}
+
+
+/***************************************
+ * cloneSubtree (private helper)
+ *
+ * Recursively copies a subtree; recursion depth is the tree height.
+ *
+ * Parameters:
+ *  - source: Root of the subtree to copy.
+ *
+ * Returns:
+ *  - Root of the copy. A throwing key copy frees the partial copy.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::Node* AVLCompactTree<T, Compare, Allocator>::cloneSubtree(const Node* source) {
+    if (!source) {
+        return nullptr;
+    }
+    Node* node = createNode(source->key);
+    node->height = source->height;
+    try {
+        node->left = cloneSubtree(source->left);
+        node->right = cloneSubtree(source->right);
+    }
+    catch (...) {
+        clear(node);
+        throw;
+    }
+    return node;
+}
+
+
+/***************************************
+ * height (private helper)
+ *
+ * Returns:
+ *  - The node's height, or 0 if the node is nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLCompactTree<T, Compare, Allocator>::height(const Node* node) {
+    return node ? node->height : 0;
+}
+
+
+/***************************************
+ * getBalanceFactor (private helper)
+ *
+ * Returns:
+ *  - Height of the left subtree minus height of the right subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLCompactTree<T, Compare, Allocator>::getBalanceFactor(const Node* node) {
+    return node ? height(node->left) - height(node->right) : 0;
+}
+
+
+/***************************************
+ * updateHeight (private helper)
+ *
+ * Recomputes a node's height from its children.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::updateHeight(Node* node) {
+    node->height = static_cast<std::int8_t>(1 + std::max(height(node->left), height(node->right)));
+}
+
+
+/***************************************
+ * rightRotate (private helper)
+ *
+ * Performs a right rotation on the subtree rooted at y.
+ *
+ * Returns:
+ *  - The new subtree root; the caller stores it in the parent link.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::Node* AVLCompactTree<T, Compare, Allocator>::rightRotate(Node* y) {
+    Node* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    updateHeight(y);
+    updateHeight(x);
+    return x;
+}
+
+
+/***************************************
+ * leftRotate (private helper)
+ *
+ * Performs a left rotation on the subtree rooted at x.
+ *
+ * Returns:
+ *  - The new subtree root; the caller stores it in the parent link.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::Node* AVLCompactTree<T, Compare, Allocator>::leftRotate(Node* x) {
+    Node* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    updateHeight(x);
+    updateHeight(y);
+    return y;
+}
+
+
+/***************************************
+ * rebalance (private helper)
+ *
+ * Restores the AVL property at a node whose balance factor is +-2.
+ *
+ * Returns:
+ *  - The new subtree root; the caller stores it in the parent link.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::Node* AVLCompactTree<T, Compare, Allocator>::rebalance(Node* node) {
+    if (getBalanceFactor(node) > 1) {
+        if (getBalanceFactor(node->left) < 0) {
+            node->left = leftRotate(node->left);
+        }
+        return rightRotate(node);
+    }
+    if (getBalanceFactor(node->right) > 0) {
+        node->right = rightRotate(node->right);
+    }
+    return leftRotate(node);
+}
+
+
+/***************************************
+ * clear (private recursive helper)
+ *
+ * Frees every node in a subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::clear(Node* node) {
+    if (!node) {
+        return;
+    }
+    clear(node->left);
+    clear(node->right);
+    destroyNode(node);
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the tree has no nodes; otherwise false.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLCompactTree<T, Compare, Allocator>::empty() const {
+    return tree_size == 0;
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys in the tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLCompactTree<T, Compare, Allocator>::size() const {
+    return tree_size;
+}
+
+
+/***************************************
+ * insertWith (private helper)
+ *
+ * Inserts a node for key unless an equivalent key is present.
+ *
+ * Parameters:
+ *  - key: The key used for the descent.
+ *  - make: Callable returning the node to link; only invoked once the
+ *    slot is known to be free.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - Descends while recording the address of every child link on the
+ *    way, so the retrace can walk back up without parent pointers.
+ *  - Stops after the first rotation or the first unchanged height.
+ *  - The returned iterator's path is recomputed afterwards with one
+ *    more descent, since a rotation may have reshaped it.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Make>
+std::pair<typename AVLCompactTree<T, Compare, Allocator>::iterator, bool> AVLCompactTree<T, Compare, Allocator>::insertWith(const T& key, Make&& make) {
+    Node** links[max_depth + 1];
+    std::size_t depth = 0;
+    Node** link = &root;
+    while (*link) {
+        links[depth++] = link;
+        Node* current = *link;
+        if (comp(key, current->key)) {
+            link = &current->left;
+        }
+        else if (comp(current->key, key)) {
+            link = &current->right;
+        }
+        else {
+            return std::make_pair(find(current->key), false);
+        }
+    }
+    Node* node = make();
+    *link = node;
+    ++tree_size;
+
+    while (depth > 0) {
+        Node*& current = *links[--depth];
+        int oldHeight = current->height;
+        updateHeight(current);
+        int balance = getBalanceFactor(current);
+        if (balance > 1 || balance < -1) {
+            current = rebalance(current);
+            break;
+        }
+        if (current->height == oldHeight) {
+            break;
+        }
+    }
+    return std::make_pair(find(node->key), true);
+}
+
+
+/***************************************
+ * emplace
+ *
+ * Constructs a key in a new node and inserts it.
+ *
+ * Parameters:
+ *  - args: Arguments forwarded to T's constructor.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - The node is built first because its key drives the descent; it
+ *    is freed again if an equivalent key is found.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename AVLCompactTree<T, Compare, Allocator>::iterator, bool> AVLCompactTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    Node* node = createNode(std::forward<Args>(args)...);
+    std::pair<iterator, bool> result = insertWith(node->key, [node]() { return node; });
+    if (!result.second) {
+        destroyNode(node);
+    }
+    return result;
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a copy of key unless an equivalent key is present.
+ *
+ * Returns:
+ *  - Same as emplace().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLCompactTree<T, Compare, Allocator>::iterator, bool> AVLCompactTree<T, Compare, Allocator>::insert(const T& key) {
+    return insertWith(key, [this, &key]() { return createNode(key); });
+}
+
+
+/***************************************
+ * insert (move)
+ *
+ * Inserts key by moving it into a new node; key is left untouched if
+ * an equivalent key is present.
+ *
+ * Returns:
+ *  - Same as emplace().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLCompactTree<T, Compare, Allocator>::iterator, bool> AVLCompactTree<T, Compare, Allocator>::insert(T&& key) {
+    return insertWith(key, [this, &key]() { return createNode(std::move(key)); });
+}
+
+
+/***************************************
+ * erase
+ *
+ * Removes the key equivalent to key, if any.
+ *
+ * Returns:
+ *  - The number of keys removed (0 or 1).
+ *
+ * Behavior:
+ *  - A node with two children is replaced by relinking its in-order
+ *    successor into its place, so keys are never copied or moved.
+ *  - Retraces along the recorded link path until a subtree's height
+ *    comes out unchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLCompactTree<T, Compare, Allocator>::erase(const T& key) {
+    Node** links[max_depth + 1];
+    std::size_t depth = 0;
+    Node** link = &root;
+    while (*link) {
+        Node* current = *link;
+        if (comp(key, current->key)) {
+            links[depth++] = link;
+            link = &current->left;
+        }
+        else if (comp(current->key, key)) {
+            links[depth++] = link;
+            link = &current->right;
+        }
+        else {
+            break;
+        }
+    }
+    Node* target = *link;
+    if (!target) {
+        return 0;
+    }
+
+    if (!target->left || !target->right) {
+        *link = target->left ? target->left : target->right;
+    }
+    else {
+        // Record the path down to the successor, unlink it, then let it
+        // take target's place. The link into target's right subtree
+        // moves with it.
+        const std::size_t targetDepth = depth;
+        links[depth++] = link;
+        Node** successorLink = &target->right;
+        while ((*successorLink)->left) {
+            links[depth++] = successorLink;
+            successorLink = &(*successorLink)->left;
+        }
+        Node* successor = *successorLink;
+        *successorLink = successor->right;
+
+        successor->left = target->left;
+        successor->right = target->right;
+        successor->height = target->height;
+        *link = successor;
+        if (depth > targetDepth + 1) {
+            links[targetDepth + 1] = &successor->right;
+        }
+    }
+    destroyNode(target);
+    --tree_size;
+
+    while (depth > 0) {
+        Node*& current = *links[--depth];
+        int oldHeight = current->height;
+        updateHeight(current);
+        int balance = getBalanceFactor(current);
+        if (balance > 1 || balance < -1) {
+            current = rebalance(current);
+        }
+        if (current->height == oldHeight) {
+            break;
+        }
+    }
+    return 1;
+}
+
+
+/***************************************
+ * clear
+ *
+ * Frees every node and resets the tree to empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::clear() {
+    clear(root);
+    root = nullptr;
+    tree_size = 0;
+}
+
+
+/***************************************
+ * find
+ *
+ * Searches for a key.
+ *
+ * Returns:
+ *  - An iterator holding the path to the key, or end() if absent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::find(const T& key) const {
+    const_iterator it(this);
+    const Node* current = root;
+    while (current) {
+        it.path[it.depth++] = current;
+        if (comp(key, current->key)) {
+            current = current->left;
+        }
+        else if (comp(current->key, key)) {
+            current = current->right;
+        }
+        else {
+            return it;
+        }
+    }
+    return end();
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Finds the first key not less than key.
+ *
+ * Returns:
+ *  - An iterator to that key, or end().
+ *
+ * Behavior:
+ *  - The answer is the last node where the search turned left, so its
+ *    path is a prefix of the search path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::lower_bound(const T& key) const {
+    const_iterator it(this);
+    std::size_t candidateDepth = 0;
+    const Node* current = root;
+    while (current) {
+        it.path[it.depth++] = current;
+        if (!comp(current->key, key)) {
+            candidateDepth = it.depth;
+            current = current->left;
+        }
+        else {
+            current = current->right;
+        }
+    }
+    it.depth = candidateDepth;
+    return it;
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLCompactTree<T, Compare, Allocator>::contains(const T& key) const {
+    const Node* current = root;
+    while (current) {
+        if (comp(key, current->key)) {
+            current = current->left;
+        }
+        else if (comp(current->key, key)) {
+            current = current->right;
+        }
+        else {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::begin() const {
+    const_iterator it(this);
+    it.pushLeftSpine(root);
+    return it;
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - An iterator with an empty path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::end() const {
+    return const_iterator(this);
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * const_iterator::pushLeftSpine (Helper)
+ *
+ * Extends the path from node down to the minimum of its subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::const_iterator::pushLeftSpine(const Node* node) {
+    while (node) {
+        path[depth++] = node;
+        node = node->left;
+    }
+}
+
+
+/***************************************
+ * const_iterator::pushRightSpine (Helper)
+ *
+ * Extends the path from node down to the maximum of its subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLCompactTree<T, Compare, Allocator>::const_iterator::pushRightSpine(const Node* node) {
+    while (node) {
+        path[depth++] = node;
+        node = node->right;
+    }
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Advances to the in-order successor using the stored path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator& AVLCompactTree<T, Compare, Allocator>::const_iterator::operator++() {
+    if (depth == 0) {
+        return *this;
+    }
+    const Node* node = path[depth - 1];
+    if (node->right) {
+        pushLeftSpine(node->right);
+        return *this;
+    }
+    // Climb while we are coming back from a right child.
+    --depth;
+    while (depth && path[depth - 1]->right == node) {
+        node = path[--depth];
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Pre-decrement)
+ *
+ * Moves to the in-order predecessor; from end() it moves to the
+ * largest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator& AVLCompactTree<T, Compare, Allocator>::const_iterator::operator--() {
+    if (depth == 0) {
+        pushRightSpine(tree->root);
+        return *this;
+    }
+    const Node* node = path[depth - 1];
+    if (node->left) {
+        pushRightSpine(node->left);
+        return *this;
+    }
+    --depth;
+    while (depth && path[depth - 1]->left == node) {
+        node = path[--depth];
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Post-decrement)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLCompactTree<T, Compare, Allocator>::const_iterator AVLCompactTree<T, Compare, Allocator>::const_iterator::operator--(int) {
+    const_iterator temp = *this;
+    --(*this);
+    return temp;
+}
@@ -0,0 +1,236 @@
+#ifndef AVLCONCURRENTTREEHPP
+#define AVLCONCURRENTTREEHPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/***************************************
+ * AVLSpinLock
+ *
+ * A one-byte test-and-test-and-set lock for the per-node locks of
+ * AVLConcurrentTree. Critical sections are a handful of pointer
+ * writes, so spinning (with a yield after a short burst) beats
+ * parking a thread. Satisfies Lockable, so std::lock_guard works.
+ ***************************************/
+class AVLSpinLock {
+public:
+    AVLSpinLock() noexcept : locked(false) {}
+
+    AVLSpinLock(const AVLSpinLock&) = delete;
+    AVLSpinLock& operator=(const AVLSpinLock&) = delete;
+
+    void lock() noexcept;
+    bool try_lock() noexcept;
+    void unlock() noexcept;
+
+private:
+    std::atomic<bool> locked;
+};
+
+
+/***************************************
+ * AVLEpoch
+ *
+ * Epoch-based reclamation domain. Readers pin the current epoch with a
+ * Guard; synchronize() flips the epoch twice and waits for the readers
+ * pinned under each side to drain, so on return no guard that existed
+ * when it was called is still alive. Memory unlinked before the call
+ * can then be freed.
+ *
+ * Reader counts are striped over cache-line-sized slots chosen per
+ * thread, so concurrent readers on different cores do not share a
+ * counter.
+ ***************************************/
+class AVLEpoch {
+public:
+    class Guard {
+    public:
+        explicit Guard(AVLEpoch& epoch);
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        AVLEpoch* epoch;
+        std::size_t stripe;
+        unsigned side;
+    };
+
+    AVLEpoch();
+
+    AVLEpoch(const AVLEpoch&) = delete;
+    AVLEpoch& operator=(const AVLEpoch&) = delete;
+
+    void synchronize();
+
+private:
+    static constexpr std::size_t stripe_count = 64;
+
+    struct alignas(64) Stripe {
+        std::atomic<std::size_t> readers[2];
+    };
+
+    static std::size_t stripeIndex();
+    void drain(unsigned side) const;
+
+    std::atomic<unsigned> parity;
+    Stripe stripes[stripe_count];
+    std::mutex sync_mutex;
+};
+
+
+/***************************************
+ * AVLConcurrentTree
+ *
+ * A thread-safe AVL set after Bronson, Casper, Chafi and Olukotun,
+ * "A Practical Concurrent Binary Search Tree" (PPoPP 2010).
+ *
+ *  - Lookups take no locks. Every node carries a version that a
+ *    rotation marks as "shrinking" while it moves the node down; a
+ *    reader validates the version of each node it passed through and
+ *    restarts from that node's parent if it changed.
+ *  - Writers lock only the nodes they modify (parent before child),
+ *    so updates in different subtrees proceed in parallel.
+ *  - Erasing a key with two children clears its "present" flag and
+ *    leaves a routing node that is spliced out once it has fewer than
+ *    two children. Balance is relaxed while writers are active and
+ *    restored by the thread that caused the damage.
+ *  - Unlinked nodes are freed through an AVLEpoch once no reader can
+ *    still hold them.
+ *
+ * The allocator must be safe to call from several threads at once
+ * (std::allocator is; AVLPoolAllocator is not).
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class AVLConcurrentTree {
+private:
+    struct Node {
+        std::atomic<Node*> left;
+        std::atomic<Node*> right;
+        std::atomic<Node*> parent;
+        std::atomic<std::uint64_t> version;
+        std::atomic<int> height;
+        std::atomic<bool> present;
+        AVLSpinLock lock;
+        // Stays unconstructed in the root holder.
+        union {
+            T key;
+        };
+
+        Node() : left(nullptr), right(nullptr), parent(nullptr), version(0), height(1), present(false) {}
+
+        template <typename... Args>
+        explicit Node(Node* parent_node, Args&&... args)
+            : left(nullptr), right(nullptr), parent(parent_node), version(0), height(1), present(true) {
+            ::new (static_cast<void*>(std::addressof(key))) T(std::forward<Args>(args)...);
+        }
+
+        ~Node() {}
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+    using Lock = std::lock_guard<AVLSpinLock>;
+
+    enum class Outcome { no, yes, retry };
+
+    // Version bits: the whole word equals unlinked once a node leaves
+    // the tree; otherwise bit 1 marks a rotation in progress and the
+    // remaining bits count completed rotations.
+    static constexpr std::uint64_t unlinked = 1;
+    static constexpr std::uint64_t shrinking = 2;
+    static constexpr std::uint64_t shrink_step = 4;
+
+    // nodeCondition results; non-negative values are a corrected height.
+    static constexpr int unlink_required = -1;
+    static constexpr int rebalance_required = -2;
+    static constexpr int nothing_required = -3;
+
+    // Retired nodes are freed in batches of at least this many.
+    static constexpr std::size_t reclaim_threshold = 256;
+
+    Node* holder;
+    std::atomic<std::size_t> tree_size;
+    Compare comp;
+    NodeAllocator node_alloc;
+    mutable AVLEpoch epoch;
+    std::mutex retired_mutex;
+    std::vector<Node*> retired;
+    std::atomic<std::size_t> retired_count;
+
+    template <typename... Args>
+    Node* createNode(Node* parent, Args&&... args);
+    void destroyNode(Node* node);
+    void destroySubtree(Node* node);
+    void retire(Node* node);
+    void reclaim();
+
+    static std::atomic<Node*>& link(Node* node, bool right);
+    static int height(const Node* node);
+    static void waitUntilShrinkCompleted(const Node* node, std::uint64_t version);
+
+    template <typename Q>
+    bool matches(const Q& key, const Node* node) const;
+    template <typename Q>
+    Outcome attemptGet(const Q& key, Node* node, bool right, std::uint64_t nodeVersion) const;
+    template <typename K>
+    bool attemptInsertIntoEmpty(K&& key);
+    template <typename K>
+    Outcome attemptInsert(K&& key, Node* node, std::uint64_t nodeVersion);
+    Outcome attemptErase(const T& key, Node* parent, Node* node, std::uint64_t nodeVersion);
+    Outcome attemptNodeErase(Node* parent, Node* node);
+    template <typename K>
+    bool insertKey(K&& key);
+    template <typename Q>
+    bool containsKey(const Q& key) const;
+
+    bool attemptUnlink_nl(Node* parent, Node* node);
+    int nodeCondition(Node* node) const;
+    void fixHeightAndRebalance(Node* node);
+    Node* fixHeight_nl(Node* node);
+    Node* rebalance_nl(Node* nParent, Node* n);
+    Node* rebalanceToRight_nl(Node* nParent, Node* n, Node* nL, int hR0);
+    Node* rebalanceToLeft_nl(Node* nParent, Node* n, Node* nR, int hL0);
+    Node* promoteOver_nl(Node* parent, Node* node, Node* child, bool mirrored);
+    Node* rotateRight_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLR);
+    Node* rotateLeft_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRL, int hRR);
+    Node* rotateRightOverLeft_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLRL);
+    Node* rotateLeftOverRight_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRR, int hRLR);
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    AVLConcurrentTree();
+    explicit AVLConcurrentTree(const Compare& compare, const Allocator& alloc = Allocator());
+    ~AVLConcurrentTree();
+
+    AVLConcurrentTree(const AVLConcurrentTree&) = delete;
+    AVLConcurrentTree& operator=(const AVLConcurrentTree&) = delete;
+
+    bool insert(const T& key);
+    bool insert(T&& key);
+    bool erase(const T& key);
+    bool contains(const T& key) const;
+    template <typename Q, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Q& key) const;
+
+    std::size_t size() const;
+    bool empty() const;
+    void clear();
+};
+
+#include "AVLConcurrentTreeImplementation.tpp"
+
+#endif
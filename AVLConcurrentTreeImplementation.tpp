@@ -0,0 +1,1389 @@
+#include "AVLConcurrentTreeHeader.hpp"
+#include <algorithm>
+
+// All shared node fields are sequentially consistent atomics. On x86
+// and ARMv8 seq_cst loads compile to plain (acquire) loads, so readers
+// pay nothing for the simpler reasoning; only writers' stores cost more.
+
+/***************************************
+ * AVLSpinLock::lock
+ *
+ * Spins on a plain load until the lock looks free, then tries to take
+ * it; yields the processor once a short burst of spinning fails.
+ ***************************************/
+inline void AVLSpinLock::lock() noexcept {
+    unsigned spins = 0;
+    while (locked.exchange(true, std::memory_order_acquire)) {
+        while (locked.load(std::memory_order_relaxed)) {
+            if (++spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+
+/***************************************
+ * AVLSpinLock::try_lock
+ *
+ * Returns true if the lock was free and is now held.
+ ***************************************/
+inline bool AVLSpinLock::try_lock() noexcept {
+    return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+}
+
+
+/***************************************
+ * AVLSpinLock::unlock
+ ***************************************/
+inline void AVLSpinLock::unlock() noexcept {
+    locked.store(false, std::memory_order_release);
+}
+
+
+/***************************************
+ * AVLEpoch Constructor
+ *
+ * Creates a domain with no pinned readers.
+ ***************************************/
+inline AVLEpoch::AVLEpoch() : parity(0) {
+    for (Stripe& stripe : stripes) {
+        stripe.readers[0].store(0, std::memory_order_relaxed);
+        stripe.readers[1].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+/***************************************
+ * stripeIndex (private helper)
+ *
+ * Returns the calling thread's reader stripe, assigned round-robin on
+ * first use so up to stripe_count threads never share one.
+ ***************************************/
+inline std::size_t AVLEpoch::stripeIndex() {
+    static std::atomic<std::size_t> next(0);
+    thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % stripe_count;
+    return index;
+}
+
+
+/***************************************
+ * Guard Constructor
+ *
+ * Pins the current epoch for the calling thread.
+ *
+ * Behavior:
+ *  - One atomic increment on the thread's own stripe. The parity read
+ *    may already be stale; synchronize() waits on both sides, so a
+ *    late increment is still covered.
+ ***************************************/
+inline AVLEpoch::Guard::Guard(AVLEpoch& owner)
+    : epoch(&owner), stripe(stripeIndex()), side(owner.parity.load()) {
+    epoch->stripes[stripe].readers[side].fetch_add(1);
+}
+
+
+/***************************************
+ * Guard Destructor
+ *
+ * Unpins the epoch.
+ ***************************************/
+inline AVLEpoch::Guard::~Guard() {
+    epoch->stripes[stripe].readers[side].fetch_sub(1, std::memory_order_release);
+}
+
+
+/***************************************
+ * drain (private helper)
+ *
+ * Waits until no reader is pinned on one side of the epoch.
+ *
+ * Behavior:
+ *  - Each stripe only ever holds at least the readers that were pinned
+ *    on it when the wait began, so summing stripes read at different
+ *    moments cannot miss one of them.
+ ***************************************/
+inline void AVLEpoch::drain(unsigned side) const {
+    for (unsigned spins = 0; ; ++spins) {
+        std::size_t pinned = 0;
+        for (const Stripe& stripe : stripes) {
+            pinned += stripe.readers[side].load(std::memory_order_acquire);
+        }
+        if (pinned == 0) {
+            return;
+        }
+        if (spins > 16) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+/***************************************
+ * synchronize
+ *
+ * Waits until every Guard created before the call has been destroyed.
+ *
+ * Behavior:
+ *  - Flips the parity and drains the old side, twice, so readers that
+ *    read the parity just before a flip are waited for as well.
+ *  - Must not be called while the caller holds a Guard on this domain
+ *    (it would wait for itself) or a lock a pinned reader may need.
+ ***************************************/
+inline void AVLEpoch::synchronize() {
+    std::lock_guard<std::mutex> serialize(sync_mutex);
+    for (int round = 0; round < 2; ++round) {
+        unsigned old = parity.load();
+        parity.store(old ^ 1u);
+        drain(old);
+    }
+}
+
+
+/***************************************
+ * AVLConcurrentTree Constructor
+ *
+ * Initializes an empty tree.
+ *
+ * Behavior:
+ *  - Allocates the root holder, a key-less sentinel whose right child
+ *    is the root, so the root can be rotated and spliced like any other
+ *    child.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLConcurrentTree<T, Compare, Allocator>::AVLConcurrentTree()
+    : AVLConcurrentTree(Compare()) {}
+
+
+/***************************************
+ * AVLConcurrentTree Constructor (comparator and allocator)
+ *
+ * Initializes an empty tree with the given comparator and an
+ * allocator for its nodes.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLConcurrentTree<T, Compare, Allocator>::AVLConcurrentTree(const Compare& compare, const Allocator& alloc)
+    : holder(nullptr), tree_size(0), comp(compare), node_alloc(alloc), retired_count(0) {
+    holder = NodeAllocTraits::allocate(node_alloc, 1);
+    NodeAllocTraits::construct(node_alloc, holder);
+}
+
+
+/***************************************
+ * AVLConcurrentTree Destructor
+ *
+ * Frees every node, including those still awaiting reclamation. No
+ * other thread may be using the tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLConcurrentTree<T, Compare, Allocator>::~AVLConcurrentTree() {
+    clear();
+    NodeAllocTraits::destroy(node_alloc, holder);
+    NodeAllocTraits::deallocate(node_alloc, holder, 1);
+}
+
+
+/***************************************
+ * createNode (private helper)
+ *
+ * Allocates a leaf holding a key built from args.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::createNode(Node* parent, Args&&... args) {
+    Node* node = NodeAllocTraits::allocate(node_alloc, 1);
+    try {
+        NodeAllocTraits::construct(node_alloc, node, parent, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        NodeAllocTraits::deallocate(node_alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+
+/***************************************
+ * destroyNode (private helper)
+ *
+ * Destroys a node's key and frees the node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::destroyNode(Node* node) {
+    node->key.~T();
+    NodeAllocTraits::destroy(node_alloc, node);
+    NodeAllocTraits::deallocate(node_alloc, node, 1);
+}
+
+
+/***************************************
+ * destroySubtree (private helper)
+ *
+ * Frees a subtree; only called while no other thread uses the tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::destroySubtree(Node* node) {
+    if (!node) {
+        return;
+    }
+    destroySubtree(node->left.load(std::memory_order_relaxed));
+    destroySubtree(node->right.load(std::memory_order_relaxed));
+    destroyNode(node);
+}
+
+
+/***************************************
+ * retire (private helper)
+ *
+ * Queues an unlinked node to be freed once no reader can reach it.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::retire(Node* node) {
+    std::lock_guard<std::mutex> hold(retired_mutex);
+    retired.push_back(node);
+    retired_count.store(retired.size(), std::memory_order_relaxed);
+}
+
+
+/***************************************
+ * reclaim (private helper)
+ *
+ * Frees the retired nodes once the epoch shows no reader holds them.
+ *
+ * Behavior:
+ *  - Called by writers after their Guard is gone and no node lock is
+ *    held, once at least reclaim_threshold nodes are queued.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::reclaim() {
+    if (retired_count.load(std::memory_order_relaxed) < reclaim_threshold) {
+        return;
+    }
+    std::vector<Node*> batch;
+    {
+        std::lock_guard<std::mutex> hold(retired_mutex);
+        batch.swap(retired);
+        retired_count.store(0, std::memory_order_relaxed);
+    }
+    if (batch.empty()) {
+        return;
+    }
+    epoch.synchronize();
+    for (Node* node : batch) {
+        destroyNode(node);
+    }
+}
+
+
+/***************************************
+ * link (private helper)
+ *
+ * Returns the left or right child slot of a node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::atomic<typename AVLConcurrentTree<T, Compare, Allocator>::Node*>& AVLConcurrentTree<T, Compare, Allocator>::link(Node* node, bool right) {
+    return right ? node->right : node->left;
+}
+
+
+/***************************************
+ * height (private helper)
+ *
+ * Returns the stored height of a node, or 0 for nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLConcurrentTree<T, Compare, Allocator>::height(const Node* node) {
+    return node ? node->height.load() : 0;
+}
+
+
+/***************************************
+ * waitUntilShrinkCompleted (private helper)
+ *
+ * Waits for the rotation that marked a node as shrinking to finish.
+ *
+ * Parameters:
+ *  - node: The node.
+ *  - version: The version that was read from it.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::waitUntilShrinkCompleted(const Node* node, std::uint64_t version) {
+    if (!(version & shrinking)) {
+        return;
+    }
+    for (unsigned spins = 0; node->version.load() == version; ++spins) {
+        if (spins > 64) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+/***************************************
+ * matches (private helper)
+ *
+ * Returns true if key is equivalent to the node's key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Q>
+bool AVLConcurrentTree<T, Compare, Allocator>::matches(const Q& key, const Node* node) const {
+    return !comp(key, node->key) && !comp(node->key, key);
+}
+
+
+/***************************************
+ * attemptGet (private helper)
+ *
+ * Optimistic, lock-free search below a node.
+ *
+ * Parameters:
+ *  - key: The probe.
+ *  - node: A node the search has reached.
+ *  - right: The side of node the key lies on.
+ *  - nodeVersion: node's version when the search arrived at it.
+ *
+ * Returns:
+ *  - yes or no, or retry if node was rotated since the search arrived,
+ *    in which case the caller resumes from node's parent.
+ *
+ * Behavior:
+ *  - Each step reads the child, then re-validates the parent's version:
+ *    if it is unchanged, the child was the right way to go at an
+ *    instant when the parent was, so the chain of checks stands in for
+ *    one big read-only transaction.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Q>
+typename AVLConcurrentTree<T, Compare, Allocator>::Outcome AVLConcurrentTree<T, Compare, Allocator>::attemptGet(const Q& key, Node* node, bool right, std::uint64_t nodeVersion) const {
+    while (true) {
+        Node* child = link(node, right).load();
+        if (!child) {
+            return node->version.load() != nodeVersion ? Outcome::retry : Outcome::no;
+        }
+        const bool less = comp(key, child->key);
+        const bool greater = comp(child->key, key);
+        if (!less && !greater) {
+            return child->present.load() ? Outcome::yes : Outcome::no;
+        }
+        const std::uint64_t childVersion = child->version.load();
+        if (childVersion & (shrinking | unlinked)) {
+            waitUntilShrinkCompleted(child, childVersion);
+            if (node->version.load() != nodeVersion) {
+                return Outcome::retry;
+            }
+        }
+        else if (child != link(node, right).load()) {
+            if (node->version.load() != nodeVersion) {
+                return Outcome::retry;
+            }
+        }
+        else {
+            if (node->version.load() != nodeVersion) {
+                return Outcome::retry;
+            }
+            Outcome outcome = attemptGet(key, child, greater, childVersion);
+            if (outcome != Outcome::retry) {
+                return outcome;
+            }
+        }
+    }
+}
+
+
+/***************************************
+ * attemptInsertIntoEmpty (private helper)
+ *
+ * Installs the first node under the root holder.
+ *
+ * Returns:
+ *  - false if another thread got there first.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename K>
+bool AVLConcurrentTree<T, Compare, Allocator>::attemptInsertIntoEmpty(K&& key) {
+    Lock hold(holder->lock);
+    if (holder->right.load()) {
+        return false;
+    }
+    holder->right.store(createNode(holder, std::forward<K>(key)));
+    holder->height.store(2);
+    return true;
+}
+
+
+/***************************************
+ * attemptInsert (private helper)
+ *
+ * Inserts a key below a node the search has reached.
+ *
+ * Parameters:
+ *  - key: The key; consumed only if a new node is created.
+ *  - node: The node reached.
+ *  - nodeVersion: node's version when the search arrived at it.
+ *
+ * Returns:
+ *  - yes if the key was added, no if it was present, or retry.
+ *
+ * Behavior:
+ *  - Descends optimistically like attemptGet. A new leaf is linked
+ *    under its parent's lock after re-validating the parent's version;
+ *    an equivalent routing node is revived under its own lock.
+ *  - Heights are repaired afterwards by fixHeightAndRebalance.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename K>
+typename AVLConcurrentTree<T, Compare, Allocator>::Outcome AVLConcurrentTree<T, Compare, Allocator>::attemptInsert(K&& key, Node* node, std::uint64_t nodeVersion) {
+    if (matches(key, node)) {
+        Lock hold(node->lock);
+        if (node->version.load() == unlinked) {
+            return Outcome::retry;
+        }
+        if (node->present.load()) {
+            return Outcome::no;
+        }
+        node->present.store(true);
+        return Outcome::yes;
+    }
+
+    const bool right = comp(node->key, key);
+    while (true) {
+        Node* child = link(node, right).load();
+        if (node->version.load() != nodeVersion) {
+            return Outcome::retry;
+        }
+        if (!child) {
+            Node* damaged;
+            {
+                Lock hold(node->lock);
+                if (node->version.load() != nodeVersion) {
+                    return Outcome::retry;
+                }
+                if (link(node, right).load()) {
+                    // Lost a race with another insert; look again.
+                    continue;
+                }
+                link(node, right).store(createNode(node, std::forward<K>(key)));
+                damaged = fixHeight_nl(node);
+            }
+            fixHeightAndRebalance(damaged);
+            return Outcome::yes;
+        }
+        const std::uint64_t childVersion = child->version.load();
+        if (childVersion & (shrinking | unlinked)) {
+            waitUntilShrinkCompleted(child, childVersion);
+        }
+        else if (child == link(node, right).load()) {
+            if (node->version.load() != nodeVersion) {
+                return Outcome::retry;
+            }
+            Outcome outcome = attemptInsert(std::forward<K>(key), child, childVersion);
+            if (outcome != Outcome::retry) {
+                return outcome;
+            }
+        }
+    }
+}
+
+
+/***************************************
+ * attemptErase (private helper)
+ *
+ * Erases a key below a node the search has reached.
+ *
+ * Parameters:
+ *  - key: The key.
+ *  - parent: node's parent when the search arrived at it.
+ *  - node: The node reached.
+ *  - nodeVersion: node's version at the time.
+ *
+ * Returns:
+ *  - yes if the key was removed, no if it was absent, or retry.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Outcome AVLConcurrentTree<T, Compare, Allocator>::attemptErase(const T& key, Node* parent, Node* node, std::uint64_t nodeVersion) {
+    if (matches(key, node)) {
+        return attemptNodeErase(parent, node);
+    }
+
+    const bool right = comp(node->key, key);
+    while (true) {
+        Node* child = link(node, right).load();
+        if (node->version.load() != nodeVersion) {
+            return Outcome::retry;
+        }
+        if (!child) {
+            return Outcome::no;
+        }
+        const std::uint64_t childVersion = child->version.load();
+        if (childVersion & (shrinking | unlinked)) {
+            waitUntilShrinkCompleted(child, childVersion);
+        }
+        else if (child == link(node, right).load()) {
+            if (node->version.load() != nodeVersion) {
+                return Outcome::retry;
+            }
+            Outcome outcome = attemptErase(key, node, child, childVersion);
+            if (outcome != Outcome::retry) {
+                return outcome;
+            }
+        }
+    }
+}
+
+
+/***************************************
+ * attemptNodeErase (private helper)
+ *
+ * Erases the key held by a node.
+ *
+ * Parameters:
+ *  - parent: The node's parent as seen by the search; re-validated.
+ *  - node: The node holding the key.
+ *
+ * Behavior:
+ *  - A node with at most one child is spliced out under the parent's
+ *    and its own lock. A node with two children only clears its
+ *    present flag and stays behind as a routing node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Outcome AVLConcurrentTree<T, Compare, Allocator>::attemptNodeErase(Node* parent, Node* node) {
+    if (!node->present.load()) {
+        return Outcome::no;
+    }
+    if (!node->left.load() || !node->right.load()) {
+        Node* damaged;
+        {
+            Lock holdParent(parent->lock);
+            if (parent->version.load() == unlinked || node->parent.load() != parent) {
+                return Outcome::retry;
+            }
+            {
+                Lock holdNode(node->lock);
+                if (!node->present.load()) {
+                    return Outcome::no;
+                }
+                if (!attemptUnlink_nl(parent, node)) {
+                    return Outcome::retry;
+                }
+            }
+            damaged = fixHeight_nl(parent);
+        }
+        fixHeightAndRebalance(damaged);
+        return Outcome::yes;
+    }
+
+    Lock hold(node->lock);
+    if (node->version.load() == unlinked) {
+        return Outcome::retry;
+    }
+    if (!node->present.load()) {
+        return Outcome::no;
+    }
+    if (!node->left.load() || !node->right.load()) {
+        // It can be spliced out now; take the parent's lock first.
+        return Outcome::retry;
+    }
+    node->present.store(false);
+    return Outcome::yes;
+}
+
+
+/***************************************
+ * attemptUnlink_nl (private helper)
+ *
+ * Splices a node with at most one child out of the tree. Both parent
+ * and node must be locked.
+ *
+ * Returns:
+ *  - false if node is no longer parent's child or now has two
+ *    children; the caller retries.
+ *
+ * Behavior:
+ *  - Marks node unlinked so searches standing on it restart, and
+ *    retires it. Heights are left to the caller.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLConcurrentTree<T, Compare, Allocator>::attemptUnlink_nl(Node* parent, Node* node) {
+    Node* parentLeft = parent->left.load();
+    Node* parentRight = parent->right.load();
+    if (parentLeft != node && parentRight != node) {
+        return false;
+    }
+    Node* left = node->left.load();
+    Node* right = node->right.load();
+    if (left && right) {
+        return false;
+    }
+    Node* splice = left ? left : right;
+    if (parentLeft == node) {
+        parent->left.store(splice);
+    }
+    else {
+        parent->right.store(splice);
+    }
+    if (splice) {
+        splice->parent.store(parent);
+    }
+    node->version.store(unlinked);
+    node->present.store(false);
+    retire(node);
+    return true;
+}
+
+
+/***************************************
+ * nodeCondition (private helper)
+ *
+ * Classifies the repair a node needs.
+ *
+ * Returns:
+ *  - unlink_required for a routing node with fewer than two children,
+ *    rebalance_required if the children's heights differ by more than
+ *    one, nothing_required if the node is fine, or else the height it
+ *    should have.
+ *
+ * Behavior:
+ *  - Reads without locks. Any thread that changes a node promises to
+ *    repair it, so an inconsistent read is harmless: either the answer
+ *    is right or someone else is responsible.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLConcurrentTree<T, Compare, Allocator>::nodeCondition(Node* node) const {
+    Node* left = node->left.load();
+    Node* right = node->right.load();
+    if ((!left || !right) && !node->present.load()) {
+        return unlink_required;
+    }
+    const int h = node->height.load();
+    const int hL = height(left);
+    const int hR = height(right);
+    const int hRepl = 1 + std::max(hL, hR);
+    const int balance = hL - hR;
+    if (balance < -1 || balance > 1) {
+        return rebalance_required;
+    }
+    return h != hRepl ? hRepl : nothing_required;
+}
+
+
+/***************************************
+ * fixHeightAndRebalance (private helper)
+ *
+ * Repairs a damaged node and walks the damage up toward the root.
+ *
+ * Parameters:
+ *  - node: The lowest damaged node this thread is responsible for, or
+ *    nullptr.
+ *
+ * Behavior:
+ *  - A height fix needs only the node's lock; a rotation or splice
+ *    locks the parent and then the node. A chain stops at the root
+ *    holder, at an unlinked node, or when nothing is left to do.
+ *  - When a repair moves below the node or its parent while either is
+ *    still damaged, they are remembered and revisited, so a quiescent
+ *    tree ends up strictly balanced.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::fixHeightAndRebalance(Node* node) {
+    // Nodes this thread left damaged while a descendant was repaired
+    // first; revisited once that repair settles.
+    std::vector<Node*> pending;
+    while (true) {
+        if (!node || !node->parent.load()) {
+            if (pending.empty()) {
+                return;
+            }
+            node = pending.back();
+            pending.pop_back();
+            continue;
+        }
+        const int condition = nodeCondition(node);
+        if (condition == nothing_required || node->version.load() == unlinked) {
+            node = nullptr;
+            continue;
+        }
+        if (condition != unlink_required && condition != rebalance_required) {
+            Lock hold(node->lock);
+            node = fixHeight_nl(node);
+        }
+        else {
+            Node* nParent = node->parent.load();
+            Lock holdParent(nParent->lock);
+            if (nParent->version.load() != unlinked && node->parent.load() == nParent) {
+                Lock holdNode(node->lock);
+                Node* next = rebalance_nl(nParent, node);
+                if (next && next != nParent && nodeCondition(nParent) != nothing_required) {
+                    pending.push_back(nParent);
+                }
+                if (next && next != node && node->version.load() != unlinked && nodeCondition(node) != nothing_required) {
+                    pending.push_back(node);
+                }
+                node = next;
+            }
+        }
+    }
+}
+
+
+/***************************************
+ * fixHeight_nl (private helper)
+ *
+ * Corrects the height of a locked node.
+ *
+ * Returns:
+ *  - The lowest node still damaged that this thread must repair: the
+ *    node itself if it needs more than a height fix, its parent if its
+ *    height changed, or nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::fixHeight_nl(Node* node) {
+    const int condition = nodeCondition(node);
+    switch (condition) {
+        case rebalance_required:
+        case unlink_required:
+            return node;
+        case nothing_required:
+            return nullptr;
+        default:
+            node->height.store(condition);
+            return node->parent.load();
+    }
+}
+
+
+/***************************************
+ * rebalance_nl (private helper)
+ *
+ * Splices, rotates or re-heights a node; nParent and n are locked.
+ *
+ * Returns:
+ *  - The next damaged node, or nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rebalance_nl(Node* nParent, Node* n) {
+    Node* nL = n->left.load();
+    Node* nR = n->right.load();
+    if ((!nL || !nR) && !n->present.load()) {
+        if (attemptUnlink_nl(nParent, n)) {
+            return fixHeight_nl(nParent);
+        }
+        return n;
+    }
+
+    const int hN = n->height.load();
+    const int hL0 = height(nL);
+    const int hR0 = height(nR);
+    const int hNRepl = 1 + std::max(hL0, hR0);
+    const int balance = hL0 - hR0;
+    if (balance > 1) {
+        return rebalanceToRight_nl(nParent, n, nL, hR0);
+    }
+    if (balance < -1) {
+        return rebalanceToLeft_nl(nParent, n, nR, hL0);
+    }
+    if (hNRepl != hN) {
+        n->height.store(hNRepl);
+        return fixHeight_nl(nParent);
+    }
+    return nullptr;
+}
+
+
+/***************************************
+ * rebalanceToRight_nl (private helper)
+ *
+ * Fixes a node whose left subtree is too tall, by a single right
+ * rotation or a double rotation. nParent and n are locked.
+ *
+ * Parameters:
+ *  - nL: n's left child.
+ *  - hR0: Height of n's right subtree.
+ *
+ * Returns:
+ *  - The next damaged node, or n itself when its child's shape shows
+ *    that n should be re-examined.
+ *
+ * Behavior:
+ *  - If a double rotation would leave nL unbalanced (or as a routing
+ *    leaf), nL is rebalanced on its own instead, which avoids damaging
+ *    nodes without a direct ancestry relationship. When nL is itself
+ *    within balance the blocking node is repaired first instead: a
+ *    routing nL is spliced out (or replaced by nLR), or an unbalanced
+ *    nLR is returned for repair, so every call makes progress.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rebalanceToRight_nl(Node* nParent, Node* n, Node* nL, int hR0) {
+    Lock holdLeft(nL->lock);
+    const int hL = nL->height.load();
+    if (hL - hR0 <= 1) {
+        return n;
+    }
+    Node* nLR = nL->right.load();
+    const int hLL0 = height(nL->left.load());
+    const int hLR0 = height(nLR);
+    if (hLL0 >= hLR0) {
+        return rotateRight_nl(nParent, n, nL, hR0, hLL0, nLR, hLR0);
+    }
+    {
+        Lock holdLeftRight(nLR->lock);
+        const int hLR = nLR->height.load();
+        if (hLL0 >= hLR) {
+            return rotateRight_nl(nParent, n, nL, hR0, hLL0, nLR, hLR);
+        }
+        const int hLRL = height(nLR->left.load());
+        const int balance = hLL0 - hLRL;
+        if (balance >= -1 && balance <= 1 && !((hLL0 == 0 || hLRL == 0) && !nL->present.load())) {
+            return rotateRightOverLeft_nl(nParent, n, nL, hR0, hLL0, nLR, hLRL);
+        }
+        if (hLR == hLL0 + 1) {
+            // nL is within balance, so rotating it would not help n.
+            if (!nL->present.load() && hLL0 != 0 && hLRL == 0) {
+                return promoteOver_nl(n, nL, nLR, false);
+            }
+            // Either nL is a routing node missing a child, or nLR is out
+            // of balance; repair that first and n is revisited after.
+            return (!nL->present.load() && hLL0 == 0) ? nL : nLR;
+        }
+    }
+    return rebalanceToLeft_nl(n, nL, nLR, hLL0);
+}
+
+
+/***************************************
+ * rebalanceToLeft_nl (private helper)
+ *
+ * Mirror image of rebalanceToRight_nl for a right subtree that is
+ * too tall.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rebalanceToLeft_nl(Node* nParent, Node* n, Node* nR, int hL0) {
+    Lock holdRight(nR->lock);
+    const int hR = nR->height.load();
+    if (hL0 - hR >= -1) {
+        return n;
+    }
+    Node* nRL = nR->left.load();
+    const int hRL0 = height(nRL);
+    const int hRR0 = height(nR->right.load());
+    if (hRR0 >= hRL0) {
+        return rotateLeft_nl(nParent, n, hL0, nR, nRL, hRL0, hRR0);
+    }
+    {
+        Lock holdRightLeft(nRL->lock);
+        const int hRL = nRL->height.load();
+        if (hRR0 >= hRL) {
+            return rotateLeft_nl(nParent, n, hL0, nR, nRL, hRL, hRR0);
+        }
+        const int hRLR = height(nRL->right.load());
+        const int balance = hRR0 - hRLR;
+        if (balance >= -1 && balance <= 1 && !((hRR0 == 0 || hRLR == 0) && !nR->present.load())) {
+            return rotateLeftOverRight_nl(nParent, n, hL0, nR, nRL, hRR0, hRLR);
+        }
+        if (hRL == hRR0 + 1) {
+            if (!nR->present.load() && hRR0 != 0 && hRLR == 0) {
+                return promoteOver_nl(n, nR, nRL, true);
+            }
+            return (!nR->present.load() && hRR0 == 0) ? nR : nRL;
+        }
+    }
+    return rebalanceToRight_nl(n, nR, nRL, hRR0);
+}
+
+
+/***************************************
+ * promoteOver_nl (private helper)
+ *
+ * Splices out a routing node whose in-order neighbour is its own
+ * child, by moving that child into its place. parent, node and
+ * child are locked.
+ *
+ * Parameters:
+ *  - parent: node's parent.
+ *  - node: A routing node with two children.
+ *  - child: node's inner grandchild side: its right child when
+ *    mirrored is false (child has no left child), else its left child
+ *    (child has no right child).
+ *  - mirrored: Which way round the nodes are.
+ *
+ * Returns:
+ *  - parent, whose subtree became shorter.
+ *
+ * Behavior:
+ *  - child only gains keys, which searches tolerate without a version
+ *    change; node is marked unlinked and retired.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::promoteOver_nl(Node* parent, Node* node, Node* child, bool mirrored) {
+    Node* adopted = link(node, mirrored).load();
+    link(child, mirrored).store(adopted);
+    adopted->parent.store(child);
+    if (parent->left.load() == node) {
+        parent->left.store(child);
+    }
+    else {
+        parent->right.store(child);
+    }
+    child->parent.store(parent);
+    child->height.store(1 + std::max(height(child->left.load()), height(child->right.load())));
+
+    node->version.store(unlinked);
+    node->present.store(false);
+    retire(node);
+    return parent;
+}
+
+
+/***************************************
+ * rotateRight_nl (private helper)
+ *
+ * Rotates n right around its left child nL; nParent, n and nL are
+ * locked and the heights passed in were read under those locks.
+ *
+ * Returns:
+ *  - The deepest node still damaged, or nParent's repair.
+ *
+ * Behavior:
+ *  - n moves down, so its version is marked shrinking for the duration;
+ *    searches that pass through it wait or restart. Links from n are
+ *    changed first and the link into n's old position last, so no
+ *    search can bypass the marked version.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rotateRight_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLR) {
+    const std::uint64_t nodeVersion = n->version.load();
+    Node* nPL = nParent->left.load();
+
+    n->version.store(nodeVersion | shrinking);
+
+    n->left.store(nLR);
+    nL->right.store(n);
+    if (nPL == n) {
+        nParent->left.store(nL);
+    }
+    else {
+        nParent->right.store(nL);
+    }
+
+    nL->parent.store(nParent);
+    n->parent.store(nL);
+    if (nLR) {
+        nLR->parent.store(n);
+    }
+
+    const int hNRepl = 1 + std::max(hLR, hR);
+    n->height.store(hNRepl);
+    nL->height.store(1 + std::max(hLL, hNRepl));
+
+    n->version.store(nodeVersion + shrink_step);
+
+    const int balanceN = hLR - hR;
+    if (balanceN < -1 || balanceN > 1) {
+        return n;
+    }
+    if ((!nLR || hR == 0) && !n->present.load()) {
+        return n;
+    }
+    const int balanceL = hLL - hNRepl;
+    if (balanceL < -1 || balanceL > 1) {
+        return nL;
+    }
+    return fixHeight_nl(nParent);
+}
+
+
+/***************************************
+ * rotateLeft_nl (private helper)
+ *
+ * Mirror image of rotateRight_nl.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rotateLeft_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRL, int hRR) {
+    const std::uint64_t nodeVersion = n->version.load();
+    Node* nPL = nParent->left.load();
+
+    n->version.store(nodeVersion | shrinking);
+
+    n->right.store(nRL);
+    nR->left.store(n);
+    if (nPL == n) {
+        nParent->left.store(nR);
+    }
+    else {
+        nParent->right.store(nR);
+    }
+
+    nR->parent.store(nParent);
+    n->parent.store(nR);
+    if (nRL) {
+        nRL->parent.store(n);
+    }
+
+    const int hNRepl = 1 + std::max(hL, hRL);
+    n->height.store(hNRepl);
+    nR->height.store(1 + std::max(hNRepl, hRR));
+
+    n->version.store(nodeVersion + shrink_step);
+
+    const int balanceN = hRL - hL;
+    if (balanceN < -1 || balanceN > 1) {
+        return n;
+    }
+    if ((!nRL || hL == 0) && !n->present.load()) {
+        return n;
+    }
+    const int balanceR = hRR - hNRepl;
+    if (balanceR < -1 || balanceR > 1) {
+        return nR;
+    }
+    return fixHeight_nl(nParent);
+}
+
+
+/***************************************
+ * rotateRightOverLeft_nl (private helper)
+ *
+ * Double rotation: nLR becomes the subtree root with nL on its left
+ * and n on its right. nParent, n, nL and nLR are locked.
+ *
+ * Behavior:
+ *  - Both n and nL move down and are marked shrinking.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rotateRightOverLeft_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLRL) {
+    const std::uint64_t nodeVersion = n->version.load();
+    const std::uint64_t leftVersion = nL->version.load();
+
+    Node* nPL = nParent->left.load();
+    Node* nLRL = nLR->left.load();
+    Node* nLRR = nLR->right.load();
+    const int hLRR = height(nLRR);
+
+    n->version.store(nodeVersion | shrinking);
+    nL->version.store(leftVersion | shrinking);
+
+    n->left.store(nLRR);
+    nL->right.store(nLRL);
+    nLR->left.store(nL);
+    nLR->right.store(n);
+    if (nPL == n) {
+        nParent->left.store(nLR);
+    }
+    else {
+        nParent->right.store(nLR);
+    }
+
+    nLR->parent.store(nParent);
+    nL->parent.store(nLR);
+    n->parent.store(nLR);
+    if (nLRR) {
+        nLRR->parent.store(n);
+    }
+    if (nLRL) {
+        nLRL->parent.store(nL);
+    }
+
+    const int hNRepl = 1 + std::max(hLRR, hR);
+    n->height.store(hNRepl);
+    const int hLRepl = 1 + std::max(hLL, hLRL);
+    nL->height.store(hLRepl);
+    nLR->height.store(1 + std::max(hLRepl, hNRepl));
+
+    nL->version.store(leftVersion + shrink_step);
+    n->version.store(nodeVersion + shrink_step);
+
+    const int balanceN = hLRR - hR;
+    if (balanceN < -1 || balanceN > 1) {
+        return n;
+    }
+    if ((!nLRR || hR == 0) && !n->present.load()) {
+        return n;
+    }
+    const int balanceLR = hLRepl - hNRepl;
+    if (balanceLR < -1 || balanceLR > 1) {
+        return nLR;
+    }
+    return fixHeight_nl(nParent);
+}
+
+
+/***************************************
+ * rotateLeftOverRight_nl (private helper)
+ *
+ * Mirror image of rotateRightOverLeft_nl.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLConcurrentTree<T, Compare, Allocator>::Node* AVLConcurrentTree<T, Compare, Allocator>::rotateLeftOverRight_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRR, int hRLR) {
+    const std::uint64_t nodeVersion = n->version.load();
+    const std::uint64_t rightVersion = nR->version.load();
+
+    Node* nPL = nParent->left.load();
+    Node* nRLL = nRL->left.load();
+    Node* nRLR = nRL->right.load();
+    const int hRLL = height(nRLL);
+
+    n->version.store(nodeVersion | shrinking);
+    nR->version.store(rightVersion | shrinking);
+
+    n->right.store(nRLL);
+    nR->left.store(nRLR);
+    nRL->right.store(nR);
+    nRL->left.store(n);
+    if (nPL == n) {
+        nParent->left.store(nRL);
+    }
+    else {
+        nParent->right.store(nRL);
+    }
+
+    nRL->parent.store(nParent);
+    nR->parent.store(nRL);
+    n->parent.store(nRL);
+    if (nRLL) {
+        nRLL->parent.store(n);
+    }
+    if (nRLR) {
+        nRLR->parent.store(nR);
+    }
+
+    const int hNRepl = 1 + std::max(hL, hRLL);
+    n->height.store(hNRepl);
+    const int hRRepl = 1 + std::max(hRLR, hRR);
+    nR->height.store(hRRepl);
+    nRL->height.store(1 + std::max(hNRepl, hRRepl));
+
+    nR->version.store(rightVersion + shrink_step);
+    n->version.store(nodeVersion + shrink_step);
+
+    const int balanceN = hRLL - hL;
+    if (balanceN < -1 || balanceN > 1) {
+        return n;
+    }
+    if ((!nRLL || hL == 0) && !n->present.load()) {
+        return n;
+    }
+    const int balanceRL = hRRepl - hNRepl;
+    if (balanceRL < -1 || balanceRL > 1) {
+        return nRL;
+    }
+    return fixHeight_nl(nParent);
+}
+
+
+/***************************************
+ * insertKey (private helper)
+ *
+ * Shared body of both insert overloads.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename K>
+bool AVLConcurrentTree<T, Compare, Allocator>::insertKey(K&& key) {
+    bool inserted;
+    {
+        AVLEpoch::Guard guard(epoch);
+        while (true) {
+            Node* root = holder->right.load();
+            if (!root) {
+                if (attemptInsertIntoEmpty(std::forward<K>(key))) {
+                    inserted = true;
+                    break;
+                }
+                continue;
+            }
+            const std::uint64_t rootVersion = root->version.load();
+            if (rootVersion & (shrinking | unlinked)) {
+                waitUntilShrinkCompleted(root, rootVersion);
+            }
+            else if (root == holder->right.load()) {
+                Outcome outcome = attemptInsert(std::forward<K>(key), root, rootVersion);
+                if (outcome != Outcome::retry) {
+                    inserted = outcome == Outcome::yes;
+                    break;
+                }
+            }
+        }
+    }
+    if (inserted) {
+        tree_size.fetch_add(1, std::memory_order_relaxed);
+    }
+    reclaim();
+    return inserted;
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a key if no equivalent key is present.
+ *
+ * Returns:
+ *  - true if the key was inserted.
+ *
+ * Behavior:
+ *  - Linearizable and safe to call concurrently with every other
+ *    member except clear().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLConcurrentTree<T, Compare, Allocator>::insert(const T& key) {
+    return insertKey(key);
+}
+
+
+/***************************************
+ * insert (move)
+ *
+ * Same as insert(const T&), moving the key into a new node. The key
+ * is left untouched if an equivalent one is already present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLConcurrentTree<T, Compare, Allocator>::insert(T&& key) {
+    return insertKey(std::move(key));
+}
+
+
+/***************************************
+ * erase
+ *
+ * Removes the key equivalent to key, if any.
+ *
+ * Returns:
+ *  - true if a key was removed.
+ *
+ * Behavior:
+ *  - Linearizable and safe to call concurrently. The node's memory is
+ *    freed later, once no concurrent reader can still see it.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLConcurrentTree<T, Compare, Allocator>::erase(const T& key) {
+    bool erased;
+    {
+        AVLEpoch::Guard guard(epoch);
+        while (true) {
+            Node* root = holder->right.load();
+            if (!root) {
+                erased = false;
+                break;
+            }
+            const std::uint64_t rootVersion = root->version.load();
+            if (rootVersion & (shrinking | unlinked)) {
+                waitUntilShrinkCompleted(root, rootVersion);
+            }
+            else if (root == holder->right.load()) {
+                Outcome outcome = attemptErase(key, holder, root, rootVersion);
+                if (outcome != Outcome::retry) {
+                    erased = outcome == Outcome::yes;
+                    break;
+                }
+            }
+        }
+    }
+    if (erased) {
+        tree_size.fetch_sub(1, std::memory_order_relaxed);
+    }
+    reclaim();
+    return erased;
+}
+
+
+/***************************************
+ * containsKey (private helper)
+ *
+ * Shared body of both contains overloads.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Q>
+bool AVLConcurrentTree<T, Compare, Allocator>::containsKey(const Q& key) const {
+    AVLEpoch::Guard guard(epoch);
+    while (true) {
+        Node* root = holder->right.load();
+        if (!root) {
+            return false;
+        }
+        const bool less = comp(key, root->key);
+        const bool greater = comp(root->key, key);
+        if (!less && !greater) {
+            return root->present.load();
+        }
+        const std::uint64_t rootVersion = root->version.load();
+        if (rootVersion & (shrinking | unlinked)) {
+            waitUntilShrinkCompleted(root, rootVersion);
+        }
+        else if (root == holder->right.load()) {
+            Outcome outcome = attemptGet(key, root, greater, rootVersion);
+            if (outcome != Outcome::retry) {
+                return outcome == Outcome::yes;
+            }
+        }
+    }
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns true if a key equivalent to key is present.
+ *
+ * Behavior:
+ *  - Lock-free apart from waiting out a rotation of a node on the
+ *    search path; linearizable.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLConcurrentTree<T, Compare, Allocator>::contains(const T& key) const {
+    return containsKey(key);
+}
+
+
+/***************************************
+ * contains (heterogeneous)
+ *
+ * Only available when Compare::is_transparent is defined.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Q, typename C, typename>
+bool AVLConcurrentTree<T, Compare, Allocator>::contains(const Q& key) const {
+    return containsKey(key);
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns the number of keys. Exact when no update is in flight.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLConcurrentTree<T, Compare, Allocator>::size() const {
+    return tree_size.load(std::memory_order_relaxed);
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns true if the tree holds no keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLConcurrentTree<T, Compare, Allocator>::empty() const {
+    return size() == 0;
+}
+
+
+/***************************************
+ * clear
+ *
+ * Removes and frees every node.
+ *
+ * Behavior:
+ *  - Not safe to run concurrently with any other member; call it
+ *    only while the tree is quiescent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLConcurrentTree<T, Compare, Allocator>::clear() {
+    destroySubtree(holder->right.load());
+    holder->right.store(nullptr);
+    holder->height.store(1);
+    for (Node* node : retired) {
+        destroyNode(node);
+    }
+    retired.clear();
+    retired_count.store(0, std::memory_order_relaxed);
+    tree_size.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,111 @@
+#ifndef AVLFROZENTREEHPP
+#define AVLFROZENTREEHPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+/***************************************
+ * AVLFrozenTree
+ *
+ * An immutable set in Eytzinger (breadth-first) order, produced by
+ * AVLTree::freeze(). Node k of the implicit tree has its children at
+ * 2k and 2k + 1, so a search walks one contiguous array instead of
+ * chasing heap pointers. The top levels share a few cache lines, and
+ * the descendants four levels below the current node are adjacent,
+ * so they can be prefetched a few steps early.
+ *
+ * Searches are branchless: every level is one comparison whose result
+ * picks the next index, with no data-dependent jump to mispredict.
+ * find(), lower_bound(), upper_bound(), contains() and in-order
+ * const_iterators mirror AVLTree's read-only API.
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class AVLFrozenTree {
+private:
+    // Eytzinger node k (1-based) is stored at keys[k]; keys[0] holds a
+    // copy of the smallest key so that indices need no adjustment.
+    std::vector<T, Allocator> keys;
+    Compare comp;
+
+    // Keys per 64-byte cache line, rounded down to a power of two;
+    // prefetching node k * line_keys fetches k's descendants that lie
+    // log2(line_keys) levels below it.
+    static constexpr std::size_t line_keys = sizeof(T) > 32 ? 1 : sizeof(T) > 16 ? 2 : sizeof(T) > 8 ? 4 :
+                                             sizeof(T) > 4 ? 8 : sizeof(T) > 2 ? 16 : sizeof(T) > 1 ? 32 : 64;
+
+    static void rankNodes(std::size_t k, std::size_t n, std::size_t& rank, std::vector<std::size_t>& order);
+    static void prefetch(const T* base, std::size_t k);
+    static std::size_t resolve(std::size_t k);
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    class const_iterator {
+        friend class AVLFrozenTree;
+    private:
+        const AVLFrozenTree* tree;
+        // Eytzinger index of the current key; 0 is end().
+        std::size_t k;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : tree(nullptr), k(0) {}
+        const_iterator(const AVLFrozenTree* t, std::size_t index) : tree(t), k(index) {}
+
+        reference operator*() const {
+            return tree->keys[k];
+        }
+        pointer operator->() const {
+            return &tree->keys[k];
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+
+        bool operator==(const const_iterator& other) const {
+            return k == other.k;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return k != other.k;
+        }
+    };
+
+    using iterator = const_iterator;
+
+    AVLFrozenTree();
+    explicit AVLFrozenTree(const Compare& compare, const Allocator& alloc = Allocator());
+    template <typename ForwardIt>
+    AVLFrozenTree(ForwardIt first, ForwardIt last, std::size_t n, const Compare& compare = Compare(),
+                  const Allocator& alloc = Allocator());
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    std::size_t size() const;
+
+    const_iterator find(const T& key) const;
+    const_iterator lower_bound(const T& key) const;
+    const_iterator upper_bound(const T& key) const;
+    bool contains(const T& key) const;
+};
+
+#include "AVLFrozenTreeImplementation.tpp"
+
+#endif
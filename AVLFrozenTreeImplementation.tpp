@@ -0,0 +1,366 @@
+#include "AVLFrozenTreeHeader.hpp"
+
+/***************************************
+ * AVLFrozenTree Constructor
+ *
+ * Initializes an empty frozen tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLFrozenTree<T, Compare, Allocator>::AVLFrozenTree()
+    : keys(), comp(Compare()) {}
+
+
+/***************************************
+ * AVLFrozenTree Constructor (comparator and allocator)
+ *
+ * Initializes an empty frozen tree with a custom comparator and an
+ * allocator for the key array.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLFrozenTree<T, Compare, Allocator>::AVLFrozenTree(const Compare& compare, const Allocator& alloc)
+    : keys(alloc), comp(compare) {}
+
+
+/***************************************
+ * AVLFrozenTree Constructor (sorted range)
+ *
+ * Lays out n strictly increasing keys in Eytzinger order.
+ *
+ * Parameters:
+ *  - first, last: The keys, in increasing order; dereferencing must
+ *    yield references that stay valid during the call (as AVLTree and
+ *    container iterators do).
+ *  - n: The number of keys in the range.
+ *  - compare, alloc: As for the other constructors.
+ *
+ * Behavior:
+ *  - O(n): one pass collects key addresses, an in-order walk of the
+ *    implicit tree assigns ranks to indices, and the keys are then
+ *    copied once, in breadth-first order.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename ForwardIt>
+AVLFrozenTree<T, Compare, Allocator>::AVLFrozenTree(ForwardIt first, ForwardIt last, std::size_t n,
+                                                    const Compare& compare, const Allocator& alloc)
+    : keys(alloc), comp(compare) {
+    if (n == 0) {
+        return;
+    }
+    std::vector<const T*> sorted;
+    sorted.reserve(n);
+    for (; first != last; ++first) {
+        sorted.push_back(std::addressof(*first));
+    }
+    std::vector<std::size_t> order(n + 1);
+    std::size_t rank = 0;
+    rankNodes(1, n, rank, order);
+
+    keys.reserve(n + 1);
+    keys.push_back(*sorted[0]);
+    for (std::size_t k = 1; k <= n; ++k) {
+        keys.push_back(*sorted[order[k]]);
+    }
+}
+
+
+/***************************************
+ * rankNodes (private helper)
+ *
+ * Records the in-order rank of every node of the implicit tree.
+ *
+ * Parameters:
+ *  - k: The subtree root to visit.
+ *  - n: Number of nodes.
+ *  - rank: The next rank to hand out; advanced past the subtree.
+ *  - order: Receives order[k] = rank of node k.
+ *
+ * Behavior:
+ *  - Recursion depth is log2(n).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLFrozenTree<T, Compare, Allocator>::rankNodes(std::size_t k, std::size_t n, std::size_t& rank, std::vector<std::size_t>& order) {
+    if (k > n) {
+        return;
+    }
+    rankNodes(2 * k, n, rank, order);
+    order[k] = rank++;
+    rankNodes(2 * k + 1, n, rank, order);
+}
+
+
+/***************************************
+ * prefetch (private helper)
+ *
+ * Hints the cache line holding node k * line_keys.
+ *
+ * Behavior:
+ *  - The address is formed as an integer, since it may lie past the
+ *    array; prefetches never fault. A no-op on compilers without
+ *    __builtin_prefetch.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLFrozenTree<T, Compare, Allocator>::prefetch(const T* base, std::size_t k) {
+#if defined(__GNUC__) || defined(__clang__)
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(base) + k * line_keys * sizeof(T);
+    __builtin_prefetch(reinterpret_cast<const void*>(address));
+#else
+    (void)base;
+    (void)k;
+#endif
+}
+
+
+/***************************************
+ * resolve (private helper)
+ *
+ * Maps the index a branchless descent ran off the tree at to the
+ * node it was looking for.
+ *
+ * Returns:
+ *  - The last node where the descent went left, or 0 (end()) if it
+ *    only ever went right.
+ *
+ * Behavior:
+ *  - The low bits of k record the turns taken, 1 for right; dropping
+ *    the trailing right turns and then the final left turn leaves that
+ *    node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLFrozenTree<T, Compare, Allocator>::resolve(std::size_t k) {
+#if defined(__GNUC__) || defined(__clang__)
+    return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+#else
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+#endif
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the tree holds no keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLFrozenTree<T, Compare, Allocator>::empty() const {
+    return keys.empty();
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLFrozenTree<T, Compare, Allocator>::size() const {
+    return keys.empty() ? 0 : keys.size() - 1;
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Finds the first key not less than key.
+ *
+ * Returns:
+ *  - An iterator to that key, or end().
+ *
+ * Behavior:
+ *  - Descends to a leaf without branching on the comparison: each
+ *    result is added to the next index. Every search runs the same
+ *    number of levels, and prefetches the line log2(line_keys) levels
+ *    ahead.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::lower_bound(const T& key) const {
+    const T* base = keys.data();
+    const std::size_t n = size();
+    std::size_t k = 1;
+    while (k <= n) {
+        prefetch(base, k);
+        k = 2 * k + static_cast<std::size_t>(comp(base[k], key));
+    }
+    return const_iterator(this, resolve(k));
+}
+
+
+/***************************************
+ * upper_bound
+ *
+ * Finds the first key greater than key.
+ *
+ * Returns:
+ *  - An iterator to that key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::upper_bound(const T& key) const {
+    const T* base = keys.data();
+    const std::size_t n = size();
+    std::size_t k = 1;
+    while (k <= n) {
+        prefetch(base, k);
+        k = 2 * k + static_cast<std::size_t>(!comp(key, base[k]));
+    }
+    return const_iterator(this, resolve(k));
+}
+
+
+/***************************************
+ * find
+ *
+ * Searches for a key.
+ *
+ * Returns:
+ *  - An iterator to the key equivalent to key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::find(const T& key) const {
+    const_iterator it = lower_bound(key);
+    return it.k != 0 && !comp(key, keys[it.k]) ? it : end();
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLFrozenTree<T, Compare, Allocator>::contains(const T& key) const {
+    return find(key) != end();
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key: the end of the left spine.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::begin() const {
+    const std::size_t n = size();
+    std::size_t k = n ? 1 : 0;
+    while (k && 2 * k <= n) {
+        k *= 2;
+    }
+    return const_iterator(this, k);
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - The past-the-end iterator (index 0).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::end() const {
+    return const_iterator(this, 0);
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Advances to the in-order successor by index arithmetic.
+ *
+ * Behavior:
+ *  - With a right child, the successor is the leftmost node below it.
+ *    Otherwise climb past every right-child link (odd index) and take
+ *    one more step up; climbing off the root yields end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator& AVLFrozenTree<T, Compare, Allocator>::const_iterator::operator++() {
+    const std::size_t n = tree->size();
+    if (2 * k + 1 <= n) {
+        k = 2 * k + 1;
+        while (2 * k <= n) {
+            k *= 2;
+        }
+    }
+    else {
+        while (k & 1) {
+            k >>= 1;
+        }
+        k >>= 1;
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Pre-decrement)
+ *
+ * Moves to the in-order predecessor; from end() it moves to the
+ * largest key. Mirrors operator++ with left and right exchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator& AVLFrozenTree<T, Compare, Allocator>::const_iterator::operator--() {
+    const std::size_t n = tree->size();
+    if (k == 0) {
+        k = 1;
+        while (2 * k + 1 <= n) {
+            k = 2 * k + 1;
+        }
+    }
+    else if (2 * k <= n) {
+        k = 2 * k;
+        while (2 * k + 1 <= n) {
+            k = 2 * k + 1;
+        }
+    }
+    else {
+        while (!(k & 1)) {
+            k >>= 1;
+        }
+        k >>= 1;
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Post-decrement)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLFrozenTree<T, Compare, Allocator>::const_iterator AVLFrozenTree<T, Compare, Allocator>::const_iterator::operator--(int) {
+    const_iterator temp = *this;
+    --(*this);
+    return temp;
+}
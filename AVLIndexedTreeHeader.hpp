@@ -0,0 +1,167 @@
+#ifndef AVLINDEXEDTREEHPP
+#define AVLINDEXEDTREEHPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/***************************************
+ * AVLIndexedTree
+ *
+ * An AVL set whose nodes live in one contiguous, growable pool and
+ * link to each other by 32-bit index instead of by pointer. A node
+ * holds its key and three links and nothing else: AVLTree<uint32_t>
+ * spends 32 bytes per node, AVLIndexedTree<uint32_t> spends 16.
+ *
+ *  - Each link is 31 bits wide. The top bit of left marks a node as
+ *    left-heavy and the top bit of right marks it right-heavy, so the
+ *    balance factor costs no extra bytes. A tree holds up to
+ *    max_nodes (2^31 - 1) keys.
+ *  - Erasing moves the last node of the pool into the freed slot, so
+ *    slots [0, size()) are always live. Copying or moving the tree
+ *    copies or moves the pool as is; no link needs fixing up, and for
+ *    trivially copyable keys the pool is a flat, relocatable image.
+ *  - Inserting may grow the pool and erasing relocates one node, so
+ *    both invalidate iterators.
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class AVLIndexedTree {
+public:
+    using index_type = std::uint32_t;
+
+    // Largest key count; index max_nodes itself is the null link.
+    static constexpr std::size_t max_nodes = 0x7FFFFFFF;
+
+private:
+    static constexpr index_type nil = 0x7FFFFFFF;
+    static constexpr index_type index_mask = 0x7FFFFFFF;
+    static constexpr index_type heavy_bit = 0x80000000;
+
+    struct Node {
+        index_type left;
+        index_type right;
+        index_type parent;
+        T key;
+
+        template <typename... Args>
+        explicit Node(index_type up, Args&&... args)
+            : left(nil), right(nil), parent(up), key(std::forward<Args>(args)...) {}
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+
+    std::vector<Node, NodeAllocator> nodes;
+    index_type root;
+    Compare comp;
+
+    index_type leftOf(index_type node) const;
+    index_type rightOf(index_type node) const;
+    void setLeft(index_type node, index_type child);
+    void setRight(index_type node, index_type child);
+    int getBalanceFactor(index_type node) const;
+    void setBalanceFactor(index_type node, int balance);
+    void replaceChild(index_type parent, index_type oldChild, index_type newChild);
+    index_type rotateLeft(index_type x, index_type z);
+    index_type rotateRight(index_type x, index_type z);
+    index_type rotateRightLeft(index_type x, index_type z);
+    index_type rotateLeftRight(index_type x, index_type z);
+    void retraceInsert(index_type node);
+    void retraceErase(index_type node, bool fromLeft);
+    void releaseSlot(index_type node);
+    index_type minIndex(index_type node) const;
+    index_type maxIndex(index_type node) const;
+    index_type nextIndex(index_type node) const;
+    index_type prevIndex(index_type node) const;
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    class const_iterator {
+        friend class AVLIndexedTree;
+    private:
+        const AVLIndexedTree* tree;
+        index_type index;
+
+        const_iterator(const AVLIndexedTree* t, index_type i) : tree(t), index(i) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : tree(nullptr), index(nil) {}
+
+        reference operator*() const {
+            return tree->nodes[index].key;
+        }
+        pointer operator->() const {
+            return &(tree->nodes[index].key);
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+
+        bool operator==(const const_iterator& other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // Keys are immutable once stored, so both names refer to one type.
+    using iterator = const_iterator;
+
+    AVLIndexedTree();
+    explicit AVLIndexedTree(const Compare& compare, const Allocator& alloc = Allocator());
+
+    void swap(AVLIndexedTree& other) noexcept;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    std::size_t size() const;
+    std::size_t capacity() const;
+    void reserve(std::size_t count);
+    void shrink_to_fit();
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    std::pair<iterator, bool> insert(const T& key);
+    std::pair<iterator, bool> insert(T&& key);
+    std::size_t erase(const T& key);
+    void clear();
+    const_iterator find(const T& key) const;
+    const_iterator lower_bound(const T& key) const;
+    const_iterator upper_bound(const T& key) const;
+    bool contains(const T& key) const;
+    std::size_t count(const T& key) const;
+
+private:
+    template <typename Make>
+    std::pair<iterator, bool> insertWith(const T& key, Make&& make);
+};
+
+template <typename T, typename Compare, typename Allocator>
+void swap(AVLIndexedTree<T, Compare, Allocator>& a, AVLIndexedTree<T, Compare, Allocator>& b) noexcept {
+    a.swap(b);
+}
+
+#include "AVLIndexedTreeImplementation.tpp"
+
+#endif
@@ -0,0 +1,872 @@
+#include "AVLIndexedTreeHeader.hpp"
+
+/***************************************
+ * AVLIndexedTree Constructor
+ *
+ * Initializes an empty indexed AVL tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLIndexedTree<T, Compare, Allocator>::AVLIndexedTree()
+    : nodes(NodeAllocator(Allocator())), root(nil), comp(Compare()) {}
+
+
+/***************************************
+ * AVLIndexedTree Constructor (comparator and allocator)
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain the node pool.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLIndexedTree<T, Compare, Allocator>::AVLIndexedTree(const Compare& compare, const Allocator& alloc)
+    : nodes(NodeAllocator(alloc)), root(nil), comp(compare) {}
+
+
+/***************************************
+ * swap
+ *
+ * Exchanges the contents of two trees in O(1).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::swap(AVLIndexedTree& other) noexcept {
+    using std::swap;
+    nodes.swap(other.nodes);
+    swap(root, other.root);
+    swap(comp, other.comp);
+}
+
+
+/***************************************
+ * leftOf / rightOf (private helpers)
+ *
+ * Returns:
+ *  - The index of a node's child with the balance bit masked off.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::leftOf(index_type node) const {
+    return nodes[node].left & index_mask;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::rightOf(index_type node) const {
+    return nodes[node].right & index_mask;
+}
+
+
+/***************************************
+ * setLeft / setRight (private helpers)
+ *
+ * Re-points a child link while keeping the node's balance bit.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::setLeft(index_type node, index_type child) {
+    nodes[node].left = (nodes[node].left & heavy_bit) | child;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::setRight(index_type node, index_type child) {
+    nodes[node].right = (nodes[node].right & heavy_bit) | child;
+}
+
+
+/***************************************
+ * getBalanceFactor (private helper)
+ *
+ * Returns:
+ *  - Height of the left subtree minus height of the right subtree,
+ *    decoded from the two balance bits.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLIndexedTree<T, Compare, Allocator>::getBalanceFactor(index_type node) const {
+    return static_cast<int>(nodes[node].left >> 31) - static_cast<int>(nodes[node].right >> 31);
+}
+
+
+/***************************************
+ * setBalanceFactor (private helper)
+ *
+ * Parameters:
+ *  - balance: -1, 0 or 1, in the sense of getBalanceFactor().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::setBalanceFactor(index_type node, int balance) {
+    nodes[node].left = (nodes[node].left & index_mask) | (balance > 0 ? heavy_bit : 0);
+    nodes[node].right = (nodes[node].right & index_mask) | (balance < 0 ? heavy_bit : 0);
+}
+
+
+/***************************************
+ * replaceChild (private helper)
+ *
+ * Re-points the link that referred to oldChild and sets newChild's
+ * parent; updates root when parent is nil.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::replaceChild(index_type parent, index_type oldChild, index_type newChild) {
+    if (parent == nil) {
+        root = newChild;
+    }
+    else if (leftOf(parent) == oldChild) {
+        setLeft(parent, newChild);
+    }
+    else {
+        setRight(parent, newChild);
+    }
+    if (newChild != nil) {
+        nodes[newChild].parent = parent;
+    }
+}
+
+
+/***************************************
+ * rotateLeft (private helper)
+ *
+ * Lifts z, the right child of x, above x.
+ *
+ * Returns:
+ *  - z, the new subtree root. Its parent link and the link into it are
+ *    left to the caller.
+ *
+ * Behavior:
+ *  - z is either right-heavy (insert or erase) or balanced (erase
+ *    only, in which case the subtree keeps its height).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::rotateLeft(index_type x, index_type z) {
+    const index_type inner = leftOf(z);
+    setRight(x, inner);
+    if (inner != nil) {
+        nodes[inner].parent = x;
+    }
+    setLeft(z, x);
+    nodes[x].parent = z;
+
+    if (getBalanceFactor(z) == 0) {
+        setBalanceFactor(x, -1);
+        setBalanceFactor(z, 1);
+    }
+    else {
+        setBalanceFactor(x, 0);
+        setBalanceFactor(z, 0);
+    }
+    return z;
+}
+
+
+/***************************************
+ * rotateRight (private helper)
+ *
+ * Mirror image of rotateLeft: lifts z, the left child of x.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::rotateRight(index_type x, index_type z) {
+    const index_type inner = rightOf(z);
+    setLeft(x, inner);
+    if (inner != nil) {
+        nodes[inner].parent = x;
+    }
+    setRight(z, x);
+    nodes[x].parent = z;
+
+    if (getBalanceFactor(z) == 0) {
+        setBalanceFactor(x, 1);
+        setBalanceFactor(z, -1);
+    }
+    else {
+        setBalanceFactor(x, 0);
+        setBalanceFactor(z, 0);
+    }
+    return z;
+}
+
+
+/***************************************
+ * rotateRightLeft (private helper)
+ *
+ * Double rotation for a right child z that is left-heavy: z's left
+ * child y becomes the subtree root with x and z as its children.
+ *
+ * Returns:
+ *  - y, the new subtree root, which comes out balanced.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::rotateRightLeft(index_type x, index_type z) {
+    const index_type y = leftOf(z);
+    const index_type yLeft = leftOf(y);
+    const index_type yRight = rightOf(y);
+    const int balance = getBalanceFactor(y);
+
+    setLeft(z, yRight);
+    if (yRight != nil) {
+        nodes[yRight].parent = z;
+    }
+    setRight(x, yLeft);
+    if (yLeft != nil) {
+        nodes[yLeft].parent = x;
+    }
+    setLeft(y, x);
+    setRight(y, z);
+    nodes[x].parent = y;
+    nodes[z].parent = y;
+
+    setBalanceFactor(x, balance < 0 ? 1 : 0);
+    setBalanceFactor(z, balance > 0 ? -1 : 0);
+    setBalanceFactor(y, 0);
+    return y;
+}
+
+
+/***************************************
+ * rotateLeftRight (private helper)
+ *
+ * Mirror image of rotateRightLeft for a left child z that is
+ * right-heavy.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::rotateLeftRight(index_type x, index_type z) {
+    const index_type y = rightOf(z);
+    const index_type yLeft = leftOf(y);
+    const index_type yRight = rightOf(y);
+    const int balance = getBalanceFactor(y);
+
+    setRight(z, yLeft);
+    if (yLeft != nil) {
+        nodes[yLeft].parent = z;
+    }
+    setLeft(x, yRight);
+    if (yRight != nil) {
+        nodes[yRight].parent = x;
+    }
+    setLeft(y, z);
+    setRight(y, x);
+    nodes[x].parent = y;
+    nodes[z].parent = y;
+
+    setBalanceFactor(x, balance > 0 ? -1 : 0);
+    setBalanceFactor(z, balance < 0 ? 1 : 0);
+    setBalanceFactor(y, 0);
+    return y;
+}
+
+
+/***************************************
+ * retraceInsert (private helper)
+ *
+ * Walks up from a node whose subtree just grew by one level.
+ *
+ * Behavior:
+ *  - A parent that was heavy on the other side becomes balanced and
+ *    the walk stops; a balanced parent tips towards the child and the
+ *    walk continues; a parent already heavy on the child's side is
+ *    rotated, which restores its old height and ends the walk.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::retraceInsert(index_type node) {
+    for (index_type parent = nodes[node].parent; parent != nil; parent = nodes[node].parent) {
+        const int balance = getBalanceFactor(parent);
+        const index_type grand = nodes[parent].parent;
+        index_type subtree;
+        if (node == rightOf(parent)) {
+            if (balance >= 0) {
+                setBalanceFactor(parent, balance - 1);
+                if (balance > 0) {
+                    return;
+                }
+                node = parent;
+                continue;
+            }
+            subtree = getBalanceFactor(node) > 0 ? rotateRightLeft(parent, node) : rotateLeft(parent, node);
+        }
+        else {
+            if (balance <= 0) {
+                setBalanceFactor(parent, balance + 1);
+                if (balance < 0) {
+                    return;
+                }
+                node = parent;
+                continue;
+            }
+            subtree = getBalanceFactor(node) < 0 ? rotateLeftRight(parent, node) : rotateRight(parent, node);
+        }
+        replaceChild(grand, parent, subtree);
+        return;
+    }
+}
+
+
+/***************************************
+ * retraceErase (private helper)
+ *
+ * Walks up from a node whose subtree on one side just lost a level.
+ *
+ * Parameters:
+ *  - node: The lowest node whose balance changed.
+ *  - fromLeft: Whether node's left subtree got shorter.
+ *
+ * Behavior:
+ *  - Stops once a subtree's height comes out unchanged: at a node that
+ *    was balanced, or after a single rotation about a balanced child.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::retraceErase(index_type node, bool fromLeft) {
+    while (node != nil) {
+        const int balance = getBalanceFactor(node);
+        const index_type parent = nodes[node].parent;
+        index_type subtree = node;
+        bool shrank = true;
+        if (fromLeft) {
+            if (balance >= 0) {
+                setBalanceFactor(node, balance - 1);
+                shrank = balance > 0;
+            }
+            else {
+                const index_type sibling = rightOf(node);
+                const int siblingBalance = getBalanceFactor(sibling);
+                subtree = siblingBalance > 0 ? rotateRightLeft(node, sibling) : rotateLeft(node, sibling);
+                shrank = siblingBalance != 0;
+            }
+        }
+        else {
+            if (balance <= 0) {
+                setBalanceFactor(node, balance + 1);
+                shrank = balance < 0;
+            }
+            else {
+                const index_type sibling = leftOf(node);
+                const int siblingBalance = getBalanceFactor(sibling);
+                subtree = siblingBalance < 0 ? rotateLeftRight(node, sibling) : rotateRight(node, sibling);
+                shrank = siblingBalance != 0;
+            }
+        }
+
+        fromLeft = parent != nil && leftOf(parent) == node;
+        if (subtree != node) {
+            replaceChild(parent, node, subtree);
+        }
+        if (!shrank) {
+            return;
+        }
+        node = parent;
+    }
+}
+
+
+/***************************************
+ * releaseSlot (private helper)
+ *
+ * Frees the pool slot of a node that is no longer linked into the
+ * tree.
+ *
+ * Behavior:
+ *  - Moves the last node of the pool into the slot and re-points its
+ *    parent's and children's links, then shrinks the pool by one.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::releaseSlot(index_type node) {
+    const index_type last = static_cast<index_type>(nodes.size() - 1);
+    if (node != last) {
+        nodes[node] = std::move(nodes[last]);
+        const index_type parent = nodes[node].parent;
+        if (parent == nil) {
+            root = node;
+        }
+        else if (leftOf(parent) == last) {
+            setLeft(parent, node);
+        }
+        else {
+            setRight(parent, node);
+        }
+        if (leftOf(node) != nil) {
+            nodes[leftOf(node)].parent = node;
+        }
+        if (rightOf(node) != nil) {
+            nodes[rightOf(node)].parent = node;
+        }
+    }
+    nodes.pop_back();
+}
+
+
+/***************************************
+ * minIndex / maxIndex (private helpers)
+ *
+ * Returns:
+ *  - The first or last node of a subtree, or nil if it is empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::minIndex(index_type node) const {
+    while (node != nil && leftOf(node) != nil) {
+        node = leftOf(node);
+    }
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::maxIndex(index_type node) const {
+    while (node != nil && rightOf(node) != nil) {
+        node = rightOf(node);
+    }
+    return node;
+}
+
+
+/***************************************
+ * nextIndex / prevIndex (private helpers)
+ *
+ * Returns:
+ *  - The in-order successor or predecessor of a node, or nil.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::nextIndex(index_type node) const {
+    if (rightOf(node) != nil) {
+        return minIndex(rightOf(node));
+    }
+    index_type parent = nodes[node].parent;
+    while (parent != nil && node == rightOf(parent)) {
+        node = parent;
+        parent = nodes[parent].parent;
+    }
+    return parent;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::index_type AVLIndexedTree<T, Compare, Allocator>::prevIndex(index_type node) const {
+    if (leftOf(node) != nil) {
+        return maxIndex(leftOf(node));
+    }
+    index_type parent = nodes[node].parent;
+    while (parent != nil && node == leftOf(parent)) {
+        node = parent;
+        parent = nodes[parent].parent;
+    }
+    return parent;
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the tree holds no keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLIndexedTree<T, Compare, Allocator>::empty() const {
+    return nodes.empty();
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLIndexedTree<T, Compare, Allocator>::size() const {
+    return nodes.size();
+}
+
+
+/***************************************
+ * capacity
+ *
+ * Returns:
+ *  - The number of nodes the pool can hold before it grows.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLIndexedTree<T, Compare, Allocator>::capacity() const {
+    return nodes.capacity();
+}
+
+
+/***************************************
+ * reserve
+ *
+ * Grows the pool to hold at least count nodes without reallocating.
+ *
+ * Behavior:
+ *  - Throws std::length_error if count exceeds max_nodes.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::reserve(std::size_t count) {
+    if (count > max_nodes) {
+        throw std::length_error("AVLIndexedTree::reserve exceeds max_nodes");
+    }
+    nodes.reserve(count);
+}
+
+
+/***************************************
+ * shrink_to_fit
+ *
+ * Asks the pool to release capacity beyond size().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::shrink_to_fit() {
+    nodes.shrink_to_fit();
+}
+
+
+/***************************************
+ * insertWith (private helper)
+ *
+ * Inserts a node for key unless an equivalent key is present.
+ *
+ * Parameters:
+ *  - key: The key used for the descent.
+ *  - make: Callable appending the new node to the pool, given its
+ *    parent index; only invoked once the slot is known to be free.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - Throws std::length_error if the tree already holds max_nodes
+ *    keys; the tree is unchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Make>
+std::pair<typename AVLIndexedTree<T, Compare, Allocator>::iterator, bool> AVLIndexedTree<T, Compare, Allocator>::insertWith(const T& key, Make&& make) {
+    index_type parent = nil;
+    index_type current = root;
+    bool goLeft = false;
+    while (current != nil) {
+        parent = current;
+        if (comp(key, nodes[current].key)) {
+            current = leftOf(current);
+            goLeft = true;
+        }
+        else if (comp(nodes[current].key, key)) {
+            current = rightOf(current);
+            goLeft = false;
+        }
+        else {
+            return std::make_pair(const_iterator(this, current), false);
+        }
+    }
+    if (nodes.size() >= max_nodes) {
+        throw std::length_error("AVLIndexedTree holds max_nodes keys");
+    }
+
+    const index_type node = static_cast<index_type>(nodes.size());
+    make(parent);
+    if (parent == nil) {
+        root = node;
+    }
+    else if (goLeft) {
+        setLeft(parent, node);
+    }
+    else {
+        setRight(parent, node);
+    }
+    retraceInsert(node);
+    return std::make_pair(const_iterator(this, node), true);
+}
+
+
+/***************************************
+ * emplace
+ *
+ * Constructs a key and inserts it.
+ *
+ * Parameters:
+ *  - args: Arguments forwarded to T's constructor.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - The key is built first because it drives the descent, then moved
+ *    into the pool.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename AVLIndexedTree<T, Compare, Allocator>::iterator, bool> AVLIndexedTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    return insert(T(std::forward<Args>(args)...));
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a copy of key unless an equivalent key is present.
+ *
+ * Returns:
+ *  - Same as emplace().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLIndexedTree<T, Compare, Allocator>::iterator, bool> AVLIndexedTree<T, Compare, Allocator>::insert(const T& key) {
+    return insertWith(key, [this, &key](index_type parent) { nodes.emplace_back(parent, key); });
+}
+
+
+/***************************************
+ * insert (move)
+ *
+ * Inserts key by moving it into the pool; key is left untouched if an
+ * equivalent key is present.
+ *
+ * Returns:
+ *  - Same as emplace().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLIndexedTree<T, Compare, Allocator>::iterator, bool> AVLIndexedTree<T, Compare, Allocator>::insert(T&& key) {
+    return insertWith(key, [this, &key](index_type parent) { nodes.emplace_back(parent, std::move(key)); });
+}
+
+
+/***************************************
+ * erase
+ *
+ * Removes the key equivalent to key, if any.
+ *
+ * Returns:
+ *  - The number of keys removed (0 or 1).
+ *
+ * Behavior:
+ *  - A node with two children is replaced by relinking its in-order
+ *    successor into its place and taking over its balance.
+ *  - After retracing, the freed slot is filled with the pool's last
+ *    node so the pool stays dense.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLIndexedTree<T, Compare, Allocator>::erase(const T& key) {
+    const index_type node = find(key).index;
+    if (node == nil) {
+        return 0;
+    }
+
+    const index_type parent = nodes[node].parent;
+    const index_type left = leftOf(node);
+    const index_type right = rightOf(node);
+    index_type retraceFrom;
+    bool fromLeft;
+    if (left != nil && right != nil) {
+        const index_type successor = minIndex(right);
+        if (successor == right) {
+            retraceFrom = successor;
+            fromLeft = false;
+        }
+        else {
+            const index_type successorParent = nodes[successor].parent;
+            const index_type successorRight = rightOf(successor);
+            setLeft(successorParent, successorRight);
+            if (successorRight != nil) {
+                nodes[successorRight].parent = successorParent;
+            }
+            setRight(successor, right);
+            nodes[right].parent = successor;
+            retraceFrom = successorParent;
+            fromLeft = true;
+        }
+        setLeft(successor, left);
+        nodes[left].parent = successor;
+        setBalanceFactor(successor, getBalanceFactor(node));
+        replaceChild(parent, node, successor);
+    }
+    else {
+        retraceFrom = parent;
+        fromLeft = parent != nil && leftOf(parent) == node;
+        replaceChild(parent, node, left != nil ? left : right);
+    }
+
+    retraceErase(retraceFrom, fromLeft);
+    releaseSlot(node);
+    return 1;
+}
+
+
+/***************************************
+ * clear
+ *
+ * Removes every key; the pool keeps its capacity.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLIndexedTree<T, Compare, Allocator>::clear() {
+    nodes.clear();
+    root = nil;
+}
+
+
+/***************************************
+ * find
+ *
+ * Returns:
+ *  - An iterator to the key equivalent to key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::find(const T& key) const {
+    index_type current = root;
+    while (current != nil) {
+        const Node& node = nodes[current];
+        if (comp(key, node.key)) {
+            current = node.left & index_mask;
+        }
+        else if (comp(node.key, key)) {
+            current = node.right & index_mask;
+        }
+        else {
+            break;
+        }
+    }
+    return const_iterator(this, current);
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Returns:
+ *  - An iterator to the first key not less than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::lower_bound(const T& key) const {
+    index_type current = root;
+    index_type result = nil;
+    while (current != nil) {
+        if (!comp(nodes[current].key, key)) {
+            result = current;
+            current = leftOf(current);
+        }
+        else {
+            current = rightOf(current);
+        }
+    }
+    return const_iterator(this, result);
+}
+
+
+/***************************************
+ * upper_bound
+ *
+ * Returns:
+ *  - An iterator to the first key greater than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::upper_bound(const T& key) const {
+    index_type current = root;
+    index_type result = nil;
+    while (current != nil) {
+        if (comp(key, nodes[current].key)) {
+            result = current;
+            current = leftOf(current);
+        }
+        else {
+            current = rightOf(current);
+        }
+    }
+    return const_iterator(this, result);
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLIndexedTree<T, Compare, Allocator>::contains(const T& key) const {
+    return find(key) != end();
+}
+
+
+/***************************************
+ * count
+ *
+ * Returns:
+ *  - 1 if key is present, 0 otherwise.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLIndexedTree<T, Compare, Allocator>::count(const T& key) const {
+    return contains(key) ? 1 : 0;
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::begin() const {
+    return const_iterator(this, minIndex(root));
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - The past-the-end iterator.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::end() const {
+    return const_iterator(this, nil);
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Advances to the in-order successor through parent indices.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator& AVLIndexedTree<T, Compare, Allocator>::const_iterator::operator++() {
+    index = tree->nextIndex(index);
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Pre-decrement)
+ *
+ * Moves to the in-order predecessor; from end() it moves to the
+ * largest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator& AVLIndexedTree<T, Compare, Allocator>::const_iterator::operator--() {
+    index = index == nil ? tree->maxIndex(tree->root) : tree->prevIndex(index);
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Post-decrement)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLIndexedTree<T, Compare, Allocator>::const_iterator AVLIndexedTree<T, Compare, Allocator>::const_iterator::operator--(int) {
+    const_iterator temp = *this;
+    --(*this);
+    return temp;
+}
@@ -0,0 +1,165 @@
+#ifndef AVLMAPHPP
+#define AVLMAPHPP
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "AVLTreeHeader.hpp"
+
+/***************************************
+ * AVLMapCompare
+ *
+ * Orders map entries by key alone. It is transparent, so the
+ * underlying tree can be searched with a bare key without first
+ * building an entry.
+ ***************************************/
+template <typename K, typename V, typename Compare>
+struct AVLMapCompare {
+    using is_transparent = void;
+    using value_type = std::pair<const K, V>;
+
+    Compare comp;
+
+    AVLMapCompare() : comp() {}
+    explicit AVLMapCompare(const Compare& compare) : comp(compare) {}
+
+    bool operator()(const value_type& a, const value_type& b) const {
+        return comp(a.first, b.first);
+    }
+    template <typename U>
+    bool operator()(const value_type& a, const U& b) const {
+        return comp(a.first, b);
+    }
+    template <typename U>
+    bool operator()(const U& a, const value_type& b) const {
+        return comp(a, b.first);
+    }
+};
+
+
+/***************************************
+ * AVLMap
+ *
+ * An ordered key/value map on top of the AVLTree node engine. Entries
+ * are stored as std::pair<const K, V>: iterators hand out the pair
+ * with a read-only key and a mutable value, so values are updated in
+ * place without erasing and reinserting. operator[], try_emplace and
+ * insert_or_assign descend once and only allocate for a new key.
+ ***************************************/
+template <typename K, typename V, typename Compare = std::less<K>,
+          typename Allocator = std::allocator<std::pair<const K, V> >,
+          typename Policy = AVLDefaultPolicy>
+class AVLMap {
+    static_assert(!Policy::multiset, "AVLMap keys are unique; use a multiset policy with AVLTree");
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using policy_type = Policy;
+
+private:
+    using Tree = AVLTree<value_type, AVLMapCompare<K, V, Compare>, Allocator, Policy>;
+    using Node = typename Tree::Node;
+
+    Tree tree;
+
+    template <typename Key, typename... Args>
+    std::pair<Node*, bool> tryEmplaceNode(Key&& key, Args&&... args);
+
+public:
+    using iterator = typename Tree::iterator;
+    using const_iterator = typename Tree::const_iterator;
+    using reverse_iterator = typename Tree::reverse_iterator;
+    using const_reverse_iterator = typename Tree::const_reverse_iterator;
+    using node_type = typename Tree::node_type;
+    using insert_return_type = typename Tree::insert_return_type;
+
+    AVLMap();
+    explicit AVLMap(const Compare& compare, const Allocator& alloc = Allocator());
+    explicit AVLMap(const Allocator& alloc);
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    AVLMap(InputIt first, InputIt last, const Compare& compare = Compare(),
+           const Allocator& alloc = Allocator());
+
+    void swap(AVLMap& other) noexcept;
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    reverse_iterator rbegin();
+    reverse_iterator rend();
+    const_reverse_iterator rbegin() const;
+    const_reverse_iterator rend() const;
+
+    bool empty() const;
+    std::size_t size() const;
+    void clear();
+
+    V& operator[](const K& key);
+    V& operator[](K&& key);
+    V& at(const K& key);
+    const V& at(const K& key) const;
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args);
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& value);
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value);
+    std::pair<iterator, bool> insert(const value_type& entry);
+    std::pair<iterator, bool> insert(value_type&& entry);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+
+    iterator erase(const_iterator pos);
+    std::size_t erase(const K& key);
+
+    node_type extract(const_iterator pos);
+    node_type extract(const K& key);
+    insert_return_type insert(node_type&& nh);
+    void merge(AVLMap& source);
+
+    iterator find(const K& key);
+    const_iterator find(const K& key) const;
+    template <typename Q, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const Q& key);
+    template <typename Q, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const Q& key) const;
+
+    bool contains(const K& key) const;
+    template <typename Q, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Q& key) const;
+    std::size_t count(const K& key) const;
+
+    iterator lower_bound(const K& key);
+    const_iterator lower_bound(const K& key) const;
+    iterator upper_bound(const K& key);
+    const_iterator upper_bound(const K& key) const;
+    std::pair<iterator, iterator> equal_range(const K& key);
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const;
+};
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+void swap(AVLMap<K, V, Compare, Allocator, Policy>& a, AVLMap<K, V, Compare, Allocator, Policy>& b) noexcept {
+    a.swap(b);
+}
+
+#include "AVLMapImplementation.tpp"
+
+#endif
@@ -0,0 +1,523 @@
+#include "AVLMapHeader.hpp"
+
+/***************************************
+ * AVLMap Constructor
+ *
+ * Initializes an empty map.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+AVLMap<K, V, Compare, Allocator, Policy>::AVLMap() : tree() {}
+
+
+/***************************************
+ * AVLMap Constructor (comparator and allocator)
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+AVLMap<K, V, Compare, Allocator, Policy>::AVLMap(const Compare& compare, const Allocator& alloc)
+    : tree(AVLMapCompare<K, V, Compare>(compare), alloc) {}
+
+
+/***************************************
+ * AVLMap Constructor (allocator)
+ *
+ * Parameters:
+ *  - alloc: The allocator used to obtain node storage.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+AVLMap<K, V, Compare, Allocator, Policy>::AVLMap(const Allocator& alloc) : tree(alloc) {}
+
+
+/***************************************
+ * AVLMap Constructor (range)
+ *
+ * Builds a map from the entries in [first, last).
+ *
+ * Parameters:
+ *  - first, last: The input range of key/value pairs.
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ *
+ * Behavior:
+ *  - The first entry for each key wins, as with insert().
+ *  - Every entry is hinted at end(), so sorted input is appended
+ *    without a descent.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt, typename>
+AVLMap<K, V, Compare, Allocator, Policy>::AVLMap(InputIt first, InputIt last, const Compare& compare,
+                                                 const Allocator& alloc)
+    : tree(AVLMapCompare<K, V, Compare>(compare), alloc) {
+    for (; first != last; ++first) {
+        tree.emplace_hint(tree.cend(), *first);
+    }
+}
+
+
+/***************************************
+ * swap
+ *
+ * Exchanges the contents of two maps in O(1).
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+void AVLMap<K, V, Compare, Allocator, Policy>::swap(AVLMap& other) noexcept {
+    tree.swap(other.tree);
+}
+
+
+/***************************************
+ * get_allocator
+ *
+ * Returns:
+ *  - A copy of the allocator the map was constructed with.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::allocator_type AVLMap<K, V, Compare, Allocator, Policy>::get_allocator() const {
+    return tree.get_allocator();
+}
+
+
+/***************************************
+ * key_comp
+ *
+ * Returns:
+ *  - A copy of the key comparator.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::key_compare AVLMap<K, V, Compare, Allocator, Policy>::key_comp() const {
+    return tree.comp.comp;
+}
+
+
+/***************************************
+ * Iterators
+ *
+ * Forward to the underlying tree. Dereferencing yields
+ * std::pair<const K, V>&, so only the value can be modified.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::begin() {
+    return tree.begin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::end() {
+    return tree.end();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::begin() const {
+    return tree.begin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::end() const {
+    return tree.end();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::cbegin() const {
+    return tree.cbegin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::cend() const {
+    return tree.cend();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::reverse_iterator AVLMap<K, V, Compare, Allocator, Policy>::rbegin() {
+    return tree.rbegin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::reverse_iterator AVLMap<K, V, Compare, Allocator, Policy>::rend() {
+    return tree.rend();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_reverse_iterator AVLMap<K, V, Compare, Allocator, Policy>::rbegin() const {
+    return tree.rbegin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_reverse_iterator AVLMap<K, V, Compare, Allocator, Policy>::rend() const {
+    return tree.rend();
+}
+
+
+/***************************************
+ * empty / size / clear
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+bool AVLMap<K, V, Compare, Allocator, Policy>::empty() const {
+    return tree.empty();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLMap<K, V, Compare, Allocator, Policy>::size() const {
+    return tree.size();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+void AVLMap<K, V, Compare, Allocator, Policy>::clear() {
+    tree.clear();
+}
+
+
+/***************************************
+ * tryEmplaceNode (private helper)
+ *
+ * Finds the node for a key, creating it if absent.
+ *
+ * Parameters:
+ *  - key: The key to look up, forwarded into a new entry.
+ *  - args: Arguments for V's constructor, used only for a new entry.
+ *
+ * Returns:
+ *  - The node holding the key and whether it was newly inserted.
+ *
+ * Behavior:
+ *  - One descent locates either the existing entry or the free slot;
+ *    nothing is allocated or constructed when the key is present.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename Key, typename... Args>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::Node*, bool> AVLMap<K, V, Compare, Allocator, Policy>::tryEmplaceNode(Key&& key, Args&&... args) {
+    Node* parent;
+    bool goLeft;
+    Node* existing = tree.findInsertPosition(key, parent, goLeft);
+    if (existing) {
+        return std::make_pair(existing, false);
+    }
+    Node* node = tree.createNode(parent, std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<Key>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+    tree.linkNode(node, parent, goLeft);
+    return std::make_pair(node, true);
+}
+
+
+/***************************************
+ * operator[]
+ *
+ * Accesses the value for a key, inserting a value-initialized one if
+ * the key is absent.
+ *
+ * Parameters:
+ *  - key: The key to look up.
+ *
+ * Returns:
+ *  - A reference to the mapped value.
+ *
+ * Behavior:
+ *  - `map[k] += 1` on an existing key is a single descent with no
+ *    allocation.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+V& AVLMap<K, V, Compare, Allocator, Policy>::operator[](const K& key) {
+    return tryEmplaceNode(key).first->key.second;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+V& AVLMap<K, V, Compare, Allocator, Policy>::operator[](K&& key) {
+    return tryEmplaceNode(std::move(key)).first->key.second;
+}
+
+
+/***************************************
+ * at
+ *
+ * Accesses the value for an existing key.
+ *
+ * Parameters:
+ *  - key: The key to look up.
+ *
+ * Returns:
+ *  - A reference to the mapped value.
+ *
+ * Behavior:
+ *  - Throws std::out_of_range if the key is absent.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+V& AVLMap<K, V, Compare, Allocator, Policy>::at(const K& key) {
+    Node* node = tree.findNode(key);
+    if (!node) {
+        throw std::out_of_range("AVLMap::at: key not found");
+    }
+    return node->key.second;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+const V& AVLMap<K, V, Compare, Allocator, Policy>::at(const K& key) const {
+    Node* node = tree.findNode(key);
+    if (!node) {
+        throw std::out_of_range("AVLMap::at: key not found");
+    }
+    return node->key.second;
+}
+
+
+/***************************************
+ * try_emplace
+ *
+ * Inserts an entry built from key and args unless the key exists.
+ *
+ * Parameters:
+ *  - key: The key to insert.
+ *  - args: Arguments forwarded to V's constructor.
+ *
+ * Returns:
+ *  - An iterator to the entry for key and whether it was inserted.
+ *
+ * Behavior:
+ *  - When the key exists, neither key nor args are moved from.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename... Args>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::try_emplace(const K& key, Args&&... args) {
+    std::pair<Node*, bool> result = tryEmplaceNode(key, std::forward<Args>(args)...);
+    return std::make_pair(iterator(result.first, &tree), result.second);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename... Args>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::try_emplace(K&& key, Args&&... args) {
+    std::pair<Node*, bool> result = tryEmplaceNode(std::move(key), std::forward<Args>(args)...);
+    return std::make_pair(iterator(result.first, &tree), result.second);
+}
+
+
+/***************************************
+ * insert_or_assign
+ *
+ * Inserts an entry, or assigns to the value of an existing one.
+ *
+ * Parameters:
+ *  - key: The key to insert or update.
+ *  - value: The new mapped value.
+ *
+ * Returns:
+ *  - An iterator to the entry and whether it was newly inserted.
+ *
+ * Behavior:
+ *  - An update assigns in place; the tree structure is untouched.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename M>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::insert_or_assign(const K& key, M&& value) {
+    std::pair<Node*, bool> result = tryEmplaceNode(key, std::forward<M>(value));
+    if (!result.second) {
+        // tryEmplaceNode left value untouched since nothing was built.
+        result.first->key.second = std::forward<M>(value);
+    }
+    return std::make_pair(iterator(result.first, &tree), result.second);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename M>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::insert_or_assign(K&& key, M&& value) {
+    std::pair<Node*, bool> result = tryEmplaceNode(std::move(key), std::forward<M>(value));
+    if (!result.second) {
+        result.first->key.second = std::forward<M>(value);
+    }
+    return std::make_pair(iterator(result.first, &tree), result.second);
+}
+
+
+/***************************************
+ * insert / emplace
+ *
+ * Inserts an entry unless its key is already present.
+ *
+ * Returns:
+ *  - An iterator to the entry for the key and whether it was inserted.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::insert(const value_type& entry) {
+    return tree.insert(entry);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::insert(value_type&& entry) {
+    return tree.insert(std::move(entry));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename... Args>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, bool> AVLMap<K, V, Compare, Allocator, Policy>::emplace(Args&&... args) {
+    return tree.emplace(std::forward<Args>(args)...);
+}
+
+
+/***************************************
+ * erase (iterator)
+ *
+ * Removes the entry at pos.
+ *
+ * Parameters:
+ *  - pos: A valid, dereferenceable iterator into this map.
+ *
+ * Returns:
+ *  - An iterator to the entry that followed pos.
+ *
+ * Behavior:
+ *  - Nodes are relinked rather than having entries moved between
+ *    them, so iterators to other entries stay valid.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::erase(const_iterator pos) {
+    Node* node = Tree::nodeOf(pos);
+    Node* next = Tree::nextNode(node);
+    tree.eraseNode(node);
+    return iterator(next, &tree);
+}
+
+
+/***************************************
+ * erase (key)
+ *
+ * Removes the entry for a key.
+ *
+ * Returns:
+ *  - The number of entries removed (0 or 1).
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLMap<K, V, Compare, Allocator, Policy>::erase(const K& key) {
+    Node* node = tree.findNode(key);
+    if (!node) {
+        return 0;
+    }
+    tree.eraseNode(node);
+    return 1;
+}
+
+
+/***************************************
+ * extract / insert (node handle) / merge
+ *
+ * Move entries between maps with equal allocators by relinking
+ * their nodes, without allocating or copying keys or values. See the
+ * AVLTree functions of the same names.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::node_type AVLMap<K, V, Compare, Allocator, Policy>::extract(const_iterator pos) {
+    return tree.extract(pos);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::node_type AVLMap<K, V, Compare, Allocator, Policy>::extract(const K& key) {
+    Node* node = tree.findNode(key);
+    if (!node) {
+        return node_type();
+    }
+    return tree.extract(const_iterator(node, &tree));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::insert_return_type AVLMap<K, V, Compare, Allocator, Policy>::insert(node_type&& nh) {
+    return tree.insert(std::move(nh));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+void AVLMap<K, V, Compare, Allocator, Policy>::merge(AVLMap& source) {
+    tree.merge(source.tree);
+}
+
+
+/***************************************
+ * find
+ *
+ * Searches for the entry with a key.
+ *
+ * Parameters:
+ *  - key: K, or with a transparent comparator any type it accepts.
+ *
+ * Returns:
+ *  - An iterator to the entry, or end() if absent.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::find(const K& key) {
+    return iterator(tree.findNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::find(const K& key) const {
+    return const_iterator(tree.findNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename Q, typename C, typename>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::find(const Q& key) {
+    return iterator(tree.findNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename Q, typename C, typename>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::find(const Q& key) const {
+    return const_iterator(tree.findNode(key), &tree);
+}
+
+
+/***************************************
+ * contains / count
+ *
+ * Returns:
+ *  - Whether the key is present (count: 1 or 0).
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+bool AVLMap<K, V, Compare, Allocator, Policy>::contains(const K& key) const {
+    return tree.findNode(key) != nullptr;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+template <typename Q, typename C, typename>
+bool AVLMap<K, V, Compare, Allocator, Policy>::contains(const Q& key) const {
+    return tree.findNode(key) != nullptr;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLMap<K, V, Compare, Allocator, Policy>::count(const K& key) const {
+    return tree.findNode(key) ? 1 : 0;
+}
+
+
+/***************************************
+ * lower_bound / upper_bound / equal_range
+ *
+ * Key-ordered positional lookups, as for AVLTree.
+ ***************************************/
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::lower_bound(const K& key) {
+    return iterator(tree.lowerBoundNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::lower_bound(const K& key) const {
+    return const_iterator(tree.lowerBoundNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::iterator AVLMap<K, V, Compare, Allocator, Policy>::upper_bound(const K& key) {
+    return iterator(tree.upperBoundNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator AVLMap<K, V, Compare, Allocator, Policy>::upper_bound(const K& key) const {
+    return const_iterator(tree.upperBoundNode(key), &tree);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::iterator, typename AVLMap<K, V, Compare, Allocator, Policy>::iterator>
+AVLMap<K, V, Compare, Allocator, Policy>::equal_range(const K& key) {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator, typename AVLMap<K, V, Compare, Allocator, Policy>::const_iterator>
+AVLMap<K, V, Compare, Allocator, Policy>::equal_range(const K& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
@@ -0,0 +1,107 @@
+#ifndef AVLMAPPEDTREEHPP
+#define AVLMAPPEDTREEHPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+/***************************************
+ * AVLFileHeader
+ *
+ * The 64-byte header that starts a file written by AVLTree::save().
+ * It is followed by the keys in increasing order as a raw array of T
+ * at keys_offset, and, for multisets, by one std::uint64_t repeat
+ * count per key at repeats_offset. Both offsets are aligned for the
+ * data they point to, so a page-aligned mapping of the file can be
+ * searched in place.
+ *
+ * The sorted array is the balanced layout itself: the subtree for a
+ * range of keys is rooted at its middle key, the same shape
+ * AVLTree::assign() builds, so no child offsets need to be stored.
+ * Integers are in the writer's byte order; byte_order lets a reader
+ * on another machine reject the file.
+ ***************************************/
+struct AVLFileHeader {
+    static constexpr char magic_bytes[8] = {'A', 'V', 'L', 'T', 'R', 'E', 'E', '\0'};
+    static constexpr std::uint32_t byte_order_mark = 0x01020304;
+    static constexpr std::uint32_t current_version = 1;
+    // Set in flags when a repeat-count array follows the keys.
+    static constexpr std::uint32_t has_repeats = 1;
+
+    char magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint32_t key_size;
+    std::uint32_t key_align;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::uint64_t node_count;
+    std::uint64_t key_count;
+    std::uint64_t keys_offset;
+    std::uint64_t repeats_offset;
+
+    static AVLFileHeader describe(std::size_t keySize, std::size_t keyAlign, std::uint64_t nodes,
+                                  std::uint64_t keys, bool repeats);
+    void validate(std::size_t keySize, std::size_t keyAlign) const;
+    std::uint64_t end_offset() const;
+};
+
+static_assert(sizeof(AVLFileHeader) == 64, "AVLFileHeader must stay 64 bytes");
+
+
+/***************************************
+ * AVLMappedTree
+ *
+ * A read-only view of a file written by AVLTree::save(), searched in
+ * place: point it at a memory-mapped (or otherwise loaded) copy of
+ * the file and lookups work immediately, with no parsing and no
+ * allocation. The view does not own the bytes, which must outlive it.
+ *
+ * Each lookup descends the implicit balanced tree over the sorted key
+ * array, i.e. a binary search of O(log n) comparisons. Iterators are
+ * plain pointers into the array.
+ *
+ * For a multiset file, size() counts every copy, as the saved tree's
+ * size() does, while the iterators visit each distinct key once;
+ * distinct_count() is end() - begin().
+ ***************************************/
+template <typename T, typename Compare = std::less<T> >
+class AVLMappedTree {
+    static_assert(std::is_trivially_copyable<T>::value, "AVLMappedTree reads keys as raw bytes");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+private:
+    const T* keys;
+    const std::uint64_t* repeats;
+    std::size_t node_count;
+    std::size_t key_count;
+    Compare comp;
+
+public:
+    AVLMappedTree();
+    AVLMappedTree(const void* data, std::size_t bytes, const Compare& compare = Compare());
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    bool empty() const;
+    std::size_t size() const;
+    std::size_t distinct_count() const;
+
+    const_iterator find(const T& key) const;
+    const_iterator lower_bound(const T& key) const;
+    const_iterator upper_bound(const T& key) const;
+    bool contains(const T& key) const;
+    std::size_t count(const T& key) const;
+};
+
+#include "AVLMappedTreeImplementation.tpp"
+
+#endif
@@ -0,0 +1,305 @@
+#include "AVLMappedTreeHeader.hpp"
+#include <cstring>
+#include <stdexcept>
+
+/***************************************
+ * AVLFileHeader::describe
+ *
+ * Builds the header for a file of nodes keys.
+ *
+ * Parameters:
+ *  - keySize, keyAlign: sizeof and alignof the key type.
+ *  - nodes: Number of distinct keys stored.
+ *  - keys: Number of keys including multiset copies.
+ *  - repeats: Whether a repeat-count array follows the keys.
+ *
+ * Returns:
+ *  - The header, with offsets laid out after it.
+ ***************************************/
+inline AVLFileHeader AVLFileHeader::describe(std::size_t keySize, std::size_t keyAlign, std::uint64_t nodes,
+                                             std::uint64_t keys, bool repeats) {
+    AVLFileHeader header;
+    std::memcpy(header.magic, magic_bytes, sizeof(header.magic));
+    header.byte_order = byte_order_mark;
+    header.version = current_version;
+    header.key_size = static_cast<std::uint32_t>(keySize);
+    header.key_align = static_cast<std::uint32_t>(keyAlign);
+    header.flags = repeats ? has_repeats : 0;
+    header.reserved = 0;
+    header.node_count = nodes;
+    header.key_count = keys;
+    const std::uint64_t align = keyAlign;
+    header.keys_offset = (sizeof(AVLFileHeader) + align - 1) / align * align;
+    const std::uint64_t keysEnd = header.keys_offset + nodes * keySize;
+    const std::uint64_t countAlign = alignof(std::uint64_t);
+    header.repeats_offset = repeats ? (keysEnd + countAlign - 1) / countAlign * countAlign : 0;
+    return header;
+}
+
+
+/***************************************
+ * AVLFileHeader::validate
+ *
+ * Checks that the header describes a file this build can read for a
+ * key type of the given size and alignment.
+ *
+ * Behavior:
+ *  - Throws std::runtime_error naming the first mismatch, including
+ *    offsets that would overflow or overlap the header.
+ ***************************************/
+inline void AVLFileHeader::validate(std::size_t keySize, std::size_t keyAlign) const {
+    if (std::memcmp(magic, magic_bytes, sizeof(magic)) != 0) {
+        throw std::runtime_error("AVLTree file: bad magic");
+    }
+    if (byte_order != byte_order_mark) {
+        throw std::runtime_error("AVLTree file: written with a different byte order");
+    }
+    if (version != current_version) {
+        throw std::runtime_error("AVLTree file: unsupported version");
+    }
+    if (key_size != keySize || key_align != keyAlign) {
+        throw std::runtime_error("AVLTree file: key size or alignment does not match");
+    }
+    if (node_count > (UINT64_MAX - keys_offset) / keySize || keys_offset < sizeof(AVLFileHeader) ||
+        keys_offset % keyAlign != 0 || key_count < node_count) {
+        throw std::runtime_error("AVLTree file: corrupt key layout");
+    }
+    if (flags & has_repeats) {
+        if (repeats_offset < keys_offset + node_count * keySize || repeats_offset % alignof(std::uint64_t) != 0 ||
+            node_count > (UINT64_MAX - repeats_offset) / sizeof(std::uint64_t)) {
+            throw std::runtime_error("AVLTree file: corrupt repeat layout");
+        }
+    }
+    else if (key_count != node_count) {
+        throw std::runtime_error("AVLTree file: corrupt key count");
+    }
+}
+
+
+/***************************************
+ * AVLFileHeader::end_offset
+ *
+ * Returns:
+ *  - The file size the header implies: the end of the last array.
+ *    Only meaningful once validate() has passed.
+ ***************************************/
+inline std::uint64_t AVLFileHeader::end_offset() const {
+    if (flags & has_repeats) {
+        return repeats_offset + node_count * sizeof(std::uint64_t);
+    }
+    return keys_offset + node_count * key_size;
+}
+
+
+/***************************************
+ * AVLMappedTree Constructor
+ *
+ * Initializes an empty view.
+ ***************************************/
+template <typename T, typename Compare>
+AVLMappedTree<T, Compare>::AVLMappedTree()
+    : keys(nullptr), repeats(nullptr), node_count(0), key_count(0), comp(Compare()) {}
+
+
+/***************************************
+ * AVLMappedTree Constructor (file image)
+ *
+ * Attaches to the bytes of a saved tree.
+ *
+ * Parameters:
+ *  - data: Start of the file image; must be aligned for T (any page
+ *    boundary, as returned by mmap, is).
+ *  - bytes: Size of the image.
+ *  - compare: The ordering the tree was saved with.
+ *
+ * Behavior:
+ *  - O(1): only the header is checked. Throws std::runtime_error if
+ *    it does not match T, the image is truncated, or data is
+ *    misaligned. Keys are trusted to be sorted, as save() wrote them.
+ ***************************************/
+template <typename T, typename Compare>
+AVLMappedTree<T, Compare>::AVLMappedTree(const void* data, std::size_t bytes, const Compare& compare)
+    : keys(nullptr), repeats(nullptr), node_count(0), key_count(0), comp(compare) {
+    if (bytes < sizeof(AVLFileHeader)) {
+        throw std::runtime_error("AVLTree file: truncated header");
+    }
+    AVLFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    header.validate(sizeof(T), alignof(T));
+    if (header.end_offset() > bytes) {
+        throw std::runtime_error("AVLTree file: truncated");
+    }
+    const unsigned char* base = static_cast<const unsigned char*>(data);
+    const bool hasRepeats = (header.flags & AVLFileHeader::has_repeats) != 0;
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(base);
+    if (address % alignof(T) != 0 || (hasRepeats && address % alignof(std::uint64_t) != 0)) {
+        throw std::runtime_error("AVLTree file: image is not suitably aligned");
+    }
+    keys = reinterpret_cast<const T*>(base + header.keys_offset);
+    if (hasRepeats) {
+        repeats = reinterpret_cast<const std::uint64_t*>(base + header.repeats_offset);
+    }
+    node_count = static_cast<std::size_t>(header.node_count);
+    key_count = static_cast<std::size_t>(header.key_count);
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - Pointer to the smallest key.
+ ***************************************/
+template <typename T, typename Compare>
+typename AVLMappedTree<T, Compare>::const_iterator AVLMappedTree<T, Compare>::begin() const {
+    return keys;
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - Pointer one past the largest key.
+ ***************************************/
+template <typename T, typename Compare>
+typename AVLMappedTree<T, Compare>::const_iterator AVLMappedTree<T, Compare>::end() const {
+    return keys + node_count;
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the view holds no keys.
+ ***************************************/
+template <typename T, typename Compare>
+bool AVLMappedTree<T, Compare>::empty() const {
+    return node_count == 0;
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys including multiset copies; the saved tree's
+ *    size().
+ ***************************************/
+template <typename T, typename Compare>
+std::size_t AVLMappedTree<T, Compare>::size() const {
+    return key_count;
+}
+
+
+/***************************************
+ * distinct_count
+ *
+ * Returns:
+ *  - The number of distinct keys, i.e. end() - begin().
+ ***************************************/
+template <typename T, typename Compare>
+std::size_t AVLMappedTree<T, Compare>::distinct_count() const {
+    return node_count;
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Finds the first key not less than key.
+ *
+ * Returns:
+ *  - Pointer to that key, or end().
+ *
+ * Behavior:
+ *  - Each step compares against the middle of the remaining range,
+ *    which is the root of the implicit subtree for that range.
+ ***************************************/
+template <typename T, typename Compare>
+typename AVLMappedTree<T, Compare>::const_iterator AVLMappedTree<T, Compare>::lower_bound(const T& key) const {
+    const T* first = keys;
+    std::size_t n = node_count;
+    while (n > 0) {
+        const std::size_t half = n / 2;
+        if (comp(first[half], key)) {
+            first += half + 1;
+            n -= half + 1;
+        }
+        else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+
+/***************************************
+ * upper_bound
+ *
+ * Finds the first key greater than key.
+ *
+ * Returns:
+ *  - Pointer to that key, or end().
+ ***************************************/
+template <typename T, typename Compare>
+typename AVLMappedTree<T, Compare>::const_iterator AVLMappedTree<T, Compare>::upper_bound(const T& key) const {
+    const T* first = keys;
+    std::size_t n = node_count;
+    while (n > 0) {
+        const std::size_t half = n / 2;
+        if (!comp(key, first[half])) {
+            first += half + 1;
+            n -= half + 1;
+        }
+        else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+
+/***************************************
+ * find
+ *
+ * Searches for a key.
+ *
+ * Returns:
+ *  - Pointer to the key equivalent to key, or end().
+ ***************************************/
+template <typename T, typename Compare>
+typename AVLMappedTree<T, Compare>::const_iterator AVLMappedTree<T, Compare>::find(const T& key) const {
+    const_iterator it = lower_bound(key);
+    return it != end() && !comp(key, *it) ? it : end();
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare>
+bool AVLMappedTree<T, Compare>::contains(const T& key) const {
+    return find(key) != end();
+}
+
+
+/***************************************
+ * count
+ *
+ * Returns:
+ *  - The number of copies of key: its repeat count for a saved
+ *    multiset, else 0 or 1.
+ ***************************************/
+template <typename T, typename Compare>
+std::size_t AVLMappedTree<T, Compare>::count(const T& key) const {
+    const_iterator it = find(key);
+    if (it == end()) {
+        return 0;
+    }
+    return repeats ? static_cast<std::size_t>(repeats[it - keys]) : 1;
+}
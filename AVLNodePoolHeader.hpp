@@ -0,0 +1,139 @@
+#ifndef AVLNODEPOOLHPP
+#define AVLNODEPOOLHPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/***************************************
+ * AVLArena
+ *
+ * A slab arena that carves fixed-size slots out of large
+ * contiguous blocks and recycles freed slots through per-size
+ * free lists. Blocks are only returned to the system by release()
+ * or when the arena itself is destroyed.
+ ***************************************/
+class AVLArena {
+public:
+    explicit AVLArena(std::size_t block_bytes = 64 * 1024);
+    ~AVLArena();
+
+    AVLArena(const AVLArena&) = delete;
+    AVLArena& operator=(const AVLArena&) = delete;
+
+    void* allocate(std::size_t slot_size, std::size_t alignment, std::size_t count);
+    void deallocate(void* p, std::size_t slot_size, std::size_t alignment, std::size_t count);
+    void release();
+    std::size_t block_count() const;
+
+private:
+    struct Block {
+        Block* next;
+    };
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    struct FreeList {
+        std::size_t slot_size;
+        FreeSlot* head;
+    };
+
+    static std::size_t roundSlot(std::size_t slot_size, std::size_t alignment);
+    FreeList& freeListFor(std::size_t slot_size);
+    void* carve(std::size_t bytes, std::size_t alignment);
+
+    std::size_t block_bytes;
+    Block* blocks;
+    std::size_t blocks_held;
+    char* cursor;
+    char* limit;
+    std::vector<FreeList> free_lists;
+};
+
+
+/***************************************
+ * AVLPoolAllocator
+ *
+ * std::allocator-compatible front end for AVLArena. Copies and
+ * rebinds share the same arena, so a tree's node allocator and the
+ * allocator it was built from always compare equal.
+ ***************************************/
+template <typename T, std::size_t BlockBytes = 64 * 1024>
+class AVLPoolAllocator {
+    template <typename U, std::size_t B> friend class AVLPoolAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AVLPoolAllocator<U, BlockBytes>;
+    };
+
+    AVLPoolAllocator() : arena(std::make_shared<AVLArena>(BlockBytes)) {}
+
+    template <typename U>
+    AVLPoolAllocator(const AVLPoolAllocator<U, BlockBytes>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena->allocate(sizeof(T), alignof(T), n));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        arena->deallocate(p, sizeof(T), alignof(T), n);
+    }
+
+    // A copied container gets its own arena rather than sharing ours.
+    AVLPoolAllocator select_on_container_copy_construction() const {
+        return AVLPoolAllocator();
+    }
+
+    // True when no other allocator shares this arena, so its blocks
+    // may be released wholesale.
+    bool exclusive() const {
+        return arena.use_count() == 1;
+    }
+
+    void release() {
+        arena->release();
+    }
+
+    std::size_t block_count() const {
+        return arena->block_count();
+    }
+
+    template <typename U>
+    bool operator==(const AVLPoolAllocator<U, BlockBytes>& other) const {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const AVLPoolAllocator<U, BlockBytes>& other) const {
+        return arena != other.arena;
+    }
+
+private:
+    std::shared_ptr<AVLArena> arena;
+};
+
+
+/***************************************
+ * AVLIsPoolAllocator
+ *
+ * Trait that lets AVLTree detect arena-backed allocators.
+ ***************************************/
+template <typename A>
+struct AVLIsPoolAllocator : std::false_type {};
+
+template <typename T, std::size_t BlockBytes>
+struct AVLIsPoolAllocator<AVLPoolAllocator<T, BlockBytes> > : std::true_type {};
+
+#include "AVLNodePoolImplementation.tpp"
+
+#endif
@@ -0,0 +1,217 @@
+#include "AVLNodePoolHeader.hpp"
+#include <cstdint>
+
+/***************************************
+ * AVLArena Constructor
+ *
+ * Creates an empty arena.
+ *
+ * Parameters:
+ *  - block_bytes: Size of each block carved from the system allocator.
+ *
+ * Behavior:
+ *  - No memory is reserved until the first allocation.
+ ***************************************/
+inline AVLArena::AVLArena(std::size_t block_bytes)
+    : block_bytes(block_bytes), blocks(nullptr), blocks_held(0), cursor(nullptr), limit(nullptr) {}
+
+
+/***************************************
+ * AVLArena Destructor
+ *
+ * Returns every block to the system allocator.
+ ***************************************/
+inline AVLArena::~AVLArena() {
+    release();
+}
+
+
+/***************************************
+ * roundSlot (private helper)
+ *
+ * Computes the stride used for slots of a given size.
+ *
+ * Parameters:
+ *  - slot_size: The requested object size.
+ *  - alignment: The requested object alignment.
+ *
+ * Returns:
+ *  - A stride large enough to hold a free-list link and a multiple of
+ *    the alignment, so consecutive slots stay aligned.
+ ***************************************/
+inline std::size_t AVLArena::roundSlot(std::size_t slot_size, std::size_t alignment) {
+    if (alignment < alignof(FreeSlot)) {
+        alignment = alignof(FreeSlot);
+    }
+    if (slot_size < sizeof(FreeSlot)) {
+        slot_size = sizeof(FreeSlot);
+    }
+    return (slot_size + alignment - 1) / alignment * alignment;
+}
+
+
+/***************************************
+ * freeListFor (private helper)
+ *
+ * Finds (or creates) the free list holding slots of a given stride.
+ *
+ * Parameters:
+ *  - slot_size: The rounded slot stride.
+ *
+ * Returns:
+ *  - A reference to the matching free list.
+ ***************************************/
+inline AVLArena::FreeList& AVLArena::freeListFor(std::size_t slot_size) {
+    for (FreeList& list : free_lists) {
+        if (list.slot_size == slot_size) {
+            return list;
+        }
+    }
+    free_lists.push_back(FreeList{slot_size, nullptr});
+    return free_lists.back();
+}
+
+
+/***************************************
+ * carve (private helper)
+ *
+ * Bump-allocates raw storage from the current block.
+ *
+ * Parameters:
+ *  - bytes: Number of bytes required.
+ *  - alignment: Required alignment of the returned address.
+ *
+ * Returns:
+ *  - Pointer to the carved storage.
+ *
+ * Behavior:
+ *  - Opens a new block when the current one is exhausted.
+ *  - Requests larger than a block get a dedicated block so the
+ *    remainder of the current block is not wasted.
+ ***************************************/
+inline void* AVLArena::carve(std::size_t bytes, std::size_t alignment) {
+    std::uintptr_t at = reinterpret_cast<std::uintptr_t>(cursor);
+    std::uintptr_t aligned = (at + alignment - 1) / alignment * alignment;
+    if (cursor && aligned + bytes <= reinterpret_cast<std::uintptr_t>(limit)) {
+        cursor = reinterpret_cast<char*>(aligned + bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    const std::size_t header = roundSlot(sizeof(Block), alignof(std::max_align_t));
+    const std::size_t needed = header + bytes + alignment;
+    const bool dedicated = needed > block_bytes;
+    const std::size_t size = dedicated ? needed : block_bytes;
+
+    char* raw = static_cast<char*>(::operator new(size));
+    Block* block = reinterpret_cast<Block*>(raw);
+    block->next = blocks;
+    blocks = block;
+    ++blocks_held;
+
+    at = reinterpret_cast<std::uintptr_t>(raw + header);
+    aligned = (at + alignment - 1) / alignment * alignment;
+    if (!dedicated) {
+        cursor = reinterpret_cast<char*>(aligned + bytes);
+        limit = raw + size;
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+
+/***************************************
+ * allocate
+ *
+ * Allocates storage for count objects of the given size.
+ *
+ * Parameters:
+ *  - slot_size: sizeof the object type.
+ *  - alignment: alignof the object type.
+ *  - count: Number of contiguous objects.
+ *
+ * Returns:
+ *  - Pointer to uninitialized storage.
+ *
+ * Behavior:
+ *  - Single-object requests are served from the free list first.
+ *  - Everything else is carved from the current block.
+ ***************************************/
+inline void* AVLArena::allocate(std::size_t slot_size, std::size_t alignment, std::size_t count) {
+    const std::size_t slot = roundSlot(slot_size, alignment);
+    FreeList& list = freeListFor(slot);
+    if (count == 1) {
+        if (list.head) {
+            FreeSlot* s = list.head;
+            list.head = s->next;
+            return s;
+        }
+    }
+    if (alignment < alignof(FreeSlot)) {
+        alignment = alignof(FreeSlot);
+    }
+    return carve(slot * count, alignment);
+}
+
+
+/***************************************
+ * deallocate
+ *
+ * Returns storage to the arena.
+ *
+ * Parameters:
+ *  - p: Storage previously obtained from allocate().
+ *  - slot_size: sizeof the object type.
+ *  - alignment: alignof the object type.
+ *  - count: Number of objects the storage holds.
+ *
+ * Behavior:
+ *  - Every slot is pushed onto the free list, so runs obtained by a
+ *    bulk allocation may be handed back one slot at a time.
+ ***************************************/
+inline void AVLArena::deallocate(void* p, std::size_t slot_size, std::size_t alignment, std::size_t count) {
+    if (!p) {
+        return;
+    }
+    const std::size_t slot = roundSlot(slot_size, alignment);
+    FreeList& list = freeListFor(slot);
+    char* base = static_cast<char*>(p);
+    for (std::size_t i = 0; i < count; ++i) {
+        FreeSlot* s = reinterpret_cast<FreeSlot*>(base + i * slot);
+        s->next = list.head;
+        list.head = s;
+    }
+}
+
+
+/***************************************
+ * release
+ *
+ * Frees every block owned by the arena in O(blocks).
+ *
+ * Behavior:
+ *  - All outstanding allocations become invalid.
+ *  - Free lists are emptied; the arena can be reused afterwards.
+ ***************************************/
+inline void AVLArena::release() {
+    while (blocks) {
+        Block* next = blocks->next;
+        ::operator delete(static_cast<void*>(blocks));
+        blocks = next;
+    }
+    blocks_held = 0;
+    cursor = nullptr;
+    limit = nullptr;
+    for (FreeList& list : free_lists) {
+        list.head = nullptr;
+    }
+}
+
+
+/***************************************
+ * block_count
+ *
+ * Returns:
+ *  - The number of blocks currently held by the arena.
+ ***************************************/
+inline std::size_t AVLArena::block_count() const {
+    return blocks_held;
+}
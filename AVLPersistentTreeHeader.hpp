@@ -0,0 +1,161 @@
+#ifndef AVLPERSISTENTTREEHPP
+#define AVLPERSISTENTTREEHPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+/***************************************
+ * AVLPersistentTree
+ *
+ * A parent-pointer-free AVL set whose nodes are shared between trees
+ * through reference counts. snapshot() (and the copy constructor)
+ * run in O(1): the copy shares the root. insert and erase copy only
+ * the nodes on the path they rebalance when those nodes are shared,
+ * and update nodes in place when this tree is their only owner, so a
+ * tree without live snapshots costs no copies.
+ *
+ * Each tree object is used by one thread at a time. Different trees
+ * sharing nodes may be read, modified and destroyed on different
+ * threads concurrently; the allocator must then be thread-safe too
+ * (std::allocator is; AVLPoolAllocator is not).
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class AVLPersistentTree {
+private:
+    struct Node {
+        Node* left;
+        Node* right;
+        // Number of links (child pointers and tree roots) to this node.
+        std::atomic<std::size_t> refs;
+        T key;
+        std::int8_t height;
+
+        template <typename... Args>
+        explicit Node(Args&&... args)
+            : left(nullptr), right(nullptr), refs(1), key(std::forward<Args>(args)...), height(1) {}
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+public:
+    // Same bound as AVLCompactTree: an AVL tree of height 64 holds more
+    // than 2.7e13 nodes.
+    static constexpr std::size_t max_depth = 64;
+
+private:
+    Node* root;
+    std::size_t tree_size;
+    Compare comp;
+    NodeAllocator node_alloc;
+
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+    void destroyNode(Node* node);
+    static void retain(Node* node);
+    void release(Node* node);
+    Node* unshare(Node*& link);
+    static int height(const Node* node);
+    static int getBalanceFactor(const Node* node);
+    static void updateHeight(Node* node);
+    static Node* rightRotate(Node* y);
+    static Node* leftRotate(Node* x);
+    Node* rebalance(Node* node);
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    class const_iterator {
+        friend class AVLPersistentTree;
+    private:
+        const Node* path[max_depth];
+        std::size_t depth;
+        const AVLPersistentTree* tree;
+
+        void pushLeftSpine(const Node* node);
+        void pushRightSpine(const Node* node);
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : depth(0), tree(nullptr) {}
+        explicit const_iterator(const AVLPersistentTree* t) : depth(0), tree(t) {}
+
+        reference operator*() const {
+            return path[depth - 1]->key;
+        }
+        pointer operator->() const {
+            return &(path[depth - 1]->key);
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+
+        bool operator==(const const_iterator& other) const {
+            return (depth ? path[depth - 1] : nullptr) == (other.depth ? other.path[other.depth - 1] : nullptr);
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // Keys are immutable once stored, so both names refer to one type.
+    using iterator = const_iterator;
+
+    AVLPersistentTree();
+    explicit AVLPersistentTree(const Compare& compare, const Allocator& alloc = Allocator());
+    AVLPersistentTree(const AVLPersistentTree& other);
+    AVLPersistentTree(AVLPersistentTree&& other) noexcept;
+    ~AVLPersistentTree();
+
+    AVLPersistentTree& operator=(const AVLPersistentTree& other);
+    AVLPersistentTree& operator=(AVLPersistentTree&& other) noexcept;
+    void swap(AVLPersistentTree& other) noexcept;
+
+    AVLPersistentTree snapshot() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    std::size_t size() const;
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    std::pair<iterator, bool> insert(const T& key);
+    std::pair<iterator, bool> insert(T&& key);
+    std::size_t erase(const T& key);
+    void clear();
+    const_iterator find(const T& key) const;
+    const_iterator lower_bound(const T& key) const;
+    bool contains(const T& key) const;
+
+private:
+    template <typename Make>
+    std::pair<iterator, bool> insertWith(const T& key, Make&& make);
+};
+
+template <typename T, typename Compare, typename Allocator>
+void swap(AVLPersistentTree<T, Compare, Allocator>& a, AVLPersistentTree<T, Compare, Allocator>& b) noexcept {
+    a.swap(b);
+}
+
+#include "AVLPersistentTreeImplementation.tpp"
+
+#endif
@@ -0,0 +1,815 @@
+#include "AVLPersistentTreeHeader.hpp"
+
+/***************************************
+ * AVLPersistentTree Constructor
+ *
+ * Initializes an empty persistent AVL tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>::AVLPersistentTree()
+    : root(nullptr), tree_size(0), comp(Compare()), node_alloc(Allocator()) {}
+
+
+/***************************************
+ * AVLPersistentTree Constructor (comparator and allocator)
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>::AVLPersistentTree(const Compare& compare, const Allocator& alloc)
+    : root(nullptr), tree_size(0), comp(compare), node_alloc(alloc) {}
+
+
+/***************************************
+ * AVLPersistentTree Copy Constructor
+ *
+ * Shares the other tree's nodes in O(1).
+ *
+ * Behavior:
+ *  - The allocator is copied rather than passed through
+ *    select_on_container_copy_construction: shared nodes may be freed
+ *    by either tree, so both must use the same allocator.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>::AVLPersistentTree(const AVLPersistentTree& other)
+    : root(other.root), tree_size(other.tree_size), comp(other.comp), node_alloc(other.node_alloc) {
+    retain(root);
+}
+
+
+/***************************************
+ * AVLPersistentTree Move Constructor
+ *
+ * Takes over another tree's nodes in O(1), leaving it empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>::AVLPersistentTree(AVLPersistentTree&& other) noexcept
+    : root(other.root), tree_size(other.tree_size), comp(other.comp), node_alloc(other.node_alloc) {
+    other.root = nullptr;
+    other.tree_size = 0;
+}
+
+
+/***************************************
+ * AVLPersistentTree Destructor
+ *
+ * Drops this tree's reference; nodes still shared with other trees
+ * survive.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>::~AVLPersistentTree() {
+    clear();
+}
+
+
+/***************************************
+ * operator= (copy assignment)
+ *
+ * Replaces the contents with a view sharing other's nodes, in O(1)
+ * plus releasing the old contents.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>& AVLPersistentTree<T, Compare, Allocator>::operator=(const AVLPersistentTree& other) {
+    if (this != &other) {
+        AVLPersistentTree copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+
+/***************************************
+ * operator= (move assignment)
+ *
+ * Swaps contents with other; other's old nodes are released when it
+ * is destroyed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator>& AVLPersistentTree<T, Compare, Allocator>::operator=(AVLPersistentTree&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+
+/***************************************
+ * swap
+ *
+ * Exchanges the contents of two trees in O(1).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::swap(AVLPersistentTree& other) noexcept {
+    using std::swap;
+    swap(root, other.root);
+    swap(tree_size, other.tree_size);
+    swap(comp, other.comp);
+    swap(node_alloc, other.node_alloc);
+}
+
+
+/***************************************
+ * snapshot
+ *
+ * Returns:
+ *  - A tree holding the current contents, in O(1). Later changes to
+ *    either tree are not visible in the other, and the snapshot may be
+ *    handed to another thread.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+AVLPersistentTree<T, Compare, Allocator> AVLPersistentTree<T, Compare, Allocator>::snapshot() const {
+    return AVLPersistentTree(*this);
+}
+
+
+/***************************************
+ * createNode (private helper)
+ *
+ * Allocates and constructs a single node with a reference count of 1.
+ *
+ * Parameters:
+ *  - args: Arguments forwarded to the key's constructor.
+ *
+ * Returns:
+ *  - Pointer to the new leaf node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+typename AVLPersistentTree<T, Compare, Allocator>::Node* AVLPersistentTree<T, Compare, Allocator>::createNode(Args&&... args) {
+    Node* node = NodeAllocTraits::allocate(node_alloc, 1);
+    try {
+        NodeAllocTraits::construct(node_alloc, node, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        NodeAllocTraits::deallocate(node_alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+
+/***************************************
+ * destroyNode (private helper)
+ *
+ * Destroys a single node and returns its storage.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::destroyNode(Node* node) {
+    NodeAllocTraits::destroy(node_alloc, node);
+    NodeAllocTraits::deallocate(node_alloc, node, 1);
+}
+
+
+/***************************************
+ * retain (private helper)
+ *
+ * Adds a link to a node (nullptr is ignored).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::retain(Node* node) {
+    if (node) {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+/***************************************
+ * release (private helper)
+ *
+ * Drops a link to a node, freeing it and releasing its children once
+ * no link is left.
+ *
+ * Behavior:
+ *  - The decrement is acquire-release, as for std::shared_ptr, so the
+ *    thread that frees a node sees every write made to it by the
+ *    threads that dropped earlier links.
+ *  - Recursion only follows nodes that are freed, and is bounded by
+ *    the tree height.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::release(Node* node) {
+    while (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Node* left = node->left;
+        Node* right = node->right;
+        destroyNode(node);
+        release(left);
+        node = right;
+    }
+}
+
+
+/***************************************
+ * unshare (private helper)
+ *
+ * Makes the node behind a link owned by this tree alone.
+ *
+ * Parameters:
+ *  - link: A link inside this tree's uniquely owned part (the root, or
+ *    a child pointer of an unshared node).
+ *
+ * Returns:
+ *  - The node now stored in link, which may be modified in place.
+ *
+ * Behavior:
+ *  - A node with a single reference is returned as is: that reference
+ *    is link itself, so no other tree can reach the node.
+ *  - Otherwise the node is copied (key, height and child links, whose
+ *    counts go up by one) and link is redirected to the copy. If the
+ *    key copy throws, the tree is unchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::Node* AVLPersistentTree<T, Compare, Allocator>::unshare(Node*& link) {
+    Node* node = link;
+    if (node->refs.load(std::memory_order_acquire) == 1) {
+        return node;
+    }
+    Node* copy = createNode(node->key);
+    copy->left = node->left;
+    copy->right = node->right;
+    copy->height = node->height;
+    retain(copy->left);
+    retain(copy->right);
+    link = copy;
+    release(node);
+    return copy;
+}
+
+
+/***************************************
+ * height (private helper)
+ *
+ * Returns:
+ *  - The node's height, or 0 if the node is nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLPersistentTree<T, Compare, Allocator>::height(const Node* node) {
+    return node ? node->height : 0;
+}
+
+
+/***************************************
+ * getBalanceFactor (private helper)
+ *
+ * Returns:
+ *  - Height of the left subtree minus height of the right subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+int AVLPersistentTree<T, Compare, Allocator>::getBalanceFactor(const Node* node) {
+    return node ? height(node->left) - height(node->right) : 0;
+}
+
+
+/***************************************
+ * updateHeight (private helper)
+ *
+ * Recomputes a node's height from its children.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::updateHeight(Node* node) {
+    node->height = static_cast<std::int8_t>(1 + std::max(height(node->left), height(node->right)));
+}
+
+
+/***************************************
+ * rightRotate (private helper)
+ *
+ * Performs a right rotation on the subtree rooted at y; y and its left
+ * child must be unshared.
+ *
+ * Returns:
+ *  - The new subtree root; the caller stores it in the parent link.
+ *
+ * Behavior:
+ *  - Links are moved, not duplicated, so no count changes.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::Node* AVLPersistentTree<T, Compare, Allocator>::rightRotate(Node* y) {
+    Node* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    updateHeight(y);
+    updateHeight(x);
+    return x;
+}
+
+
+/***************************************
+ * leftRotate (private helper)
+ *
+ * Performs a left rotation on the subtree rooted at x; x and its right
+ * child must be unshared.
+ *
+ * Returns:
+ *  - The new subtree root; the caller stores it in the parent link.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::Node* AVLPersistentTree<T, Compare, Allocator>::leftRotate(Node* x) {
+    Node* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    updateHeight(x);
+    updateHeight(y);
+    return y;
+}
+
+
+/***************************************
+ * rebalance (private helper)
+ *
+ * Restores the AVL property at an unshared node whose balance factor
+ * is +-2.
+ *
+ * Returns:
+ *  - The new subtree root; the caller stores it in the parent link.
+ *
+ * Behavior:
+ *  - Unshares the one or two nodes below it that the rotation moves.
+ *    After an erase these can lie off the search path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::Node* AVLPersistentTree<T, Compare, Allocator>::rebalance(Node* node) {
+    if (getBalanceFactor(node) > 1) {
+        Node* left = unshare(node->left);
+        if (getBalanceFactor(left) < 0) {
+            unshare(left->right);
+            node->left = leftRotate(left);
+        }
+        return rightRotate(node);
+    }
+    Node* right = unshare(node->right);
+    if (getBalanceFactor(right) > 0) {
+        unshare(right->left);
+        node->right = rightRotate(right);
+    }
+    return leftRotate(node);
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the tree has no nodes; otherwise false.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLPersistentTree<T, Compare, Allocator>::empty() const {
+    return tree_size == 0;
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys in the tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLPersistentTree<T, Compare, Allocator>::size() const {
+    return tree_size;
+}
+
+
+/***************************************
+ * insertWith (private helper)
+ *
+ * Inserts a node for key unless an equivalent key is present.
+ *
+ * Parameters:
+ *  - key: The key used for the descent.
+ *  - make: Callable returning the node to link; only invoked once the
+ *    slot is known to be free.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - A read-only search runs first, so a duplicate copies nothing.
+ *  - The second descent unshares each node it passes and records the
+ *    link to it. The retrace then walks back up with AVLCompactTree's
+ *    loop, stopping after the first rotation or unchanged height.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename Make>
+std::pair<typename AVLPersistentTree<T, Compare, Allocator>::iterator, bool> AVLPersistentTree<T, Compare, Allocator>::insertWith(const T& key, Make&& make) {
+    const_iterator existing = find(key);
+    if (existing != end()) {
+        return std::make_pair(existing, false);
+    }
+
+    Node** links[max_depth + 1];
+    std::size_t depth = 0;
+    Node** link = &root;
+    while (*link) {
+        links[depth++] = link;
+        Node* current = unshare(*link);
+        link = comp(key, current->key) ? &current->left : &current->right;
+    }
+    Node* node = make();
+    *link = node;
+    ++tree_size;
+
+    while (depth > 0) {
+        Node*& current = *links[--depth];
+        int oldHeight = current->height;
+        updateHeight(current);
+        int balance = getBalanceFactor(current);
+        if (balance > 1 || balance < -1) {
+            current = rebalance(current);
+            break;
+        }
+        if (current->height == oldHeight) {
+            break;
+        }
+    }
+    return std::make_pair(find(node->key), true);
+}
+
+
+/***************************************
+ * emplace
+ *
+ * Constructs a key in a new node and inserts it.
+ *
+ * Parameters:
+ *  - args: Arguments forwarded to T's constructor.
+ *
+ * Returns:
+ *  - An iterator to the key and whether it was inserted.
+ *
+ * Behavior:
+ *  - The node is built first because its key drives the descent; it
+ *    is freed again if an equivalent key is found.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename AVLPersistentTree<T, Compare, Allocator>::iterator, bool> AVLPersistentTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    Node* node = createNode(std::forward<Args>(args)...);
+    std::pair<iterator, bool> result;
+    try {
+        result = insertWith(node->key, [node]() { return node; });
+    }
+    catch (...) {
+        destroyNode(node);
+        throw;
+    }
+    if (!result.second) {
+        destroyNode(node);
+    }
+    return result;
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a copy of key unless an equivalent key is present.
+ *
+ * Returns:
+ *  - Same as emplace().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLPersistentTree<T, Compare, Allocator>::iterator, bool> AVLPersistentTree<T, Compare, Allocator>::insert(const T& key) {
+    return insertWith(key, [this, &key]() { return createNode(key); });
+}
+
+
+/***************************************
+ * insert (move)
+ *
+ * Inserts key by moving it into a new node; key is left untouched if
+ * an equivalent key is present.
+ *
+ * Returns:
+ *  - Same as emplace().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename AVLPersistentTree<T, Compare, Allocator>::iterator, bool> AVLPersistentTree<T, Compare, Allocator>::insert(T&& key) {
+    return insertWith(key, [this, &key]() { return createNode(std::move(key)); });
+}
+
+
+/***************************************
+ * erase
+ *
+ * Removes the key equivalent to key, if any.
+ *
+ * Returns:
+ *  - The number of keys removed (0 or 1).
+ *
+ * Behavior:
+ *  - A missing key copies nothing. Otherwise the path to the key (and
+ *    on to its successor) is unshared and the erase proceeds as in
+ *    AVLCompactTree, relinking the successor into the key's place.
+ *  - Nodes still shared with a snapshot are copied rather than
+ *    modified, so the snapshot keeps the key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+std::size_t AVLPersistentTree<T, Compare, Allocator>::erase(const T& key) {
+    if (!contains(key)) {
+        return 0;
+    }
+
+    Node** links[max_depth + 1];
+    std::size_t depth = 0;
+    Node** link = &root;
+    Node* target = unshare(*link);
+    while (true) {
+        if (comp(key, target->key)) {
+            links[depth++] = link;
+            link = &target->left;
+        }
+        else if (comp(target->key, key)) {
+            links[depth++] = link;
+            link = &target->right;
+        }
+        else {
+            break;
+        }
+        target = unshare(*link);
+    }
+
+    if (!target->left || !target->right) {
+        *link = target->left ? target->left : target->right;
+    }
+    else {
+        // Unshare the path down to the successor, unlink it, then let it
+        // take target's place. The link into target's right subtree
+        // moves with it.
+        const std::size_t targetDepth = depth;
+        links[depth++] = link;
+        Node** successorLink = &target->right;
+        Node* successor = unshare(*successorLink);
+        while (successor->left) {
+            links[depth++] = successorLink;
+            successorLink = &successor->left;
+            successor = unshare(*successorLink);
+        }
+        *successorLink = successor->right;
+
+        successor->left = target->left;
+        successor->right = target->right;
+        successor->height = target->height;
+        *link = successor;
+        if (depth > targetDepth + 1) {
+            links[targetDepth + 1] = &successor->right;
+        }
+    }
+    // target's children were moved out, so it is freed on its own.
+    destroyNode(target);
+    --tree_size;
+
+    while (depth > 0) {
+        Node*& current = *links[--depth];
+        int oldHeight = current->height;
+        updateHeight(current);
+        int balance = getBalanceFactor(current);
+        if (balance > 1 || balance < -1) {
+            current = rebalance(current);
+        }
+        if (current->height == oldHeight) {
+            break;
+        }
+    }
+    return 1;
+}
+
+
+/***************************************
+ * clear
+ *
+ * Drops every key from this tree; nodes still shared with other trees
+ * survive.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::clear() {
+    release(root);
+    root = nullptr;
+    tree_size = 0;
+}
+
+
+/***************************************
+ * find
+ *
+ * Searches for a key.
+ *
+ * Returns:
+ *  - An iterator holding the path to the key, or end() if absent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::find(const T& key) const {
+    const_iterator it(this);
+    const Node* current = root;
+    while (current) {
+        it.path[it.depth++] = current;
+        if (comp(key, current->key)) {
+            current = current->left;
+        }
+        else if (comp(current->key, key)) {
+            current = current->right;
+        }
+        else {
+            return it;
+        }
+    }
+    return end();
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Finds the first key not less than key.
+ *
+ * Returns:
+ *  - An iterator to that key, or end().
+ *
+ * Behavior:
+ *  - The answer is the last node where the search turned left, so its
+ *    path is a prefix of the search path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::lower_bound(const T& key) const {
+    const_iterator it(this);
+    std::size_t candidateDepth = 0;
+    const Node* current = root;
+    while (current) {
+        it.path[it.depth++] = current;
+        if (!comp(current->key, key)) {
+            candidateDepth = it.depth;
+            current = current->left;
+        }
+        else {
+            current = current->right;
+        }
+    }
+    it.depth = candidateDepth;
+    return it;
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+bool AVLPersistentTree<T, Compare, Allocator>::contains(const T& key) const {
+    const Node* current = root;
+    while (current) {
+        if (comp(key, current->key)) {
+            current = current->left;
+        }
+        else if (comp(current->key, key)) {
+            current = current->right;
+        }
+        else {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::begin() const {
+    const_iterator it(this);
+    it.pushLeftSpine(root);
+    return it;
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - An iterator with an empty path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::end() const {
+    return const_iterator(this);
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * const_iterator::pushLeftSpine (Helper)
+ *
+ * Extends the path from node down to the minimum of its subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::const_iterator::pushLeftSpine(const Node* node) {
+    while (node) {
+        path[depth++] = node;
+        node = node->left;
+    }
+}
+
+
+/***************************************
+ * const_iterator::pushRightSpine (Helper)
+ *
+ * Extends the path from node down to the maximum of its subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+void AVLPersistentTree<T, Compare, Allocator>::const_iterator::pushRightSpine(const Node* node) {
+    while (node) {
+        path[depth++] = node;
+        node = node->right;
+    }
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Advances to the in-order successor using the stored path.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator& AVLPersistentTree<T, Compare, Allocator>::const_iterator::operator++() {
+    if (depth == 0) {
+        return *this;
+    }
+    const Node* node = path[depth - 1];
+    if (node->right) {
+        pushLeftSpine(node->right);
+        return *this;
+    }
+    // Climb while we are coming back from a right child.
+    --depth;
+    while (depth && path[depth - 1]->right == node) {
+        node = path[--depth];
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Pre-decrement)
+ *
+ * Moves to the in-order predecessor; from end() it moves to the
+ * largest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator& AVLPersistentTree<T, Compare, Allocator>::const_iterator::operator--() {
+    if (depth == 0) {
+        pushRightSpine(tree->root);
+        return *this;
+    }
+    const Node* node = path[depth - 1];
+    if (node->left) {
+        pushRightSpine(node->left);
+        return *this;
+    }
+    --depth;
+    while (depth && path[depth - 1]->left == node) {
+        node = path[--depth];
+    }
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Post-decrement)
+ ***************************************/
+template <typename T, typename Compare, typename Allocator>
+typename AVLPersistentTree<T, Compare, Allocator>::const_iterator AVLPersistentTree<T, Compare, Allocator>::const_iterator::operator--(int) {
+    const_iterator temp = *this;
+    --(*this);
+    return temp;
+}
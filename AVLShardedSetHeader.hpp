@@ -0,0 +1,162 @@
+#ifndef AVLSHARDEDSETHPP
+#define AVLSHARDEDSETHPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "AVLConcurrentTreeHeader.hpp"
+#include "AVLTreeHeader.hpp"
+
+/***************************************
+ * AVLShardedSet
+ *
+ * A thread-safe set that range-partitions its keys over up to Shards
+ * independent AVLTrees, each behind its own reader-writer lock in its
+ * own cache-line-aligned slot. Writers to different key ranges run in
+ * parallel, and readers of one shard share its lock.
+ *
+ *  - A routing table of shard lower bounds is published through an
+ *    atomic pointer. An operation pins an AVLEpoch, looks its key up
+ *    in the table, locks that shard and checks that the table is
+ *    still current, retrying otherwise. Routing touches no shared
+ *    writable cache line.
+ *  - The set starts as one shard. A shard that grows past its limit
+ *    is split at its median (split() on an order-statistics tree,
+ *    O(log n)) into a fresh slot. Once every slot is in use, the
+ *    adjacent pair with the fewest keys is first joined to free one.
+ *    A rebalance locks every shard, publishes a new table and frees
+ *    the old one once no reader can still hold it.
+ *  - for_each() visits the keys in order while others write;
+ *    begin()/end() iterate across shards in order when no thread is
+ *    modifying the set.
+ *
+ * The allocator must be safe to call from several threads at once
+ * (std::allocator is; AVLPoolAllocator is not).
+ ***************************************/
+template <typename T, typename Compare = std::less<T>, std::size_t Shards = 16,
+          typename Allocator = std::allocator<T> >
+class AVLShardedSet {
+    static_assert(Shards >= 1, "AVLShardedSet needs at least one shard");
+
+public:
+    using Tree = AVLTree<T, Compare, Allocator, AVLOrderStatisticsPolicy>;
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex lock;
+        Tree tree;
+        // Size past which an insert asks for a rebalance; guarded by lock.
+        std::size_t split_at;
+    };
+
+    // bounds[k - 1] is the smallest key shard k may hold; shard 0 takes
+    // everything below bounds[0]. Immutable once published.
+    struct Layout {
+        std::size_t active;
+        std::vector<T> bounds;
+    };
+
+    using ReadLock = std::shared_lock<std::shared_mutex>;
+    using WriteLock = std::unique_lock<std::shared_mutex>;
+
+    // A shard is never split below this many keys.
+    static constexpr std::size_t split_min = 4096;
+
+    Shard shards[Shards];
+    std::atomic<const Layout*> layout;
+    Compare comp;
+    mutable AVLEpoch epoch;
+    std::mutex rebalance_mutex;
+
+    std::size_t route(const Layout& current, const T& key) const;
+    template <typename Lock>
+    std::size_t lockShard(const T& key, Lock& hold) const;
+    const Layout* lockFirst(ReadLock& hold) const;
+    void rebalance();
+    void openSlot(std::size_t index, std::size_t& active, std::vector<T>& bounds);
+    void closeSlot(std::size_t index, std::size_t& active, std::vector<T>& bounds);
+    std::size_t splitLimit(std::size_t active, std::size_t total, std::size_t shardSize) const;
+    template <typename K>
+    bool insertKey(K&& key);
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    class const_iterator {
+        friend class AVLShardedSet;
+    private:
+        const AVLShardedSet* set;
+        std::size_t shard;
+        typename Tree::const_iterator it;
+
+        const_iterator(const AVLShardedSet* s, std::size_t index, typename Tree::const_iterator i)
+            : set(s), shard(index), it(i) {}
+        void skipEmpty();
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : set(nullptr), shard(0), it() {}
+
+        reference operator*() const {
+            return *it;
+        }
+        pointer operator->() const {
+            return &*it;
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        bool operator==(const const_iterator& other) const {
+            return shard == other.shard && (shard == Shards || it == other.it);
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    AVLShardedSet();
+    explicit AVLShardedSet(const Compare& compare, const Allocator& alloc = Allocator());
+    ~AVLShardedSet();
+
+    AVLShardedSet(const AVLShardedSet&) = delete;
+    AVLShardedSet& operator=(const AVLShardedSet&) = delete;
+
+    bool insert(const T& key);
+    bool insert(T&& key);
+    bool erase(const T& key);
+    bool contains(const T& key) const;
+
+    std::size_t size() const;
+    bool empty() const;
+    void clear();
+    std::size_t shard_count() const;
+
+    template <typename Visitor>
+    void for_each(Visitor visit) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+};
+
+#include "AVLShardedSetImplementation.tpp"
+
+#endif
@@ -0,0 +1,513 @@
+#include "AVLShardedSetHeader.hpp"
+
+/***************************************
+ * AVLShardedSet Constructor
+ *
+ * Initializes an empty set routed to a single shard.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+AVLShardedSet<T, Compare, Shards, Allocator>::AVLShardedSet()
+    : AVLShardedSet(Compare(), Allocator()) {}
+
+
+/***************************************
+ * AVLShardedSet Constructor (comparator and allocator)
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator every shard's tree uses for its nodes.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+AVLShardedSet<T, Compare, Shards, Allocator>::AVLShardedSet(const Compare& compare, const Allocator& alloc)
+    : layout(nullptr), comp(compare) {
+    for (Shard& shard : shards) {
+        shard.tree = Tree(compare, alloc);
+        shard.split_at = split_min;
+    }
+    layout.store(new Layout{1, std::vector<T>()}, std::memory_order_release);
+}
+
+
+/***************************************
+ * AVLShardedSet Destructor
+ *
+ * No other thread may still be using the set.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+AVLShardedSet<T, Compare, Shards, Allocator>::~AVLShardedSet() {
+    delete layout.load(std::memory_order_acquire);
+}
+
+
+/***************************************
+ * route (private helper)
+ *
+ * Returns:
+ *  - The index of the shard whose range holds key under a routing
+ *    table: the number of shard lower bounds not greater than key.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+std::size_t AVLShardedSet<T, Compare, Shards, Allocator>::route(const Layout& current, const T& key) const {
+    return static_cast<std::size_t>(std::upper_bound(current.bounds.begin(), current.bounds.end(), key, comp) -
+                                    current.bounds.begin());
+}
+
+
+/***************************************
+ * lockShard (private helper)
+ *
+ * Locks the shard a key belongs to.
+ *
+ * Parameters:
+ *  - key: The key to route.
+ *  - hold: Receives the lock (a ReadLock or WriteLock).
+ *
+ * Returns:
+ *  - The shard's index; its range cannot change while hold is held,
+ *    since a rebalance needs every shard's lock.
+ *
+ * Behavior:
+ *  - The epoch guard keeps the routing table alive between loading the
+ *    pointer and locking the shard; if a rebalance published a new
+ *    table meanwhile, the lookup is repeated.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+template <typename Lock>
+std::size_t AVLShardedSet<T, Compare, Shards, Allocator>::lockShard(const T& key, Lock& hold) const {
+    while (true) {
+        AVLEpoch::Guard guard(epoch);
+        const Layout* current = layout.load(std::memory_order_acquire);
+        const std::size_t index = route(*current, key);
+        hold = Lock(shards[index].lock);
+        if (layout.load(std::memory_order_acquire) == current) {
+            return index;
+        }
+        hold.unlock();
+    }
+}
+
+
+/***************************************
+ * lockFirst (private helper)
+ *
+ * Read-locks shard 0.
+ *
+ * Returns:
+ *  - The routing table, which stays current while any shard lock is
+ *    held.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+const typename AVLShardedSet<T, Compare, Shards, Allocator>::Layout* AVLShardedSet<T, Compare, Shards, Allocator>::lockFirst(ReadLock& hold) const {
+    while (true) {
+        const Layout* current = layout.load(std::memory_order_acquire);
+        hold = ReadLock(shards[0].lock);
+        if (layout.load(std::memory_order_acquire) == current) {
+            return current;
+        }
+        hold.unlock();
+    }
+}
+
+
+/***************************************
+ * splitLimit (private helper)
+ *
+ * Returns:
+ *  - The size at which a shard holding shardSize keys asks for the next
+ *    rebalance.
+ *
+ * Behavior:
+ *  - While slots are free every shard splits at split_min. Once all
+ *    are in use, a shard may grow to twice the mean, and to half again
+ *    its current size, so a dense range that no rebalance can thin out
+ *    does not trigger one on every insert.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+std::size_t AVLShardedSet<T, Compare, Shards, Allocator>::splitLimit(std::size_t active, std::size_t total, std::size_t shardSize) const {
+    if (active < Shards) {
+        return split_min;
+    }
+    return std::max({split_min, 2 * total / Shards, shardSize + shardSize / 2});
+}
+
+
+/***************************************
+ * openSlot (private helper)
+ *
+ * Splits a shard at its median into a new slot right after it. Every
+ * shard must be write-locked and a slot must be free.
+ *
+ * Parameters:
+ *  - index: The shard to split; it holds at least two keys.
+ *  - active, bounds: The table being built; updated.
+ *
+ * Behavior:
+ *  - The shards after index move up one slot by O(1) tree swaps; the
+ *    split itself is O(log n).
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+void AVLShardedSet<T, Compare, Shards, Allocator>::openSlot(std::size_t index, std::size_t& active, std::vector<T>& bounds) {
+    for (std::size_t k = active; k > index + 1; --k) {
+        shards[k].tree.swap(shards[k - 1].tree);
+    }
+    Tree& source = shards[index].tree;
+    const T pivot = *source.select(source.size() / 2);
+    std::pair<Tree, Tree> halves = source.split(pivot);
+    source = std::move(halves.first);
+    shards[index + 1].tree = std::move(halves.second);
+    bounds.insert(bounds.begin() + static_cast<std::ptrdiff_t>(index), pivot);
+    ++active;
+}
+
+
+/***************************************
+ * closeSlot (private helper)
+ *
+ * Joins a shard with the one after it, freeing the last slot. Every
+ * shard must be write-locked.
+ *
+ * Parameters:
+ *  - index: The first of the two shards.
+ *  - active, bounds: The table being built; updated.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+void AVLShardedSet<T, Compare, Shards, Allocator>::closeSlot(std::size_t index, std::size_t& active, std::vector<T>& bounds) {
+    shards[index].tree = Tree::join(std::move(shards[index].tree), std::move(shards[index + 1].tree));
+    for (std::size_t k = index + 1; k + 1 < active; ++k) {
+        shards[k].tree.swap(shards[k + 1].tree);
+    }
+    bounds.erase(bounds.begin() + static_cast<std::ptrdiff_t>(index));
+    --active;
+}
+
+
+/***************************************
+ * rebalance (private helper)
+ *
+ * Splits the largest shard if it has outgrown its limit.
+ *
+ * Behavior:
+ *  - Rebalances run one at a time and write-lock every shard in index
+ *    order, so the table cannot change under any operation holding a
+ *    shard lock. The new table is published before the locks are
+ *    released, and the old one is freed after an epoch synchronize.
+ *  - With every slot in use, the adjacent pair with the fewest keys
+ *    (not counting the hot shard) is joined first, if it holds fewer
+ *    keys than the hot shard; otherwise only the limits are raised.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+void AVLShardedSet<T, Compare, Shards, Allocator>::rebalance() {
+    std::lock_guard<std::mutex> serialize(rebalance_mutex);
+    WriteLock holds[Shards];
+    for (std::size_t k = 0; k < Shards; ++k) {
+        holds[k] = WriteLock(shards[k].lock);
+    }
+    const Layout* old = layout.load(std::memory_order_acquire);
+    std::size_t active = old->active;
+
+    std::size_t hot = 0;
+    std::size_t total = 0;
+    for (std::size_t k = 0; k < active; ++k) {
+        total += shards[k].tree.size();
+        if (shards[k].tree.size() > shards[hot].tree.size()) {
+            hot = k;
+        }
+    }
+    if (shards[hot].tree.size() <= shards[hot].split_at) {
+        return;
+    }
+
+    std::vector<T> bounds = old->bounds;
+    if (active == Shards && Shards > 1) {
+        std::size_t pair = Shards;
+        std::size_t pairSize = shards[hot].tree.size();
+        for (std::size_t k = 0; k + 1 < active; ++k) {
+            const std::size_t combined = shards[k].tree.size() + shards[k + 1].tree.size();
+            if (k != hot && k + 1 != hot && combined < pairSize) {
+                pair = k;
+                pairSize = combined;
+            }
+        }
+        if (pair != Shards) {
+            closeSlot(pair, active, bounds);
+            if (hot > pair) {
+                --hot;
+            }
+        }
+    }
+    if (active < Shards) {
+        openSlot(hot, active, bounds);
+    }
+    for (std::size_t k = 0; k < Shards; ++k) {
+        shards[k].split_at = splitLimit(active, total, shards[k].tree.size());
+    }
+
+    if (active != old->active || bounds != old->bounds) {
+        layout.store(new Layout{active, std::move(bounds)}, std::memory_order_release);
+        for (WriteLock& hold : holds) {
+            hold.unlock();
+        }
+        epoch.synchronize();
+        delete old;
+    }
+}
+
+
+/***************************************
+ * insertKey (private helper)
+ *
+ * Inserts into the owning shard, then rebalances if that shard has
+ * outgrown its limit.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+template <typename K>
+bool AVLShardedSet<T, Compare, Shards, Allocator>::insertKey(K&& key) {
+    bool inserted;
+    bool hot;
+    {
+        WriteLock hold;
+        Shard& shard = shards[lockShard(key, hold)];
+        inserted = shard.tree.insert(std::forward<K>(key)).second;
+        hot = inserted && shard.tree.size() > shard.split_at;
+    }
+    if (hot) {
+        rebalance();
+    }
+    return inserted;
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a key unless an equivalent one is present.
+ *
+ * Returns:
+ *  - true if the key was inserted.
+ *
+ * Behavior:
+ *  - O(log n) under the owning shard's write lock. The insert that
+ *    pushes a shard past its limit also runs the rebalance.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+bool AVLShardedSet<T, Compare, Shards, Allocator>::insert(const T& key) {
+    return insertKey(key);
+}
+
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+bool AVLShardedSet<T, Compare, Shards, Allocator>::insert(T&& key) {
+    return insertKey(std::move(key));
+}
+
+
+/***************************************
+ * erase
+ *
+ * Removes a key if present.
+ *
+ * Returns:
+ *  - true if a key was removed.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+bool AVLShardedSet<T, Compare, Shards, Allocator>::erase(const T& key) {
+    WriteLock hold;
+    Shard& shard = shards[lockShard(key, hold)];
+    return shard.tree.erase_one(key);
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ *
+ * Behavior:
+ *  - O(log n) under the owning shard's read lock.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+bool AVLShardedSet<T, Compare, Shards, Allocator>::contains(const T& key) const {
+    ReadLock hold;
+    const Shard& shard = shards[lockShard(key, hold)];
+    return shard.tree.contains(key);
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys, read with every shard read-locked at once, so
+ *    the count is exact even while keys move between shards.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+std::size_t AVLShardedSet<T, Compare, Shards, Allocator>::size() const {
+    ReadLock holds[Shards];
+    std::size_t total = 0;
+    for (std::size_t k = 0; k < Shards; ++k) {
+        holds[k] = ReadLock(shards[k].lock);
+        total += shards[k].tree.size();
+    }
+    return total;
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the set holds no keys.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+bool AVLShardedSet<T, Compare, Shards, Allocator>::empty() const {
+    return size() == 0;
+}
+
+
+/***************************************
+ * clear
+ *
+ * Removes every key; the shard ranges are kept.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+void AVLShardedSet<T, Compare, Shards, Allocator>::clear() {
+    WriteLock holds[Shards];
+    for (std::size_t k = 0; k < Shards; ++k) {
+        holds[k] = WriteLock(shards[k].lock);
+        shards[k].tree.clear();
+    }
+}
+
+
+/***************************************
+ * shard_count
+ *
+ * Returns:
+ *  - How many shards currently hold a key range, from 1 up to Shards.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+std::size_t AVLShardedSet<T, Compare, Shards, Allocator>::shard_count() const {
+    AVLEpoch::Guard guard(epoch);
+    return layout.load(std::memory_order_acquire)->active;
+}
+
+
+/***************************************
+ * for_each
+ *
+ * Calls visit(key) for every key in increasing order; safe while
+ * other threads modify the set.
+ *
+ * Parameters:
+ *  - visit: Called with a const T&; it must not modify the set.
+ *
+ * Behavior:
+ *  - Walks the shards hand over hand, read-locking the next before
+ *    releasing the current one. Each shard is seen as of the moment it
+ *    is locked, and since no rebalance can run while a shard is held,
+ *    no key is visited twice or skipped by a move between shards.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+template <typename Visitor>
+void AVLShardedSet<T, Compare, Shards, Allocator>::for_each(Visitor visit) const {
+    ReadLock hold;
+    const Layout* current = lockFirst(hold);
+    for (std::size_t k = 0; k < current->active; ++k) {
+        for (const T& key : shards[k].tree) {
+            visit(key);
+        }
+        if (k + 1 < current->active) {
+            ReadLock next(shards[k + 1].lock);
+            hold.swap(next);
+        }
+    }
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key. Iterators are not synchronized:
+ *    use them only while no thread modifies the set.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+typename AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator AVLShardedSet<T, Compare, Shards, Allocator>::begin() const {
+    const_iterator it(this, 0, shards[0].tree.begin());
+    it.skipEmpty();
+    return it;
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - The past-the-end iterator.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+typename AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator AVLShardedSet<T, Compare, Shards, Allocator>::end() const {
+    return const_iterator(this, Shards, typename Tree::const_iterator());
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+typename AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator AVLShardedSet<T, Compare, Shards, Allocator>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+typename AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator AVLShardedSet<T, Compare, Shards, Allocator>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * const_iterator::skipEmpty (private helper)
+ *
+ * Moves past the end of the current shard to the first key of the
+ * next non-empty one, or to end().
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+void AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator::skipEmpty() {
+    const std::size_t active = set->layout.load(std::memory_order_acquire)->active;
+    while (it == set->shards[shard].tree.end()) {
+        if (++shard >= active) {
+            shard = Shards;
+            it = typename Tree::const_iterator();
+            return;
+        }
+        it = set->shards[shard].tree.begin();
+    }
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Advances within the shard, then on into the next one.
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+typename AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator& AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator::operator++() {
+    ++it;
+    skipEmpty();
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, typename Compare, std::size_t Shards, typename Allocator>
+typename AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator AVLShardedSet<T, Compare, Shards, Allocator>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
@@ -3,41 +3,381 @@
 
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
 
-template <typename T, typename Compare = std::less<T> >
-class AVLTree {
+#include "AVLFrozenTreeHeader.hpp"
+#include "AVLMappedTreeHeader.hpp"
+#include "AVLNodePoolHeader.hpp"
+#include "AVLTreeStatsHeader.hpp"
+
+/***************************************
+ * AVLDefaultPolicy
+ *
+ * Compile-time options for AVLTree. Derive from this struct and
+ * override individual members to opt into extra features; every
+ * feature left off costs neither node bytes nor work.
+ ***************************************/
+struct AVLDefaultPolicy {
+    // Store subtree sizes in each node for rank(), select() and count_range().
+    static constexpr bool order_statistics = false;
+    // Keep equivalent keys, folding each run into one node that holds
+    // the first key and a repeat count (multiset semantics).
+    static constexpr bool multiset = false;
+    // Count comparisons, search depth, rotations and allocations for
+    // stats() and an optional sampling hook.
+    static constexpr bool stats = false;
+    // A monoid whose value each node keeps for its subtree, for
+    // aggregate(); void keeps none. See AVLSumAugment for the shape.
+    using augment = void;
+};
+
+struct AVLOrderStatisticsPolicy : AVLDefaultPolicy {
+    static constexpr bool order_statistics = true;
+};
+
+struct AVLMultisetPolicy : AVLDefaultPolicy {
+    static constexpr bool multiset = true;
+};
+
+struct AVLStatsPolicy : AVLDefaultPolicy {
+    static constexpr bool stats = true;
+};
+
+template <typename Augment>
+struct AVLAugmentedPolicy : AVLDefaultPolicy {
+    using augment = Augment;
+};
+
+// Per-node subtree size, present only when order statistics are enabled.
+template <bool Enabled>
+struct AVLNodeCount {};
+
+template <>
+struct AVLNodeCount<true> {
+    std::size_t count = 1;
+};
+
+// Per-node number of equivalent keys, present only for multisets.
+template <bool Enabled>
+struct AVLNodeRepeat {};
+
+template <>
+struct AVLNodeRepeat<true> {
+    std::size_t repeat = 1;
+};
+
+// Which copy of a multiset key an iterator is at, present only for
+// multisets; copyOffset() is 0 otherwise.
+template <bool Enabled>
+struct AVLIteratorOffset {
+    std::size_t offset;
+    explicit AVLIteratorOffset(std::size_t off = 0) : offset(off) {}
+    std::size_t copyOffset() const {
+        return offset;
+    }
+};
+
+template <>
+struct AVLIteratorOffset<false> {
+    explicit AVLIteratorOffset(std::size_t = 0) {}
+    std::size_t copyOffset() const {
+        return 0;
+    }
+};
+
+// Per-node subtree aggregate, present only when a policy names an
+// augment monoid.
+template <typename Augment>
+struct AVLNodeAggregate {
+    typename Augment::value_type aggregate{};
+};
+
+template <>
+struct AVLNodeAggregate<void> {};
+
+template <typename Augment>
+struct AVLAugmentValue {
+    using type = typename Augment::value_type;
+};
+
+template <>
+struct AVLAugmentValue<void> {
+    using type = void;
+};
+
+/***************************************
+ * AVLSumAugment / AVLMinAugment / AVLMaxAugment
+ *
+ * Ready-made monoids for AVLAugmentedPolicy. A monoid provides
+ * value_type and three static functions: identity(), lift(key), the
+ * value of one key, and combine(a, b), which must be associative and
+ * have identity() as its neutral element; it need not be commutative,
+ * as aggregates are always combined in key order. Value is the type
+ * the keys are converted to; the min and max identities are the
+ * extremes of std::numeric_limits<Value>.
+ ***************************************/
+template <typename Key, typename Value = Key>
+struct AVLSumAugment {
+    using value_type = Value;
+    static Value identity() {
+        return Value();
+    }
+    static Value lift(const Key& key) {
+        return static_cast<Value>(key);
+    }
+    static Value combine(const Value& a, const Value& b) {
+        return a + b;
+    }
+};
+
+template <typename Key, typename Value = Key>
+struct AVLMinAugment {
+    using value_type = Value;
+    static Value identity() {
+        return std::numeric_limits<Value>::max();
+    }
+    static Value lift(const Key& key) {
+        return static_cast<Value>(key);
+    }
+    static Value combine(const Value& a, const Value& b) {
+        return b < a ? b : a;
+    }
+};
+
+template <typename Key, typename Value = Key>
+struct AVLMaxAugment {
+    using value_type = Value;
+    static Value identity() {
+        return std::numeric_limits<Value>::lowest();
+    }
+    static Value lift(const Key& key) {
+        return static_cast<Value>(key);
+    }
+    static Value combine(const Value& a, const Value& b) {
+        return a < b ? b : a;
+    }
+};
+
+/***************************************
+ * AVLRangeView
+ *
+ * The keys of an AVLTree between two bounds, as returned by
+ * AVLTree::range(). It holds only the two end iterators, so walking
+ * it streams nodes in order without copying anything; like the
+ * iterators, it is invalidated by erasing either end. Under C++20 it
+ * models std::ranges::view and composes with the std::views adaptors.
+ ***************************************/
+template <typename Iterator>
+class AVLRangeView
+#if __cplusplus >= 202002L
+    : public std::ranges::view_base
+#endif
+{
 private:
-    struct Node {
-        T key;
+    Iterator first;
+    Iterator last;
+
+public:
+    AVLRangeView() = default;
+    AVLRangeView(Iterator b, Iterator e) : first(b), last(e) {}
+
+    Iterator begin() const {
+        return first;
+    }
+    Iterator end() const {
+        return last;
+    }
+    bool empty() const {
+        return first == last;
+    }
+};
+
+#if __cplusplus >= 202002L
+// The iterators point into the tree, not the view, so they may
+// outlive it.
+template <typename Iterator>
+inline constexpr bool std::ranges::enable_borrowed_range<AVLRangeView<Iterator> > = true;
+#endif
+
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+          typename Policy = AVLDefaultPolicy>
+class AVLTree : private AVLTreeCounters<Policy::stats> {
+    // AVLMap drives the node engine directly for single-descent
+    // try_emplace and operator[].
+    template <typename, typename, typename, typename, typename> friend class AVLMap;
+
+private:
+    // Links come first and the height sits right after the key, so a
+    // small key and the one-byte height share the trailing word.
+    // One byte is plenty: an AVL tree of height 128 would need more
+    // than 2^88 nodes.
+    struct Node : AVLNodeCount<Policy::order_statistics>, AVLNodeRepeat<Policy::multiset>,
+                  AVLNodeAggregate<typename Policy::augment> {
         Node* left;
         Node* right;
         Node* parent;
-        int height;
+        T key;
+        std::int8_t height;
 
-        Node(const T& k, Node* par = nullptr) 
-            : key(k), left(nullptr), right(nullptr), parent(par), height(1) {}
+        template <typename... Args>
+        explicit Node(Node* par, Args&&... args)
+            : left(nullptr), right(nullptr), parent(par), key(std::forward<Args>(args)...), height(1) {}
     };
 
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+    using Augment = typename Policy::augment;
+    static constexpr bool augmented = !std::is_void<Augment>::value;
+
     Node* root;
+    Node* leftmost;
+    Node* rightmost;
     std::size_t tree_size;
     Compare comp;
+    NodeAllocator node_alloc;
 
+    template <typename A, typename B>
+    bool keyLess(const A& a, const B& b) const;
+    void noteChange();
+    template <typename... Args>
+    Node* createNode(Node* parent, Args&&... args);
+    void destroyNode(Node* node);
+    Node* cloneSubtree(const Node* source, Node* parent);
     int height(Node* node) const;
     int getBalanceFactor(Node* node) const;
+    void updateNode(Node* node);
+    static std::size_t subtreeCount(const Node* node);
+    static std::size_t repeatCount(const Node* node);
+    static typename AVLAugmentValue<Augment>::type ownAggregate(const Node* node);
+    static typename AVLAugmentValue<Augment>::type subtreeAggregate(const Node* node);
+    static void updateAggregate(Node* node);
+    static void updateAggregates(Node* node);
     Node* rightRotate(Node* y);
     Node* leftRotate(Node* x);
-    void clear(Node* node);
+    void replaceChild(Node* parent, Node* oldChild, Node* newChild);
+    Node* rebalance(Node* node);
+    void retraceInsert(Node* node);
+    void retraceErase(Node* node);
+    template <typename K>
+    Node* findNode(const K& key) const;
+    static void prefetchNode(const Node* node);
+    template <typename ForwardIt>
+    std::vector<const Node*> findBatch(ForwardIt first, ForwardIt last, bool sortProbes) const;
+    template <typename K>
+    Node* lowerBoundNode(const K& key) const;
+    template <typename K>
+    Node* upperBoundNode(const K& key) const;
+    template <typename K>
+    std::size_t rankOf(const K& key, bool inclusive) const;
+    template <typename K>
+    Node* findInsertPosition(const K& key, Node*& parent, bool& goLeft) const;
+    Node* findHintPosition(Node* hint, const T& key, Node*& parent, bool& goLeft) const;
+    Node* maxValueNode(Node* node) const;
+    static Node* nextNode(Node* node);
+    static Node* prevNode(Node* node);
+    void linkNode(Node* node, Node* parent, bool goLeft);
+    template <typename K>
+    std::pair<Node*, bool> insertUnique(K&& key);
+    void addRepeat(Node* node, std::size_t copies = 1);
+    void removeRepeats(Node* node, std::size_t copies);
+    static void resetLinks(Node* node);
+    void unlinkNode(Node* node);
+    void eraseNode(Node* node);
+    void eraseOne(Node* node);
+    template <typename It>
+    Node* buildSorted(It& it, std::size_t n, Node*& slab, const std::size_t*& repeats);
+    template <typename It>
+    void assignSorted(It it, std::size_t n, const std::size_t* repeats = nullptr);
+    void sortKeys(std::vector<T>& keys, unsigned threads) const;
+    void foldRuns(std::vector<T>& keys, std::vector<std::size_t>& repeats) const;
+    Node* linkBalanced(Node* const* nodes, std::size_t n);
+    void rebuildInsert(AVLTree& batch);
+    void rebuildErase(const std::vector<T>& keys);
+    std::size_t clear(Node* node);
+    static std::size_t destroySubtree(Node* node, NodeAllocator& alloc, std::size_t& nodes);
+    void attachChildren(Node* node, Node* left, Node* right);
+    Node* joinRight(Node* left, Node* pivot, Node* right);
+    Node* joinLeft(Node* left, Node* pivot, Node* right);
+    Node* joinNodes(Node* left, Node* pivot, Node* right);
+    Node* splitLast(Node* node, Node*& rest);
+    void splitNodes(Node* node, const T& key, Node*& less, Node*& rest);
+    static std::size_t sizeOfFirst(Node* first, Node* second, std::size_t total);
+    static void checkJoinable(const AVLTree& left, const T* pivot, const AVLTree& right);
+    static AVLTree joinTrees(AVLTree& left, Node* pivot, AVLTree& right);
+    static bool sameAllocator(const AVLTree& a, const AVLTree& b);
+    Node* joinTwo(Node* left, Node* right);
+    void splitAround(Node* node, const T& key, Node*& less, Node*& found, Node*& greater);
+    std::size_t eraseBetween(const T* lo, const T* hi);
+
+    // Insert and Erase are the batch forms of insert() and erase(key):
+    // a multiset adds repeat counts or drops the whole node.
+    enum class SetOp { Union, Intersection, Difference, Insert, Erase };
+    // Subtrees shorter than this are never handed to another thread.
+    static constexpr int parallel_min_height = 12;
+    // Descents find_many() keeps in flight at once.
+    static constexpr std::size_t batch_lanes = 16;
+    // Batches shorter than this are sorted on the calling thread.
+    static constexpr std::size_t parallel_sort_min = std::size_t(1) << 15;
+    // A batch of at least size() / batch_rebuild_ratio keys is merged by
+    // an O(n + m) rebuild instead of split/join.
+    static constexpr std::size_t batch_rebuild_ratio = 4;
+    template <SetOp Op>
+    Node* setOpNodes(Node* a, Node* b, std::size_t& delta, unsigned threads);
+    template <SetOp Op>
+    static AVLTree setOperation(AVLTree& a, AVLTree& b, unsigned threads);
 
 public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using policy_type = Policy;
+    // void unless the policy names an augment monoid.
+    using aggregate_type = typename AVLAugmentValue<Augment>::type;
+
     AVLTree();
+    explicit AVLTree(const Compare& compare, const Allocator& alloc = Allocator());
+    explicit AVLTree(const Allocator& alloc);
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    AVLTree(InputIt first, InputIt last, const Compare& compare = Compare(),
+            const Allocator& alloc = Allocator());
+    AVLTree(const AVLTree& other);
+    AVLTree(AVLTree&& other) noexcept;
     ~AVLTree();
 
+    AVLTree& operator=(const AVLTree& other);
+    AVLTree& operator=(AVLTree&& other);
+    void swap(AVLTree& other) noexcept;
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);
+    void save(std::ostream& out) const;
+    void load(std::istream& in);
+    AVLFrozenTree<T, Compare, Allocator> freeze() const;
+
+    allocator_type get_allocator() const;
+
     class const_iterator;
-    class iterator {
+    class iterator : private AVLIteratorOffset<Policy::multiset> {
         friend class AVLTree;
     private:
+        using Offset = AVLIteratorOffset<Policy::multiset>;
         Node* current;
         const AVLTree* tree;
         static Node* minimum(Node* node);
@@ -49,8 +389,8 @@ public:
         using pointer = T*;
         using reference = T&;
         
-        iterator() : current(nullptr), tree(nullptr) {}
-        iterator(Node* node, const AVLTree* t) : current(node), tree(t) {}
+        iterator() : Offset(0), current(nullptr), tree(nullptr) {}
+        iterator(Node* node, const AVLTree* t, std::size_t off = 0) : Offset(off), current(node), tree(t) {}
 
         reference operator*() const {
             return current->key;
@@ -64,17 +404,18 @@ public:
         iterator operator--(int);
 
         bool operator==(const iterator& other) const {
-            return current == other.current;
+            return current == other.current && this->copyOffset() == other.copyOffset();
         }
 
         bool operator!=(const iterator& other) const {
-            return current != other.current;
+            return !(*this == other);
         }
     };
 
-    class const_iterator {
+    class const_iterator : private AVLIteratorOffset<Policy::multiset> {
         friend class AVLTree;
     private:
+        using Offset = AVLIteratorOffset<Policy::multiset>;
         const Node* current;
         const AVLTree* tree;
 
@@ -87,10 +428,10 @@ public:
         using pointer = const T*;
         using reference = const T&;
 
-        const_iterator() : current(nullptr), tree(nullptr) {}
-        const_iterator(const Node* node, const AVLTree* t) : current(node), tree(t) {}
-        const_iterator(const typename AVLTree<T, Compare>::iterator& it)
-            : current(it.current), tree(it. tree) {}
+        const_iterator() : Offset(0), current(nullptr), tree(nullptr) {}
+        const_iterator(const Node* node, const AVLTree* t, std::size_t off = 0) : Offset(off), current(node), tree(t) {}
+        const_iterator(const typename AVLTree<T, Compare, Allocator, Policy>::iterator& it)
+            : Offset(it.copyOffset()), current(it.current), tree(it.tree) {}
 
         reference operator*() const {
             return current->key;
@@ -104,12 +445,61 @@ public:
         const_iterator operator--(int);
 
         bool operator==(const const_iterator& other) const {
-            return current == other.current;
+            return current == other.current && this->copyOffset() == other.copyOffset();
         }
 
         bool operator!=(const const_iterator& other) const {
-            return current != other.current;
+            return !(*this == other);
+        }
+    };
+
+    /***************************************
+     * node_type
+     *
+     * Owning handle to a node extracted from a tree. The key can be
+     * modified while extracted, and inserting the handle into a tree
+     * with an equal allocator relinks the node without allocating or
+     * copying the key.
+     ***************************************/
+    class node_type {
+        friend class AVLTree;
+    private:
+        Node* node;
+        std::optional<NodeAllocator> alloc;
+
+        node_type(Node* n, const NodeAllocator& a) : node(n), alloc(a) {}
+        Node* release();
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+
+        node_type() noexcept : node(nullptr) {}
+        node_type(node_type&& other) noexcept;
+        node_type& operator=(node_type&& other) noexcept;
+        node_type(const node_type&) = delete;
+        node_type& operator=(const node_type&) = delete;
+        ~node_type();
+
+        bool empty() const noexcept {
+            return node == nullptr;
+        }
+        explicit operator bool() const noexcept {
+            return node != nullptr;
+        }
+        allocator_type get_allocator() const {
+            return allocator_type(*alloc);
+        }
+        value_type& value() const {
+            return node->key;
         }
+        void swap(node_type& other) noexcept;
+    };
+
+    struct insert_return_type {
+        iterator position;
+        bool inserted;
+        node_type node;
     };
 
     iterator begin();
@@ -119,19 +509,133 @@ public:
     const_iterator cbegin() const;
     const_iterator cend() const;
 
-    Node* insert(Node* node, const T& key, Node* parent);
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    reverse_iterator rbegin();
+    reverse_iterator rend();
+    const_reverse_iterator rbegin() const;
+    const_reverse_iterator rend() const;
+    const_reverse_iterator crbegin() const;
+    const_reverse_iterator crend() const;
+
+    const T& front() const;
+    const T& back() const;
+    void pop_front();
+    void pop_back();
+
     Node* minValueNode(Node* node) const;
-    Node* deleteNode(Node* node, const T& key);
     bool empty() const;
     std::size_t size() const;
-    void insert(const T& key);
+    std::pair<iterator, bool> insert(const T& key);
+    std::pair<iterator, bool> insert(T&& key);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    iterator insert(const_iterator hint, const T& key);
+    iterator insert(const_iterator hint, T&& key);
+    template <typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
     void erase(const T& key);
+    bool erase_one(const T& key);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    std::size_t erase_range(const T& lo, const T& hi);
     void clear();
+    std::future<std::size_t> clear_async();
+
+    node_type extract(const_iterator pos);
+    node_type extract(const T& key);
+    insert_return_type insert(node_type&& nh);
+    iterator insert(const_iterator hint, node_type&& nh);
+    void merge(AVLTree& source);
+    void merge(AVLTree&& source);
+
+    static AVLTree join(AVLTree&& left, const T& pivot, AVLTree&& right);
+    static AVLTree join(AVLTree&& left, T&& pivot, AVLTree&& right);
+    static AVLTree join(AVLTree&& left, AVLTree&& right);
+    std::pair<AVLTree, AVLTree> split(const T& key);
+
+    static AVLTree set_union(AVLTree a, AVLTree b);
+    static AVLTree set_union(AVLTree a, AVLTree b, unsigned threads);
+    static AVLTree set_intersection(AVLTree a, AVLTree b);
+    static AVLTree set_intersection(AVLTree a, AVLTree b, unsigned threads);
+    static AVLTree set_difference(AVLTree a, AVLTree b);
+    static AVLTree set_difference(AVLTree a, AVLTree b, unsigned threads);
+
+    template <typename InputIt>
+    std::size_t insert_batch(InputIt first, InputIt last);
+    template <typename InputIt>
+    std::size_t insert_batch(InputIt first, InputIt last, unsigned threads);
+    template <typename InputIt>
+    std::size_t erase_batch(InputIt first, InputIt last);
+    template <typename InputIt>
+    std::size_t erase_batch(InputIt first, InputIt last, unsigned threads);
     iterator find(const T& key);
     const_iterator find(const T& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& key);
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K& key) const;
+
+    iterator lower_bound(const T& key);
+    const_iterator lower_bound(const T& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& key);
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const;
 
+    iterator upper_bound(const T& key);
+    const_iterator upper_bound(const T& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& key);
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const;
+
+    std::pair<iterator, iterator> equal_range(const T& key);
+    std::pair<const_iterator, const_iterator> equal_range(const T& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key);
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const;
+
+    AVLRangeView<iterator> range(const T& lo, const T& hi);
+    AVLRangeView<const_iterator> range(const T& lo, const T& hi) const;
+
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out, bool sort_probes = false) const;
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt contains_many(ForwardIt first, ForwardIt last, OutputIt out, bool sort_probes = false) const;
+
+    bool contains(const T& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    std::size_t count(const T& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::size_t count(const K& key) const;
+
+    std::size_t rank(const T& key) const;
+    iterator select(std::size_t k);
+    const_iterator select(std::size_t k) const;
+    std::size_t count_range(const T& lo, const T& hi) const;
+    aggregate_type aggregate() const;
+    aggregate_type aggregate(const T& lo, const T& hi) const;
+
+    AVLTreeStats stats() const;
+    void reset_stats();
+    void set_stats_sampler(std::function<void(const AVLTreeStats&)> sampler, std::size_t period = 1024);
+
+private:
+    static Node* nodeOf(const_iterator it);
+    iterator lastCopyOf(Node* node);
+    Node* adoptNode(node_type& nh, Node* parent, bool goLeft);
 };
 
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void swap(AVLTree<T, Compare, Allocator, Policy>& a, AVLTree<T, Compare, Allocator, Policy>& b) noexcept {
+    a.swap(b);
+}
+
 #include "AVLTreeImplementation.tpp"
 
 #endif
\ No newline at end of file
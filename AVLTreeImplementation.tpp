@@ -1,5 +1,9 @@
 #include "AVLTreeHeader.hpp"
 #include <algorithm>  // for std::max
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 
 /***************************************
  * AVLTree Constructor
@@ -10,12 +14,66 @@
  *  - None
  *
  * Behavior:
- *  - Sets the root to nullptr.
+ *  - Sets the root and the cached leftmost/rightmost nodes to nullptr.
  *  - Initializes tree size to 0.
  *  - Constructs a Compare object using the default.
  ***************************************/
-template <typename T, typename Compare>
-AVLTree<T, Compare>::AVLTree() : root(nullptr), tree_size(0), comp(Compare()) {}
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::AVLTree()
+    : root(nullptr), leftmost(nullptr), rightmost(nullptr), tree_size(0), comp(Compare()), node_alloc(Allocator()) {}
+
+
+/***************************************
+ * AVLTree Constructor (comparator and allocator)
+ *
+ * Initializes an empty AVL tree with a custom comparator.
+ *
+ * Parameters:
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ *
+ * Behavior:
+ *  - Nodes are allocated from alloc rebound to the node type.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::AVLTree(const Compare& compare, const Allocator& alloc)
+    : root(nullptr), leftmost(nullptr), rightmost(nullptr), tree_size(0), comp(compare), node_alloc(alloc) {}
+
+
+/***************************************
+ * AVLTree Constructor (allocator)
+ *
+ * Initializes an empty AVL tree that draws nodes from alloc.
+ *
+ * Parameters:
+ *  - alloc: The allocator used to obtain node storage,
+ *    e.g. an AVLPoolAllocator for arena-backed trees.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::AVLTree(const Allocator& alloc)
+    : root(nullptr), leftmost(nullptr), rightmost(nullptr), tree_size(0), comp(Compare()), node_alloc(alloc) {}
+
+
+/***************************************
+ * AVLTree Constructor (range)
+ *
+ * Builds a tree from the keys in [first, last).
+ *
+ * Parameters:
+ *  - first, last: The input range.
+ *  - compare: The comparison functor to order keys.
+ *  - alloc: The allocator used to obtain node storage.
+ *
+ * Behavior:
+ *  - Delegates to assign(), which builds the tree in O(n) for sorted
+ *    input and O(n log n) otherwise.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt, typename>
+AVLTree<T, Compare, Allocator, Policy>::AVLTree(InputIt first, InputIt last, const Compare& compare, const Allocator& alloc)
+    : root(nullptr), leftmost(nullptr), rightmost(nullptr), tree_size(0), comp(compare), node_alloc(alloc) {
+    assign(first, last);
+}
 
 
 /***************************************
@@ -29,9 +87,296 @@ AVLTree<T, Compare>::AVLTree() : root(nullptr), tree_size(0), comp(Compare()) {}
  * Behavior:
  *  - Clears all nodes in the AVL tree.
  ***************************************/
-template <typename T, typename Compare>
-AVLTree<T, Compare>::~AVLTree() {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::~AVLTree() {
+    clear();
+}
+
+
+/***************************************
+ * AVLTree Copy Constructor
+ *
+ * Creates a deep copy of another tree.
+ *
+ * Parameters:
+ *  - other: The tree to copy.
+ *
+ * Behavior:
+ *  - Clones the node structure directly, so no comparisons or
+ *    rotations are performed.
+ *  - The allocator is obtained via select_on_container_copy_construction.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::AVLTree(const AVLTree& other)
+    : AVLTreeCounters<Policy::stats>(), root(nullptr), leftmost(nullptr), rightmost(nullptr), tree_size(0), comp(other.comp),
+      node_alloc(NodeAllocTraits::select_on_container_copy_construction(other.node_alloc)) {
+    root = cloneSubtree(other.root, nullptr);
+    leftmost = minValueNode(root);
+    rightmost = maxValueNode(root);
+    tree_size = other.tree_size;
+}
+
+
+/***************************************
+ * AVLTree Move Constructor
+ *
+ * Takes over another tree's nodes in O(1).
+ *
+ * Parameters:
+ *  - other: The tree to move from; it is left empty.
+ *
+ * Behavior:
+ *  - The allocator is copied rather than moved so the source stays
+ *    usable for new insertions.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::AVLTree(AVLTree&& other) noexcept
+    : root(other.root), leftmost(other.leftmost), rightmost(other.rightmost), tree_size(other.tree_size),
+      comp(other.comp),
+      node_alloc(other.node_alloc) {
+    other.root = nullptr;
+    other.leftmost = nullptr;
+    other.rightmost = nullptr;
+    other.tree_size = 0;
+}
+
+
+/***************************************
+ * operator= (copy assignment)
+ *
+ * Replaces the contents with a deep copy of another tree.
+ *
+ * Parameters:
+ *  - other: The tree to copy.
+ *
+ * Returns:
+ *  - A reference to this tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>& AVLTree<T, Compare, Allocator, Policy>::operator=(const AVLTree& other) {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    comp = other.comp;
+    if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
+        node_alloc = other.node_alloc;
+    }
+    root = cloneSubtree(other.root, nullptr);
+    leftmost = minValueNode(root);
+    rightmost = maxValueNode(root);
+    tree_size = other.tree_size;
+    return *this;
+}
+
+
+/***************************************
+ * operator= (move assignment)
+ *
+ * Replaces the contents with those of another tree.
+ *
+ * Parameters:
+ *  - other: The tree to move from; it is left empty.
+ *
+ * Returns:
+ *  - A reference to this tree.
+ *
+ * Behavior:
+ *  - O(1) when the allocator propagates or both allocators compare
+ *    equal; otherwise each key is moved into a freshly allocated node.
+ *  - For a multiset the fallback moves each distinct key once and
+ *    gives its new node the source node's repeat count.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>& AVLTree<T, Compare, Allocator, Policy>::operator=(AVLTree&& other) {
+    if (this == &other) {
+        return *this;
+    }
     clear();
+    comp = other.comp;
+    if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+        node_alloc = other.node_alloc;
+    }
+    if (NodeAllocTraits::propagate_on_container_move_assignment::value || node_alloc == other.node_alloc) {
+        root = other.root;
+        leftmost = other.leftmost;
+        rightmost = other.rightmost;
+        tree_size = other.tree_size;
+        other.root = nullptr;
+        other.leftmost = nullptr;
+        other.rightmost = nullptr;
+        other.tree_size = 0;
+    }
+    else {
+        for (Node* node = other.leftmost; node; node = nextNode(node)) {
+            iterator pos = insert(cend(), std::move(node->key));
+            if (repeatCount(node) > 1) {
+                addRepeat(pos.current, repeatCount(node) - 1);
+            }
+        }
+        other.clear();
+    }
+    return *this;
+}
+
+
+/***************************************
+ * swap
+ *
+ * Exchanges the contents of two trees in O(1).
+ *
+ * Parameters:
+ *  - other: The tree to swap with.
+ *
+ * Behavior:
+ *  - Allocators are swapped when they propagate on swap.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::swap(AVLTree& other) noexcept {
+    using std::swap;
+    swap(root, other.root);
+    swap(leftmost, other.leftmost);
+    swap(rightmost, other.rightmost);
+    swap(tree_size, other.tree_size);
+    swap(comp, other.comp);
+    if constexpr (NodeAllocTraits::propagate_on_container_swap::value) {
+        swap(node_alloc, other.node_alloc);
+    }
+}
+
+
+/***************************************
+ * get_allocator
+ *
+ * Returns:
+ *  - A copy of the allocator, rebound to the value type.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::allocator_type AVLTree<T, Compare, Allocator, Policy>::get_allocator() const {
+    return allocator_type(node_alloc);
+}
+
+
+/***************************************
+ * keyLess (private helper)
+ *
+ * Calls the comparator, counting the call when stats are enabled.
+ *
+ * Parameters:
+ *  - a, b: Keys, or probes a transparent comparator accepts.
+ *
+ * Returns:
+ *  - comp(a, b).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename A, typename B>
+bool AVLTree<T, Compare, Allocator, Policy>::keyLess(const A& a, const B& b) const {
+    this->countComparison();
+    return comp(a, b);
+}
+
+
+/***************************************
+ * noteChange (private helper)
+ *
+ * Hands a stats() snapshot to the installed sampler on every
+ * sample_period-th node linked or unlinked. The tree is consistent at
+ * each call site; the sampler must not modify it.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::noteChange() {
+    if constexpr (Policy::stats) {
+        if (this->sampleDue()) {
+            this->sampler(stats());
+        }
+    }
+}
+
+
+/***************************************
+ * createNode (private helper)
+ *
+ * Allocates and constructs a single node.
+ *
+ * Parameters:
+ *  - parent: Pointer to the parent node.
+ *  - args: Arguments forwarded to the key's constructor.
+ *
+ * Returns:
+ *  - Pointer to the new node.
+ *
+ * Behavior:
+ *  - The key is constructed in place inside the node.
+ *  - Storage comes from the node allocator; it is returned to the
+ *    allocator if the key's constructor throws.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename... Args>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::createNode(Node* parent, Args&&... args) {
+    Node* node = NodeAllocTraits::allocate(node_alloc, 1);
+    this->countAllocation();
+    try {
+        NodeAllocTraits::construct(node_alloc, node, parent, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        NodeAllocTraits::deallocate(node_alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+
+/***************************************
+ * destroyNode (private helper)
+ *
+ * Destroys a single node and returns its storage.
+ *
+ * Parameters:
+ *  - node: The node to free.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::destroyNode(Node* node) {
+    NodeAllocTraits::destroy(node_alloc, node);
+    NodeAllocTraits::deallocate(node_alloc, node, 1);
+    this->countDeallocation();
+}
+
+
+/***************************************
+ * cloneSubtree (private helper)
+ *
+ * Recursively copies a subtree node for node.
+ *
+ * Parameters:
+ *  - source: Root of the subtree to copy.
+ *  - parent: Parent for the copied root.
+ *
+ * Returns:
+ *  - Root of the copy, or nullptr for an empty subtree.
+ *
+ * Behavior:
+ *  - Node fields are recomputed bottom-up; recursion depth is the tree height.
+ *  - If a key copy throws, the partial copy is freed before rethrowing.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::cloneSubtree(const Node* source, Node* parent) {
+    if (!source) {
+        return nullptr;
+    }
+    Node* node = createNode(parent, source->key);
+    if constexpr (Policy::multiset) {
+        node->repeat = source->repeat;
+    }
+    try {
+        node->left = cloneSubtree(source->left, node);
+        node->right = cloneSubtree(source->right, node);
+    }
+    catch (...) {
+        clear(node);
+        throw;
+    }
+    updateNode(node);
+    return node;
 }
 
 
@@ -46,8 +391,8 @@ AVLTree<T, Compare>::~AVLTree() {
  * Returns:
  *  - The node's height, or 0 if the node is nullptr.
  ***************************************/
-template <typename T, typename Compare>
-int AVLTree<T, Compare>::height(Node* node) const {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+int AVLTree<T, Compare, Allocator, Policy>::height(Node* node) const {
     return node ? node->height : 0;
 }
 
@@ -63,12 +408,161 @@ int AVLTree<T, Compare>::height(Node* node) const {
  * Returns:
  *  - Balance factor: difference between heights of left and right child nodes.
  ***************************************/
-template <typename T, typename Compare>
-int AVLTree<T, Compare>::getBalanceFactor(Node* node) const {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+int AVLTree<T, Compare, Allocator, Policy>::getBalanceFactor(Node* node) const {
     return node ? height(node->left) - height(node->right) : 0;
 }
 
 
+/***************************************
+ * updateNode (private helper)
+ *
+ * Recomputes the derived fields of a node from its children.
+ *
+ * Parameters:
+ *  - node: The node to refresh; its children must be up to date.
+ *
+ * Behavior:
+ *  - Always refreshes the height.
+ *  - Refreshes the subtree count when order statistics are enabled,
+ *    and the aggregate when the policy names an augment monoid.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::updateNode(Node* node) {
+    node->height = static_cast<std::int8_t>(1 + std::max(height(node->left), height(node->right)));
+    if constexpr (Policy::order_statistics) {
+        node->count = repeatCount(node) + subtreeCount(node->left) + subtreeCount(node->right);
+    }
+    updateAggregate(node);
+}
+
+
+/***************************************
+ * subtreeCount (private helper)
+ *
+ * Returns the number of keys in a subtree.
+ *
+ * Parameters:
+ *  - node: The root of the subtree.
+ *
+ * Returns:
+ *  - The stored subtree count, or 0 if the node is nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::subtreeCount(const Node* node) {
+    static_assert(Policy::order_statistics, "subtree counts require an order-statistics policy");
+    return node ? node->count : 0;
+}
+
+
+/***************************************
+ * repeatCount (private helper)
+ *
+ * Returns the number of equivalent keys a node stands for.
+ *
+ * Parameters:
+ *  - node: A node of the tree.
+ *
+ * Returns:
+ *  - The node's repeat count for a multiset, otherwise 1.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::repeatCount(const Node* node) {
+    if constexpr (Policy::multiset) {
+        return node->repeat;
+    }
+    else {
+        (void)node;
+        return 1;
+    }
+}
+
+
+/***************************************
+ * ownAggregate (private helper)
+ *
+ * Returns the augment value of the keys a node itself holds.
+ *
+ * Parameters:
+ *  - node: A node of the tree.
+ *
+ * Returns:
+ *  - lift(key), combined with itself repeat times for a multiset
+ *    node (by doubling, so O(log repeat) combines).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLAugmentValue<typename Policy::augment>::type AVLTree<T, Compare, Allocator, Policy>::ownAggregate(const Node* node) {
+    static_assert(augmented, "aggregates require a policy with an augment monoid");
+    if constexpr (Policy::multiset) {
+        aggregate_type result = Augment::identity();
+        aggregate_type power = Augment::lift(node->key);
+        for (std::size_t n = node->repeat; n; n >>= 1) {
+            if (n & 1) {
+                result = Augment::combine(result, power);
+            }
+            if (n > 1) {
+                power = Augment::combine(power, power);
+            }
+        }
+        return result;
+    }
+    else {
+        return Augment::lift(node->key);
+    }
+}
+
+
+/***************************************
+ * subtreeAggregate (private helper)
+ *
+ * Returns:
+ *  - The stored aggregate of a subtree, or identity() if the node is
+ *    nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLAugmentValue<typename Policy::augment>::type AVLTree<T, Compare, Allocator, Policy>::subtreeAggregate(const Node* node) {
+    static_assert(augmented, "aggregates require a policy with an augment monoid");
+    return node ? node->aggregate : Augment::identity();
+}
+
+
+/***************************************
+ * updateAggregate (private helper)
+ *
+ * Recomputes a node's aggregate from its key and its children's
+ * aggregates, in key order.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::updateAggregate(Node* node) {
+    if constexpr (augmented) {
+        node->aggregate = Augment::combine(Augment::combine(subtreeAggregate(node->left), ownAggregate(node)),
+                                           subtreeAggregate(node->right));
+    }
+    else {
+        (void)node;
+    }
+}
+
+
+/***************************************
+ * updateAggregates (private helper)
+ *
+ * Recomputes the aggregates from a node up to the root, after the
+ * node's keys changed without any relinking.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::updateAggregates(Node* node) {
+    if constexpr (augmented) {
+        for (; node; node = node->parent) {
+            updateAggregate(node);
+        }
+    }
+    else {
+        (void)node;
+    }
+}
+
+
 /***************************************
  * rightRotate
  *
@@ -81,10 +575,10 @@ int AVLTree<T, Compare>::getBalanceFactor(Node* node) const {
  *  - The new root after rotation.
  *
  * Behavior:
- *  - Adjusts child pointers and updates heights.
+ *  - Adjusts child pointers and updates heights (and subtree counts).
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::rightRotate(Node* y) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::rightRotate(Node* y) {
     Node* x = y->left;
     Node* T2 = x->right;
 
@@ -100,8 +594,8 @@ typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::rightRotate(Node* y) {
     }
 
     // Update heights.
-    y->height = std::max(height(y->left), height(y->right)) + 1;
-    x->height = std::max(height(x->left), height(x->right)) + 1;
+    updateNode(y);
+    updateNode(x);
 
     return x;
 }
@@ -119,10 +613,11 @@ typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::rightRotate(Node* y) {
  *  - The new root after rotation.
  *
  * Behavior:
- *  - Adjusts pointers and updates heights of involved nodes.
+ *  - Adjusts pointers and updates heights (and subtree counts) of
+ *    involved nodes.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::leftRotate(Node* x) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::leftRotate(Node* x) {
     Node* y = x->right;
     Node* T2 = y->left;
 
@@ -138,331 +633,3980 @@ typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::leftRotate(Node* x) {
     }
 
     // Update heights.
-    x->height = std::max(height(x->left), height(x->right)) + 1;
-    y->height = std::max(height(y->left), height(y->right)) + 1;
+    updateNode(x);
+    updateNode(y);
 
     return y;
 }
 
 
 /***************************************
- * insert (helper recursive function)
+ * replaceChild (private helper)
  *
- * Recursively inserts a key into the subtree rooted at node.
+ * Re-points the parent link that referred to oldChild.
  *
  * Parameters:
- *  - node: Current root of the subtree.
- *  - key: The value to insert.
- *  - parent: Pointer to the parent node.
- *
- * Returns:
- *  - The new root of the subtree.
+ *  - parent: The parent of oldChild, or nullptr if oldChild is the root.
+ *  - oldChild: The node being replaced.
+ *  - newChild: The node (possibly nullptr) taking its place.
  *
  * Behavior:
- *  - Performs a standard BST insert.
- *  - Updates node height.
- *  - Rebalances the subtree if needed.
+ *  - Updates root when parent is nullptr.
+ *  - Does not touch newChild->parent; callers set it themselves.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::insert(Node* node, const T& key, Node* parent) {
-    if (!node) {
-        ++tree_size;
-        return new Node(key, parent);
-    }
-    if (comp(key, node->key)) {
-        node->left = insert(node->left, key, node);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::replaceChild(Node* parent, Node* oldChild, Node* newChild) {
+    if (!parent) {
+        root = newChild;
     }
-    else if (comp(node->key, key)) {
-        node->right = insert(node->right, key, node);
+    else if (parent->left == oldChild) {
+        parent->left = newChild;
     }
     else {
-        // Duplicate keys are not inserted.
-        return node;
+        parent->right = newChild;
     }
+}
+
+
+/***************************************
+ * rebalance (private helper)
+ *
+ * Restores the AVL property at a node whose balance factor is +-2.
+ *
+ * Parameters:
+ *  - node: The unbalanced node; its height must be up to date.
+ *
+ * Returns:
+ *  - The new root of the subtree, already linked into node's parent.
+ *
+ * Behavior:
+ *  - Chooses a single or double rotation from the balance factor of
+ *    the taller child, which works for both insertion and deletion.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::rebalance(Node* node) {
+    Node* parent = node->parent;
+    Node* subtree;
+    bool isDouble = false;
+    if (getBalanceFactor(node) > 1) {
+        // Left Right Case.
+        if (getBalanceFactor(node->left) < 0) {
+            node->left = leftRotate(node->left);
+            isDouble = true;
+        }
+        // Left Left Case.
+        subtree = rightRotate(node);
+    }
+    else {
+        // Right Left Case.
+        if (getBalanceFactor(node->right) > 0) {
+            node->right = rightRotate(node->right);
+            isDouble = true;
+        }
+        // Right Right Case.
+        subtree = leftRotate(node);
+    }
+    this->countRotation(isDouble);
+    replaceChild(parent, node, subtree);
+    return subtree;
+}
+
+
+/***************************************
+ * retraceInsert (private helper)
+ *
+ * Walks from a freshly linked leaf towards the root fixing heights.
+ *
+ * Parameters:
+ *  - node: The newly inserted node.
+ *
+ * Behavior:
+ *  - Stops rebalancing as soon as an ancestor's height is unchanged.
+ *  - Stops rebalancing after the first rotation, which always restores
+ *    the subtree's height from before the insertion.
+ *  - With order statistics the remaining ancestors only have their
+ *    subtree count raised by the keys the node holds; an augmented
+ *    tree recomputes their aggregates.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::retraceInsert(Node* node) {
+    updateAggregate(node);
+    Node* p = node->parent;
+    while (p) {
+        int oldHeight = p->height;
+        updateNode(p);
+        int balance = getBalanceFactor(p);
+        if (balance > 1 || balance < -1) {
+            p = rebalance(p)->parent;
+            break;
+        }
+        bool unchanged = p->height == oldHeight;
+        p = p->parent;
+        if (unchanged) {
+            break;
+        }
+    }
+    if constexpr (Policy::order_statistics) {
+        const std::size_t added = repeatCount(node);
+        for (Node* q = p; q; q = q->parent) {
+            q->count += added;
+        }
+    }
+    updateAggregates(p);
+}
+
+
+/***************************************
+ * retraceErase (private helper)
+ *
+ * Walks from the parent of an unlinked node towards the root fixing
+ * heights and rebalancing.
+ *
+ * Parameters:
+ *  - node: The lowest node whose subtree lost an element.
+ *
+ * Behavior:
+ *  - Unlike insertion a rotation may shorten the subtree, so the walk
+ *    continues until a subtree's height comes out unchanged.
+ *  - With order statistics the remaining ancestors only have their
+ *    subtree count decremented, or recomputed for a multiset, where
+ *    the removed node may have stood for several keys. An augmented
+ *    tree recomputes their aggregates.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::retraceErase(Node* node) {
+    while (node) {
+        int oldHeight = node->height;
+        updateNode(node);
+        int balance = getBalanceFactor(node);
+        if (balance > 1 || balance < -1) {
+            node = rebalance(node);
+        }
+        bool unchanged = node->height == oldHeight;
+        node = node->parent;
+        if (unchanged) {
+            break;
+        }
+    }
+    if constexpr (Policy::order_statistics) {
+        for (Node* p = node; p; p = p->parent) {
+            if constexpr (Policy::multiset) {
+                p->count = repeatCount(p) + subtreeCount(p->left) + subtreeCount(p->right);
+            }
+            else {
+                --p->count;
+            }
+        }
+    }
+    updateAggregates(node);
+}
+
+
+/***************************************
+ * findNode (private helper)
+ *
+ * Locates the node holding a key.
+ *
+ * Parameters:
+ *  - key: The key to look for; T or any type a transparent comparator
+ *    accepts.
+ *
+ * Returns:
+ *  - Pointer to the matching node, or nullptr if absent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::findNode(const K& key) const {
+    Node* current = root;
+    std::size_t visited = 0;
+    while (current) {
+        ++visited;
+        if (keyLess(key, current->key)) {
+            current = current->left;
+        }
+        else if (keyLess(current->key, key)) {
+            current = current->right;
+        }
+        else {
+            break;
+        }
+    }
+    this->countSearch(visited);
+    return current;
+}
+
+
+/***************************************
+ * prefetchNode (private helper)
+ *
+ * Hints that a node is about to be compared against. A no-op for
+ * nullptr and on compilers without __builtin_prefetch.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::prefetchNode(const Node* node) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(node);
+#else
+    (void)node;
+#endif
+}
+
+
+/***************************************
+ * findBatch (private helper)
+ *
+ * Looks up a batch of probes with their descents interleaved.
+ *
+ * Parameters:
+ *  - first, last: The probes; dereferencing must yield references
+ *    that stay valid during the call.
+ *  - sortProbes: Whether to visit the probes in key order.
+ *
+ * Returns:
+ *  - For each probe, in input order, its node or nullptr.
+ *
+ * Behavior:
+ *  - Up to batch_lanes descents are in flight. Each round advances
+ *    every lane by one level and prefetches the child it moves to, so
+ *    by the time a lane is revisited its node has had a whole round
+ *    to arrive and the misses of different probes overlap. A lane
+ *    whose probe is resolved takes the next one from the root.
+ *  - With sortProbes, neighbouring lanes descend along mostly the same
+ *    path, so the shared upper levels stay cached. The O(m log m) sort
+ *    pays off when the batch is dense in the key space (or repeats
+ *    keys); for a few thousand scattered probes into millions of keys
+ *    the interleaving alone is faster.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename ForwardIt>
+std::vector<const typename AVLTree<T, Compare, Allocator, Policy>::Node*>
+AVLTree<T, Compare, Allocator, Policy>::findBatch(ForwardIt first, ForwardIt last, bool sortProbes) const {
+    std::vector<const T*> probes;
+    for (; first != last; ++first) {
+        probes.push_back(std::addressof(*first));
+    }
+    const std::size_t n = probes.size();
+    std::vector<const Node*> results(n, nullptr);
+    std::vector<std::size_t> order;
+    if (sortProbes) {
+        order.resize(n);
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return comp(*probes[a], *probes[b]);
+        });
+    }
+
+    struct Lane {
+        const Node* node;
+        std::size_t probe;
+        std::size_t visited;
+    };
+    Lane lanes[batch_lanes];
+    std::size_t active = 0;
+    std::size_t next = 0;
+    auto probeAt = [&](std::size_t i) {
+        return sortProbes ? order[i] : i;
+    };
+    for (; active < batch_lanes && next < n; ++active, ++next) {
+        lanes[active] = Lane{root, probeAt(next), 0};
+    }
+    while (active > 0) {
+        for (std::size_t i = 0; i < active;) {
+            Lane& lane = lanes[i];
+            const Node* node = lane.node;
+            bool done = node == nullptr;
+            if (!done) {
+                if constexpr (Policy::stats) {
+                    ++lane.visited;
+                }
+                const T& key = *probes[lane.probe];
+                if (keyLess(key, node->key)) {
+                    node = node->left;
+                }
+                else if (keyLess(node->key, key)) {
+                    node = node->right;
+                }
+                else {
+                    results[lane.probe] = node;
+                    done = true;
+                }
+            }
+            if (!done) {
+                prefetchNode(node);
+                lane.node = node;
+                ++i;
+                continue;
+            }
+            this->countSearch(lane.visited);
+            if (next < n) {
+                lane = Lane{root, probeAt(next++), 0};
+                ++i;
+            }
+            else {
+                lane = lanes[--active];
+            }
+        }
+    }
+    return results;
+}
+
+
+/***************************************
+ * minValueNode
+ *
+ * Finds the node with the minimum key in the subtree.
+ *
+ * Parameters:
+ *  - node: The root of the subtree.
+ *
+ * Returns:
+ *  - Pointer to the node with the minimum key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::minValueNode(Node* node) const {
+    Node* current = node;
+    while (current && current->left) {
+        current = current->left;
+    }
+    return current;
+}
+
+
+/***************************************
+ * findInsertPosition (private helper)
+ *
+ * Descends to the slot where a key would be linked.
+ *
+ * Parameters:
+ *  - key: The key being inserted; T or any type the comparator accepts.
+ *  - parent: Receives the node the new leaf would hang from.
+ *  - goLeft: Receives whether the leaf would be parent's left child.
+ *
+ * Returns:
+ *  - The node holding an equivalent key, or nullptr if the slot is free.
+ *
+ * Behavior:
+ *  - A key greater than the cached rightmost node is appended after a
+ *    single comparison, so monotonic input skips the descent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::findInsertPosition(const K& key, Node*& parent, bool& goLeft) const {
+    goLeft = false;
+    if (rightmost && keyLess(rightmost->key, key)) {
+        parent = rightmost;
+        return nullptr;
+    }
+    parent = nullptr;
+    Node* current = root;
+    while (current) {
+        parent = current;
+        if (keyLess(key, current->key)) {
+            current = current->left;
+            goLeft = true;
+        }
+        else if (keyLess(current->key, key)) {
+            current = current->right;
+            goLeft = false;
+        }
+        else {
+            return current;
+        }
+    }
+    return nullptr;
+}
+
+
+/***************************************
+ * linkNode (private helper)
+ *
+ * Attaches a new leaf at a free slot and rebalances.
+ *
+ * Parameters:
+ *  - node: A freshly created node, or an adopted one whose links have
+ *    been reset.
+ *  - parent: The node to hang it from, or nullptr for an empty tree.
+ *  - goLeft: Whether node becomes parent's left child.
+ *
+ * Behavior:
+ *  - Keeps the cached leftmost and rightmost nodes current.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::linkNode(Node* node, Node* parent, bool goLeft) {
+    node->parent = parent;
+    if (!parent) {
+        root = node;
+    }
+    else if (goLeft) {
+        parent->left = node;
+    }
+    else {
+        parent->right = node;
+    }
+    if (!parent || (parent == leftmost && goLeft)) {
+        leftmost = node;
+    }
+    if (!parent || (parent == rightmost && !goLeft)) {
+        rightmost = node;
+    }
+    tree_size += repeatCount(node);
+    retraceInsert(node);
+    noteChange();
+}
+
+
+/***************************************
+ * insertUnique (private helper)
+ *
+ * Inserts a key unless an equivalent key is already present.
+ *
+ * Parameters:
+ *  - key: The key to insert, forwarded into the node.
+ *
+ * Returns:
+ *  - The node holding the key and whether it was newly inserted.
+ *
+ * Behavior:
+ *  - The node is only allocated once the slot is known to be free.
+ *  - For a multiset an equivalent key bumps the existing node's repeat
+ *    count instead, and the insertion always succeeds.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::Node*, bool> AVLTree<T, Compare, Allocator, Policy>::insertUnique(K&& key) {
+    Node* parent;
+    bool goLeft;
+    Node* existing = findInsertPosition(key, parent, goLeft);
+    if (existing) {
+        if constexpr (Policy::multiset) {
+            addRepeat(existing);
+            return std::make_pair(existing, true);
+        }
+        // Duplicate keys are not inserted.
+        return std::make_pair(existing, false);
+    }
+    Node* node = createNode(parent, std::forward<K>(key));
+    linkNode(node, parent, goLeft);
+    return std::make_pair(node, true);
+}
+
+
+/***************************************
+ * addRepeat (private helper)
+ *
+ * Records more copies of a multiset node's key.
+ *
+ * Parameters:
+ *  - node: The node holding an equivalent key.
+ *  - copies: How many copies to add.
+ *
+ * Behavior:
+ *  - No allocation and no rebalancing; with order statistics the
+ *    subtree counts on the path to the root are incremented, and
+ *    aggregates on it are recomputed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::addRepeat(Node* node, std::size_t copies) {
+    if constexpr (Policy::multiset) {
+        node->repeat += copies;
+        tree_size += copies;
+        if constexpr (Policy::order_statistics) {
+            for (Node* p = node; p; p = p->parent) {
+                p->count += copies;
+            }
+        }
+        updateAggregates(node);
+    }
+    else {
+        (void)node;
+        (void)copies;
+    }
+}
+
+
+/***************************************
+ * removeRepeats (private helper)
+ *
+ * Drops copies from a multiset node that keeps at least one.
+ *
+ * Parameters:
+ *  - node: A linked node.
+ *  - copies: How many copies to drop; less than its repeat count.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::removeRepeats(Node* node, std::size_t copies) {
+    if constexpr (Policy::multiset) {
+        node->repeat -= copies;
+        tree_size -= copies;
+        if constexpr (Policy::order_statistics) {
+            for (Node* p = node; p; p = p->parent) {
+                p->count -= copies;
+            }
+        }
+        updateAggregates(node);
+    }
+    else {
+        (void)node;
+        (void)copies;
+    }
+}
+
+
+/***************************************
+ * unlinkNode (private helper)
+ *
+ * Detaches a node from the tree and rebalances bottom-up, leaving
+ * the node itself alive.
+ *
+ * Parameters:
+ *  - node: The node to detach.
+ *
+ * Behavior:
+ *  - A node with at most one child is spliced out by linking that
+ *    child (if any) to its parent.
+ *  - A node with two children is replaced by its in-order successor,
+ *    which is relinked into its place; keys never move between nodes,
+ *    so iterators to other elements stay valid and T need not be
+ *    assignable.
+ *  - The path is then retraced iteratively from the lowest node that
+ *    lost a descendant.
+ *  - If the removed node was the leftmost (rightmost) one, its in-order
+ *    successor (predecessor) takes over the cached pointer.
+ *  - A multiset node is removed with all of its repeats.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::unlinkNode(Node* node) {
+    const std::size_t removed = repeatCount(node);
+    if (node->left && node->right) {
+        // Node with two children: the inorder successor takes its place.
+        Node* successor = minValueNode(node->right);
+        Node* retraceFrom = successor;
+        if (successor->parent != node) {
+            retraceFrom = successor->parent;
+            retraceFrom->left = successor->right;
+            if (successor->right) {
+                successor->right->parent = retraceFrom;
+            }
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->parent = node->parent;
+        successor->height = node->height;
+        if constexpr (Policy::order_statistics) {
+            successor->count = node->count;
+        }
+        replaceChild(node->parent, node, successor);
+        tree_size -= removed;
+        retraceErase(retraceFrom);
+        noteChange();
+        return;
+    }
+
+    Node* child = node->left ? node->left : node->right;
+    Node* parent = node->parent;
+    if (node == leftmost) {
+        leftmost = node->right ? minValueNode(node->right) : parent;
+    }
+    if (node == rightmost) {
+        rightmost = node->left ? maxValueNode(node->left) : parent;
+    }
+    if (child) {
+        child->parent = parent;
+    }
+    replaceChild(parent, node, child);
+    tree_size -= removed;
+    retraceErase(parent);
+    noteChange();
+}
+
+
+/***************************************
+ * resetLinks (private helper)
+ *
+ * Returns a detached node to the state of a fresh leaf.
+ *
+ * Parameters:
+ *  - node: A node unlinked from some tree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::resetLinks(Node* node) {
+    node->left = nullptr;
+    node->right = nullptr;
+    node->parent = nullptr;
+    node->height = 1;
+    if constexpr (Policy::order_statistics) {
+        node->count = repeatCount(node);
+    }
+}
+
+
+/***************************************
+ * eraseNode (private helper)
+ *
+ * Unlinks and frees a node.
+ *
+ * Parameters:
+ *  - node: The node to remove.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::eraseNode(Node* node) {
+    unlinkNode(node);
+    destroyNode(node);
+}
+
+
+/***************************************
+ * eraseOne (private helper)
+ *
+ * Removes a single copy of a node's key.
+ *
+ * Parameters:
+ *  - node: The node to remove one key from.
+ *
+ * Behavior:
+ *  - A multiset node with repeats left only has its count lowered (and
+ *    the subtree counts above it); otherwise the node is erased.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::eraseOne(Node* node) {
+    if constexpr (Policy::multiset) {
+        if (node->repeat > 1) {
+            --node->repeat;
+            --tree_size;
+            if constexpr (Policy::order_statistics) {
+                for (Node* p = node; p; p = p->parent) {
+                    --p->count;
+                }
+            }
+            updateAggregates(node);
+            return;
+        }
+    }
+    eraseNode(node);
+}
+
+
+/***************************************
+ * maxValueNode (private helper)
+ *
+ * Finds the node with the maximum key in the subtree.
+ *
+ * Parameters:
+ *  - node: The root of the subtree.
+ *
+ * Returns:
+ *  - Pointer to the node with the maximum key, or nullptr if empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::maxValueNode(Node* node) const {
+    Node* current = node;
+    while (current && current->right) {
+        current = current->right;
+    }
+    return current;
+}
+
+
+/***************************************
+ * nextNode (private helper)
+ *
+ * Finds the in-order successor of a node.
+ *
+ * Parameters:
+ *  - node: A node of the tree.
+ *
+ * Returns:
+ *  - The successor, or nullptr if node holds the largest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::nextNode(Node* node) {
+    if (node->right) {
+        node = node->right;
+        while (node->left) {
+            node = node->left;
+        }
+        return node;
+    }
+    Node* p = node->parent;
+    while (p && node == p->right) {
+        node = p;
+        p = p->parent;
+    }
+    return p;
+}
+
+
+/***************************************
+ * prevNode (private helper)
+ *
+ * Finds the in-order predecessor of a node.
+ *
+ * Parameters:
+ *  - node: A node of the tree.
+ *
+ * Returns:
+ *  - The predecessor, or nullptr if node holds the smallest key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::prevNode(Node* node) {
+    if (node->left) {
+        node = node->left;
+        while (node->right) {
+            node = node->right;
+        }
+        return node;
+    }
+    Node* p = node->parent;
+    while (p && node == p->left) {
+        node = p;
+        p = p->parent;
+    }
+    return p;
+}
+
+
+/***************************************
+ * clear (private helper)
+ *
+ * Deletes all nodes in a subtree.
+ *
+ * Parameters:
+ *  - node: The root of the subtree.
+ *
+ * Returns:
+ *  - The number of keys the subtree held.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::clear(Node* node) {
+    std::size_t nodes = 0;
+    const std::size_t freed = destroySubtree(node, node_alloc, nodes);
+    this->countDeallocation(nodes);
+    return freed;
+}
+
+
+/***************************************
+ * destroySubtree (private helper)
+ *
+ * Frees every node of a detached subtree without recursion.
+ *
+ * Parameters:
+ *  - node: The root of the subtree; its parent link is ignored.
+ *  - alloc: The allocator the nodes came from.
+ *  - nodes: Increased by the number of nodes freed.
+ *
+ * Returns:
+ *  - The number of keys the subtree held.
+ *
+ * Behavior:
+ *  - Rotates each left child up until the current node has none, then
+ *    frees it and moves on to its right child. Every rotation puts one
+ *    more node on the right spine, so there are fewer rotations than
+ *    nodes, and the extra memory is O(1) for any tree shape.
+ *  - Nodes are not destroyed at all when that would be a no-op (its
+ *    key and fields are trivially destructible); their storage is
+ *    only handed back.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::destroySubtree(Node* node, NodeAllocator& alloc, std::size_t& nodes) {
+    std::size_t freed = 0;
+    while (node) {
+        Node* left = node->left;
+        if (left) {
+            node->left = left->right;
+            left->right = node;
+            node = left;
+            continue;
+        }
+        Node* next = node->right;
+        freed += repeatCount(node);
+        if constexpr (!std::is_trivially_destructible<Node>::value) {
+            NodeAllocTraits::destroy(alloc, node);
+        }
+        NodeAllocTraits::deallocate(alloc, node, 1);
+        ++nodes;
+        node = next;
+    }
+    return freed;
+}
+
+
+/***************************************
+ * nodeOf (private helper)
+ *
+ * Recovers the node behind a const_iterator.
+ *
+ * Parameters:
+ *  - it: An iterator into this tree, or end().
+ *
+ * Returns:
+ *  - The node it refers to, or nullptr for end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::nodeOf(const_iterator it) {
+    return const_cast<Node*>(it.current);
+}
+
+
+/***************************************
+ * lastCopyOf (private helper)
+ *
+ * Builds the iterator an insertion returns.
+ *
+ * Parameters:
+ *  - node: The node that received the key.
+ *
+ * Returns:
+ *  - An iterator to the node's last copy, which for a multiset is the
+ *    one just added; equivalent keys keep their insertion order.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::lastCopyOf(Node* node) {
+    return iterator(node, this, repeatCount(node) - 1);
+}
+
+
+/***************************************
+ * buildSorted (private helper)
+ *
+ * Builds a perfectly balanced subtree from n consecutive sorted keys.
+ *
+ * Parameters:
+ *  - it: Iterator to the next key; advanced past the n keys consumed.
+ *  - n: Number of keys in the subtree.
+ *  - slab: Pre-allocated node storage to place nodes in, or nullptr to
+ *    allocate each node individually; advanced past the slots used.
+ *  - repeats: Multiset repeat count for each key, or nullptr if every
+ *    key occurs once; advanced past the counts used.
+ *
+ * Returns:
+ *  - Root of the subtree with parent set to nullptr.
+ *
+ * Behavior:
+ *  - Keys are read strictly in order, so the left subtree is built
+ *    first, then its root, then the right subtree (bottom-up).
+ *  - Heights and parent pointers are set directly; no rotations.
+ *  - Recursion depth is the height of the result, O(log n).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename It>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::buildSorted(It& it, std::size_t n, Node*& slab, const std::size_t*& repeats) {
+    if (n == 0) {
+        return nullptr;
+    }
+    const std::size_t leftCount = (n - 1) / 2;
+    Node* left = buildSorted(it, leftCount, slab, repeats);
+    Node* node;
+    try {
+        if (slab) {
+            NodeAllocTraits::construct(node_alloc, slab, nullptr, *it);
+            node = slab++;
+        }
+        else {
+            node = createNode(nullptr, *it);
+        }
+    }
+    catch (...) {
+        clear(left);
+        throw;
+    }
+    ++it;
+    if constexpr (Policy::multiset) {
+        if (repeats) {
+            node->repeat = *repeats++;
+        }
+    }
+
+    node->left = left;
+    if (left) {
+        left->parent = node;
+    }
+    try {
+        node->right = buildSorted(it, n - 1 - leftCount, slab, repeats);
+    }
+    catch (...) {
+        clear(node);
+        throw;
+    }
+    if (node->right) {
+        node->right->parent = node;
+    }
+    updateNode(node);
+    return node;
+}
+
+
+/***************************************
+ * assignSorted (private helper)
+ *
+ * Replaces the contents with n strictly increasing keys.
+ *
+ * Parameters:
+ *  - it: Iterator to the first key.
+ *  - n: Number of keys.
+ *  - repeats: Multiset repeat count for each key, or nullptr.
+ *
+ * Behavior:
+ *  - Arena-backed trees take all n nodes from one contiguous
+ *    allocation; the arena can still recycle them one at a time.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename It>
+void AVLTree<T, Compare, Allocator, Policy>::assignSorted(It it, std::size_t n, const std::size_t* repeats) {
+    clear();
+    if (n == 0) {
+        return;
+    }
+    Node* slab = nullptr;
+    Node* slabBegin = nullptr;
+    if constexpr (AVLIsPoolAllocator<NodeAllocator>::value) {
+        slab = slabBegin = NodeAllocTraits::allocate(node_alloc, n);
+        this->countAllocation();
+    }
+    const std::size_t* counts = repeats;
+    try {
+        root = buildSorted(it, n, slab, counts);
+    }
+    catch (...) {
+        if (slabBegin) {
+            // Slots never constructed go back to the arena's free list.
+            std::size_t used = static_cast<std::size_t>(slab - slabBegin);
+            NodeAllocTraits::deallocate(node_alloc, slab, n - used);
+        }
+        throw;
+    }
+    leftmost = minValueNode(root);
+    rightmost = maxValueNode(root);
+    tree_size = repeats ? static_cast<std::size_t>(std::accumulate(repeats, repeats + n, std::size_t(0))) : n;
+}
+
+
+/***************************************
+ * assign
+ *
+ * Replaces the contents with the keys in [first, last).
+ *
+ * Parameters:
+ *  - first, last: The input range.
+ *
+ * Behavior:
+ *  - Forward ranges that are already strictly increasing are built
+ *    directly from the range in O(n).
+ *  - Anything else is copied into a buffer, stable-sorted and
+ *    deduplicated (the first of equivalent keys wins, as with repeated
+ *    insert()), then built in O(n) from the buffer.
+ *  - For a multiset each run of equivalent keys becomes one node
+ *    holding the first of them and the run length.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt>
+void AVLTree<T, Compare, Allocator, Policy>::assign(InputIt first, InputIt last) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+        bool increasing = true;
+        std::size_t n = 0;
+        InputIt prev = first;
+        for (InputIt it = first; it != last; ++it, ++n) {
+            if (n > 0 && !keyLess(*prev, *it)) {
+                increasing = false;
+                break;
+            }
+            prev = it;
+        }
+        if (increasing) {
+            assignSorted(first, n);
+            return;
+        }
+    }
+
+    std::vector<T> keys(first, last);
+    std::vector<std::size_t> repeats;
+    sortKeys(keys, 1);
+    foldRuns(keys, repeats);
+    assignSorted(std::make_move_iterator(keys.begin()), keys.size(), repeats.empty() ? nullptr : repeats.data());
+}
+
+
+/***************************************
+ * freeze
+ *
+ * Returns:
+ *  - An immutable copy of the tree in Eytzinger order, searched
+ *    branchlessly through one contiguous array. The tree itself is
+ *    unchanged.
+ *
+ * Behavior:
+ *  - O(n). The result uses the same comparator and a copy of the
+ *    allocator; a multiset is refused at compile time, since the
+ *    frozen layout keeps one copy per key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLFrozenTree<T, Compare, Allocator> AVLTree<T, Compare, Allocator, Policy>::freeze() const {
+    static_assert(!Policy::multiset, "freeze() keeps one copy per key");
+    return AVLFrozenTree<T, Compare, Allocator>(begin(), end(), tree_size, comp, get_allocator());
+}
+
+/***************************************
+ * save
+ *
+ * Writes the tree in the binary format described by AVLFileHeader.
+ *
+ * Parameters:
+ *  - out: A stream opened in binary mode.
+ *
+ * Behavior:
+ *  - Keys are written as raw bytes in increasing order, so T must be
+ *    trivially copyable; a multiset also writes one repeat count per
+ *    node. The result can be read back with load() or searched in
+ *    place through AVLMappedTree.
+ *  - Writes go out in chunks of a few thousand keys. Throws
+ *    std::runtime_error if the stream fails.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::save(std::ostream& out) const {
+    static_assert(std::is_trivially_copyable<T>::value, "save() writes keys as raw bytes");
+    std::size_t nodes = tree_size;
+    if constexpr (Policy::multiset) {
+        nodes = 0;
+        for (const Node* node = root ? minValueNode(root) : nullptr; node; node = nextNode(const_cast<Node*>(node))) {
+            ++nodes;
+        }
+    }
+    const AVLFileHeader header = AVLFileHeader::describe(sizeof(T), alignof(T), nodes, tree_size, Policy::multiset);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const char padding[64] = {};
+    std::uint64_t written = sizeof(header);
+    auto pad = [&](std::uint64_t offset) {
+        while (written < offset) {
+            const std::uint64_t gap = std::min<std::uint64_t>(offset - written, sizeof(padding));
+            out.write(padding, static_cast<std::streamsize>(gap));
+            written += gap;
+        }
+    };
+
+    // Raw byte buffer: T need not be default constructible.
+    constexpr std::size_t chunk = 4096;
+    std::vector<unsigned char> buffer(chunk * sizeof(T));
+    std::vector<std::uint64_t> counts;
+    if constexpr (Policy::multiset) {
+        counts.reserve(nodes);
+    }
+    pad(header.keys_offset);
+    std::size_t fill = 0;
+    for (const Node* node = root ? minValueNode(root) : nullptr; node; node = nextNode(const_cast<Node*>(node))) {
+        std::memcpy(buffer.data() + fill * sizeof(T), std::addressof(node->key), sizeof(T));
+        if (++fill == chunk) {
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(fill * sizeof(T)));
+            fill = 0;
+        }
+        if constexpr (Policy::multiset) {
+            counts.push_back(node->repeat);
+        }
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(fill * sizeof(T)));
+    written += static_cast<std::uint64_t>(nodes) * sizeof(T);
+
+    if constexpr (Policy::multiset) {
+        pad(header.repeats_offset);
+        out.write(reinterpret_cast<const char*>(counts.data()), static_cast<std::streamsize>(counts.size() * sizeof(std::uint64_t)));
+    }
+    if (!out) {
+        throw std::runtime_error("AVLTree::save: write failed");
+    }
+}
+
+
+/***************************************
+ * load
+ *
+ * Replaces the contents with a tree written by save().
+ *
+ * Parameters:
+ *  - in: A stream opened in binary mode, positioned at the header.
+ *
+ * Behavior:
+ *  - Reads the key array into one buffer and builds a new tree from
+ *    it with the O(n) sorted bulk build, so no comparisons beyond one
+ *    check that the keys are strictly increasing. The new tree then
+ *    replaces the contents.
+ *  - A seekable stream is first measured against the size the header
+ *    claims; otherwise keys are read in bounded chunks, so a forged
+ *    count costs no more memory than the stream actually holds.
+ *  - Throws std::runtime_error for a header that does not match T,
+ *    a truncated stream, unsorted keys, or repeat counts when this tree
+ *    is not a multiset. The tree is left unchanged then, and also
+ *    when allocating the new tree fails.
+ *  - The comparator must order keys the way the saved tree's did.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::load(std::istream& in) {
+    static_assert(std::is_trivially_copyable<T>::value, "load() reads keys as raw bytes");
+    AVLFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("AVLTree file: truncated header");
+    }
+    header.validate(sizeof(T), alignof(T));
+    const bool hasRepeats = (header.flags & AVLFileHeader::has_repeats) != 0;
+    if (hasRepeats && !Policy::multiset) {
+        throw std::runtime_error("AVLTree file: holds repeat counts, which need a multiset policy");
+    }
+    if (header.node_count > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+        throw std::runtime_error("AVLTree file: too large for this platform");
+    }
+    const std::size_t n = static_cast<std::size_t>(header.node_count);
+    std::uint64_t offset = sizeof(header);
+    char skip[64];
+    auto seek = [&](std::uint64_t target) {
+        while (offset < target) {
+            const std::uint64_t gap = std::min<std::uint64_t>(target - offset, sizeof(skip));
+            if (!in.read(skip, static_cast<std::streamsize>(gap))) {
+                throw std::runtime_error("AVLTree file: truncated");
+            }
+            offset += gap;
+        }
+    };
+
+    // A seekable stream must hold every byte the header promises, so a
+    // bogus count fails here, before anything is allocated for it.
+    const std::streampos keysStart = in.tellg();
+    if (keysStart != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+        const std::streampos streamEnd = in.tellg();
+        if (!in.seekg(keysStart)) {
+            throw std::runtime_error("AVLTree file: truncated");
+        }
+        if (streamEnd != std::streampos(-1) &&
+            header.end_offset() - sizeof(header) > static_cast<std::uint64_t>(streamEnd - keysStart)) {
+            throw std::runtime_error("AVLTree file: truncated");
+        }
+    }
+    in.clear();
+
+    seek(header.keys_offset);
+    // Uninitialized storage, filled byte-wise: T need not be default
+    // constructible. It grows with the bytes actually read, so a
+    // stream that cannot be measured still only costs what it holds.
+    struct KeyBuffer {
+        std::allocator<T> alloc;
+        T* data = nullptr;
+        std::size_t capacity = 0;
+        ~KeyBuffer() {
+            if (data) {
+                alloc.deallocate(data, capacity);
+            }
+        }
+        void grow(std::size_t count, std::size_t used) {
+            T* bigger = alloc.allocate(count);
+            if (used) {
+                std::memcpy(static_cast<void*>(bigger), static_cast<const void*>(data), used * sizeof(T));
+            }
+            if (data) {
+                alloc.deallocate(data, capacity);
+            }
+            data = bigger;
+            capacity = count;
+        }
+        T* get() const {
+            return data;
+        }
+    } keys;
+    const std::size_t chunk = std::max<std::size_t>(1, (std::size_t(1) << 20) / sizeof(T));
+    for (std::size_t filled = 0; filled < n;) {
+        const std::size_t step = std::min(chunk, n - filled);
+        if (filled + step > keys.capacity) {
+            keys.grow(std::min(n, std::max(filled + step, 2 * keys.capacity)), filled);
+        }
+        if (!in.read(reinterpret_cast<char*>(keys.get() + filled), static_cast<std::streamsize>(step * sizeof(T)))) {
+            throw std::runtime_error("AVLTree file: truncated");
+        }
+        filled += step;
+    }
+    offset += static_cast<std::uint64_t>(n) * sizeof(T);
+    for (std::size_t i = 1; i < n; ++i) {
+        if (!keyLess(keys.get()[i - 1], keys.get()[i])) {
+            throw std::runtime_error("AVLTree file: keys are not strictly increasing");
+        }
+    }
+
+    std::vector<std::size_t> repeats;
+    if (hasRepeats) {
+        seek(header.repeats_offset);
+        std::vector<std::uint64_t> counts(n);
+        if (!in.read(reinterpret_cast<char*>(counts.data()), static_cast<std::streamsize>(n * sizeof(std::uint64_t)))) {
+            throw std::runtime_error("AVLTree file: truncated");
+        }
+        std::uint64_t total = 0;
+        for (std::uint64_t count : counts) {
+            if (count == 0 || count > header.key_count - total) {
+                throw std::runtime_error("AVLTree file: corrupt repeat counts");
+            }
+            total += count;
+        }
+        if (total != header.key_count) {
+            throw std::runtime_error("AVLTree file: corrupt repeat counts");
+        }
+        repeats.assign(counts.begin(), counts.end());
+    }
+    AVLTree loaded(comp, Allocator(node_alloc));
+    loaded.assignSorted(std::make_move_iterator(keys.get()), n, repeats.empty() ? nullptr : repeats.data());
+    swap(loaded);
+}
+
+
+/***************************************
+ * sortKeys (private helper)
+ *
+ * Stable-sorts a key buffer with the tree's comparator.
+ *
+ * Parameters:
+ *  - keys: The buffer to sort.
+ *  - threads: How many threads may be used.
+ *
+ * Behavior:
+ *  - Large buffers are cut into one chunk per thread, capped at one
+ *    chunk per parallel_sort_min keys and at the hardware thread count.
+ *    The chunks are sorted on std::async tasks and then merged
+ *    pairwise, each round of merges again running in parallel.
+ *    Equivalent keys keep their input order either way.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::sortKeys(std::vector<T>& keys, unsigned threads) const {
+    using KeyIt = typename std::vector<T>::iterator;
+    const Compare& less = comp;
+    const std::size_t n = keys.size();
+    if (threads <= 1 || n < parallel_sort_min) {
+        std::stable_sort(keys.begin(), keys.end(), less);
+        return;
+    }
+
+    // Each chunk gets its own thread, so never start more than the
+    // buffer is worth or the machine can run at once.
+    std::size_t chunks = std::min<std::size_t>(threads, n / parallel_sort_min);
+    const unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware != 0) {
+        chunks = std::min<std::size_t>(chunks, hardware);
+    }
+    std::vector<KeyIt> bounds;
+    bounds.reserve(chunks + 1);
+    for (std::size_t i = 0; i <= chunks; ++i) {
+        bounds.push_back(keys.begin() + static_cast<std::ptrdiff_t>(n * i / chunks));
+    }
+
+    std::vector<std::future<void> > tasks;
+    for (std::size_t i = 1; i < chunks; ++i) {
+        tasks.push_back(std::async(std::launch::async, [&less, first = bounds[i], last = bounds[i + 1]] {
+            std::stable_sort(first, last, less);
+        }));
+    }
+    std::stable_sort(bounds[0], bounds[1], less);
+    for (std::future<void>& task : tasks) {
+        task.get();
+    }
+
+    for (std::size_t width = 1; width < chunks; width *= 2) {
+        tasks.clear();
+        for (std::size_t i = 0; i + width < chunks; i += 2 * width) {
+            KeyIt first = bounds[i];
+            KeyIt middle = bounds[i + width];
+            KeyIt last = bounds[std::min(i + 2 * width, chunks)];
+            tasks.push_back(std::async(std::launch::async, [&less, first, middle, last] {
+                std::inplace_merge(first, middle, last, less);
+            }));
+        }
+        for (std::future<void>& task : tasks) {
+            task.get();
+        }
+    }
+}
+
+
+/***************************************
+ * foldRuns (private helper)
+ *
+ * Collapses runs of equivalent keys in a sorted buffer.
+ *
+ * Parameters:
+ *  - keys: A sorted buffer; compacted in place to one key per run.
+ *  - repeats: For a multiset, receives each run's length; otherwise
+ *    left empty.
+ *
+ * Behavior:
+ *  - The first key of each run is kept, matching repeated insert().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::foldRuns(std::vector<T>& keys, std::vector<std::size_t>& repeats) const {
+    if constexpr (Policy::multiset) {
+        typename std::vector<T>::iterator out = keys.begin();
+        for (typename std::vector<T>::iterator in = keys.begin(); in != keys.end(); ) {
+            typename std::vector<T>::iterator run = in + 1;
+            while (run != keys.end() && !keyLess(*in, *run)) {
+                ++run;
+            }
+            repeats.push_back(static_cast<std::size_t>(run - in));
+            if (out != in) {
+                *out = std::move(*in);
+            }
+            ++out;
+            in = run;
+        }
+        keys.erase(out, keys.end());
+    }
+    else {
+        (void)repeats;
+        typename std::vector<T>::iterator end = std::unique(keys.begin(), keys.end(),
+            [this](const T& a, const T& b) { return !keyLess(a, b); });
+        keys.erase(end, keys.end());
+    }
+}
+
+
+/***************************************
+ * linkBalanced (private helper)
+ *
+ * Links an in-order array of detached nodes into a perfectly
+ * balanced subtree.
+ *
+ * Parameters:
+ *  - nodes: The nodes in key order.
+ *  - n: How many there are.
+ *
+ * Returns:
+ *  - Root of the subtree with parent set to nullptr.
+ *
+ * Behavior:
+ *  - O(n); nothing is allocated and no key is moved.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::linkBalanced(Node* const* nodes, std::size_t n) {
+    if (n == 0) {
+        return nullptr;
+    }
+    const std::size_t leftCount = (n - 1) / 2;
+    Node* node = nodes[leftCount];
+    attachChildren(node, linkBalanced(nodes, leftCount), linkBalanced(nodes + leftCount + 1, n - 1 - leftCount));
+    node->parent = nullptr;
+    return node;
+}
+
+
+/***************************************
+ * empty
+ *
+ * Checks if the AVL tree is empty.
+ *
+ * Returns:
+ *  - true if the tree has no nodes; otherwise false.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+bool AVLTree<T, Compare, Allocator, Policy>::empty() const {
+    return tree_size == 0;
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns the number of elements in the AVL tree.
+ *
+ * Returns:
+ *  - The tree's size.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::size() const {
+    return tree_size;
+}
+
+
+/***************************************
+ * insert (public interface)
+ *
+ * Inserts a key into the AVL tree.
+ *
+ * Parameters:
+ *  - key: The key to insert.
+ *
+ * Returns:
+ *  - An iterator to the element with this key and true if it was
+ *    inserted, false if an equivalent key was already present.
+ *
+ * Behavior:
+ *  - Descends iteratively to the attachment point.
+ *  - Duplicate keys are not inserted, except that a multiset counts
+ *    them on the existing node and returns the new last copy.
+ *  - Links a new leaf and retraces towards the root.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::iterator, bool> AVLTree<T, Compare, Allocator, Policy>::insert(const T& key) {
+    std::pair<Node*, bool> result = insertUnique(key);
+    return std::make_pair(lastCopyOf(result.first), result.second);
+}
+
+
+/***************************************
+ * insert (move)
+ *
+ * Inserts a key into the AVL tree, moving it into the node.
+ *
+ * Parameters:
+ *  - key: The key to insert; left untouched if a duplicate exists.
+ *
+ * Returns:
+ *  - Same as insert(const T&).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::iterator, bool> AVLTree<T, Compare, Allocator, Policy>::insert(T&& key) {
+    std::pair<Node*, bool> result = insertUnique(std::move(key));
+    return std::make_pair(lastCopyOf(result.first), result.second);
+}
+
+
+/***************************************
+ * emplace
+ *
+ * Constructs a key in place and inserts it.
+ *
+ * Parameters:
+ *  - args: Arguments forwarded to T's constructor.
+ *
+ * Returns:
+ *  - Same as insert(const T&).
+ *
+ * Behavior:
+ *  - A single argument of type T is compared directly, so the node is
+ *    only built once the slot is known to be free.
+ *  - Otherwise the key is constructed inside a new node first (it is
+ *    needed for the comparisons) and the node is freed if a duplicate
+ *    turns up.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename... Args>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::iterator, bool> AVLTree<T, Compare, Allocator, Policy>::emplace(Args&&... args) {
+    using First = typename std::decay<typename std::tuple_element<0, std::tuple<Args..., void> >::type>::type;
+    if constexpr (sizeof...(Args) == 1 && std::is_same<First, T>::value) {
+        std::pair<Node*, bool> result = insertUnique(std::forward<Args>(args)...);
+        return std::make_pair(lastCopyOf(result.first), result.second);
+    }
+    else {
+        Node* node = createNode(nullptr, std::forward<Args>(args)...);
+        Node* parent;
+        bool goLeft;
+        Node* existing = findInsertPosition(node->key, parent, goLeft);
+        if (existing) {
+            destroyNode(node);
+            if constexpr (Policy::multiset) {
+                addRepeat(existing);
+                return std::make_pair(lastCopyOf(existing), true);
+            }
+            return std::make_pair(iterator(existing, this), false);
+        }
+        linkNode(node, parent, goLeft);
+        return std::make_pair(iterator(node, this), true);
+    }
+}
+
+
+/***************************************
+ * findHintPosition (private helper)
+ *
+ * Locates the slot for a key using a position hint.
+ *
+ * Parameters:
+ *  - hint: The node the key is expected to precede, or nullptr for end().
+ *  - key: The key being inserted.
+ *  - parent: Receives the node the new leaf would hang from.
+ *  - goLeft: Receives whether the leaf would be parent's left child.
+ *
+ * Returns:
+ *  - The node holding an equivalent key, or nullptr if the slot is free.
+ *
+ * Behavior:
+ *  - If key belongs immediately before hint (or hint itself is an
+ *    equivalent key) the slot is found next to hint in amortized O(1).
+ *  - A wrong hint falls back to the regular descent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::findHintPosition(Node* hint, const T& key, Node*& parent, bool& goLeft) const {
+    if (!hint) {
+        // end(): only a new maximum can use the hint, which the
+        // rightmost fast path in findInsertPosition already covers.
+        return findInsertPosition(key, parent, goLeft);
+    }
+    if (keyLess(key, hint->key)) {
+        Node* before = prevNode(hint);
+        if (!before || keyLess(before->key, key)) {
+            // The slot is either hint's empty left child or the empty
+            // right child of its predecessor.
+            if (!hint->left) {
+                parent = hint;
+                goLeft = true;
+            }
+            else {
+                parent = before;
+                goLeft = false;
+            }
+            return nullptr;
+        }
+    }
+    else if (keyLess(hint->key, key)) {
+        Node* after = nextNode(hint);
+        if (!after || keyLess(key, after->key)) {
+            if (!hint->right) {
+                parent = hint;
+                goLeft = false;
+            }
+            else {
+                parent = after;
+                goLeft = true;
+            }
+            return nullptr;
+        }
+    }
+    else {
+        return hint;
+    }
+    return findInsertPosition(key, parent, goLeft);
+}
+
+
+/***************************************
+ * insert (hinted)
+ *
+ * Inserts a key, using hint as a suggestion for where it belongs.
+ *
+ * Parameters:
+ *  - hint: Iterator to the element the key should precede.
+ *  - key: The key to insert.
+ *
+ * Returns:
+ *  - An iterator to the inserted key or to the equivalent key that
+ *    prevented insertion.
+ *
+ * Behavior:
+ *  - Same semantics as std::set::insert(hint, value): amortized O(1)
+ *    when the hint is right, O(log n) otherwise.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::insert(const_iterator hint, const T& key) {
+    Node* parent;
+    bool goLeft;
+    Node* existing = findHintPosition(const_cast<Node*>(hint.current), key, parent, goLeft);
+    if (existing) {
+        if constexpr (Policy::multiset) {
+            addRepeat(existing);
+        }
+        return lastCopyOf(existing);
+    }
+    Node* node = createNode(parent, key);
+    linkNode(node, parent, goLeft);
+    return iterator(node, this);
+}
+
+
+/***************************************
+ * insert (hinted, move)
+ *
+ * Inserts a key using a hint, moving it into the node.
+ *
+ * Parameters:
+ *  - hint: Iterator to the element the key should precede.
+ *  - key: The key to insert; left untouched if a duplicate exists.
+ *
+ * Returns:
+ *  - Same as insert(const_iterator, const T&).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::insert(const_iterator hint, T&& key) {
+    Node* parent;
+    bool goLeft;
+    Node* existing = findHintPosition(const_cast<Node*>(hint.current), key, parent, goLeft);
+    if (existing) {
+        if constexpr (Policy::multiset) {
+            addRepeat(existing);
+        }
+        return lastCopyOf(existing);
+    }
+    Node* node = createNode(parent, std::move(key));
+    linkNode(node, parent, goLeft);
+    return iterator(node, this);
+}
+
+
+/***************************************
+ * emplace_hint
+ *
+ * Constructs a key in place and inserts it using a hint.
+ *
+ * Parameters:
+ *  - hint: Iterator to the element the key should precede.
+ *  - args: Arguments forwarded to T's constructor.
+ *
+ * Returns:
+ *  - Same as insert(const_iterator, const T&).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename... Args>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::emplace_hint(const_iterator hint, Args&&... args) {
+    using First = typename std::decay<typename std::tuple_element<0, std::tuple<Args..., void> >::type>::type;
+    if constexpr (sizeof...(Args) == 1 && std::is_same<First, T>::value) {
+        return insert(hint, std::forward<Args>(args)...);
+    }
+    else {
+        Node* node = createNode(nullptr, std::forward<Args>(args)...);
+        Node* parent;
+        bool goLeft;
+        Node* existing = findHintPosition(const_cast<Node*>(hint.current), node->key, parent, goLeft);
+        if (existing) {
+            destroyNode(node);
+            if constexpr (Policy::multiset) {
+                addRepeat(existing);
+            }
+            return lastCopyOf(existing);
+        }
+        linkNode(node, parent, goLeft);
+        return iterator(node, this);
+    }
+}
+
+
+/***************************************
+ * erase
+ *
+ * Erases a key from the AVL tree.
+ *
+ * Parameters:
+ *  - key: The key to erase.
+ *
+ * Behavior:
+ *  - Locates the node and hands it to eraseNode; absent keys are ignored.
+ *  - For a multiset every copy of the key is removed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::erase(const T& key) {
+    Node* node = findNode(key);
+    if (node) {
+        eraseNode(node);
+    }
+}
+
+
+/***************************************
+ * erase_one
+ *
+ * Removes a single copy of a key.
+ *
+ * Parameters:
+ *  - key: The key to remove.
+ *
+ * Returns:
+ *  - true if a copy was removed, false if the key was absent.
+ *
+ * Behavior:
+ *  - O(log n). For a multiset with further copies left only the
+ *    repeat count drops; the node stays linked.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+bool AVLTree<T, Compare, Allocator, Policy>::erase_one(const T& key) {
+    Node* node = findNode(key);
+    if (!node) {
+        return false;
+    }
+    eraseOne(node);
+    return true;
+}
+
+
+/***************************************
+ * erase (iterator)
+ *
+ * Removes the key at pos.
+ *
+ * Parameters:
+ *  - pos: A valid, dereferenceable iterator into this tree.
+ *
+ * Returns:
+ *  - An iterator to the key that followed pos, or end().
+ *
+ * Behavior:
+ *  - No search: the node is unlinked where it is, and a node with two
+ *    children is replaced by relinking its successor node, so no key is
+ *    copied or moved and iterators to every other key stay valid.
+ *  - Finding the successor is amortized O(1); the unlink costs the
+ *    O(log n) retrace.
+ *  - For a multiset, one copy is removed; the copies after it shift
+ *    down one offset, so the result is pos itself unless pos was the
+ *    node's last copy.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::erase(const_iterator pos) {
+    Node* node = nodeOf(pos);
+    if constexpr (Policy::multiset) {
+        if (node->repeat > 1) {
+            removeRepeats(node, 1);
+            if (pos.offset < node->repeat) {
+                return iterator(node, this, pos.offset);
+            }
+            return iterator(nextNode(node), this);
+        }
+    }
+    Node* next = nextNode(node);
+    eraseNode(node);
+    return iterator(next, this);
+}
+
+
+/***************************************
+ * erase (iterator range)
+ *
+ * Removes the keys in [first, last).
+ *
+ * Parameters:
+ *  - first, last: A valid range of this tree; last may be end().
+ *
+ * Returns:
+ *  - An iterator to the key last referred to, or end().
+ *
+ * Behavior:
+ *  - Cuts the range out with two splits and one join, O(log n), then
+ *    frees its k nodes: O(log n + k) with no per-key descent or
+ *    rebalancing. Iterators outside the range stay valid.
+ *  - For a multiset, copies of a node that straddles either end are
+ *    removed by lowering its repeat count.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::erase(const_iterator first, const_iterator last) {
+    Node* from = nodeOf(first);
+    Node* to = nodeOf(last);
+    if (first == last) {
+        return iterator(to, this, last.copyOffset());
+    }
+    if constexpr (Policy::multiset) {
+        if (from == to) {
+            removeRepeats(from, last.offset - first.offset);
+            return iterator(to, this, first.offset);
+        }
+        if (first.offset > 0) {
+            removeRepeats(from, from->repeat - first.offset);
+            from = nextNode(from);
+        }
+        if (last.offset > 0) {
+            removeRepeats(to, last.offset);
+        }
+    }
+    if (from != to) {
+        eraseBetween(&from->key, to ? &to->key : nullptr);
+    }
+    return iterator(to, this);
+}
+
+
+/***************************************
+ * erase_range
+ *
+ * Removes every key k with lo <= k < hi.
+ *
+ * Parameters:
+ *  - lo: Inclusive lower bound.
+ *  - hi: Exclusive upper bound.
+ *
+ * Returns:
+ *  - The number of keys removed, counting multiset copies; 0 if
+ *    hi <= lo.
+ *
+ * Behavior:
+ *  - Same cost as erase(first, last), without first locating the
+ *    ends: O(log n + k).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::erase_range(const T& lo, const T& hi) {
+    if (!keyLess(lo, hi)) {
+        return 0;
+    }
+    return eraseBetween(&lo, &hi);
+}
+
+
+/***************************************
+ * node_type Move Constructor
+ *
+ * Takes over another handle's node and allocator.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::node_type::node_type(node_type&& other) noexcept
+    : node(other.node), alloc(std::move(other.alloc)) {
+    other.node = nullptr;
+    other.alloc.reset();
+}
+
+
+/***************************************
+ * node_type Move Assignment
+ *
+ * Frees the node currently held, then takes over other's.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::node_type& AVLTree<T, Compare, Allocator, Policy>::node_type::operator=(node_type&& other) noexcept {
+    if (this != &other) {
+        if (node) {
+            NodeAllocTraits::destroy(*alloc, node);
+            NodeAllocTraits::deallocate(*alloc, node, 1);
+        }
+        node = other.node;
+        alloc = std::move(other.alloc);
+        other.node = nullptr;
+        other.alloc.reset();
+    }
+    return *this;
+}
+
+
+/***************************************
+ * node_type Destructor
+ *
+ * Destroys the held node, if any, with the allocator that made it.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy>::node_type::~node_type() {
+    if (node) {
+        NodeAllocTraits::destroy(*alloc, node);
+        NodeAllocTraits::deallocate(*alloc, node, 1);
+    }
+}
+
+
+/***************************************
+ * node_type::release (private helper)
+ *
+ * Gives up ownership of the node.
+ *
+ * Returns:
+ *  - The node; the handle is left empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::node_type::release() {
+    Node* n = node;
+    node = nullptr;
+    alloc.reset();
+    return n;
+}
+
+
+/***************************************
+ * node_type::swap
+ *
+ * Exchanges the nodes and allocators of two handles.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::node_type::swap(node_type& other) noexcept {
+    std::swap(node, other.node);
+    alloc.swap(other.alloc);
+}
+
+
+/***************************************
+ * adoptNode (private helper)
+ *
+ * Links the node held by a handle at a free slot.
+ *
+ * Parameters:
+ *  - nh: A non-empty handle.
+ *  - parent, goLeft: The free slot, as found by findInsertPosition.
+ *
+ * Returns:
+ *  - The node now linked into this tree.
+ *
+ * Behavior:
+ *  - If the handle's allocator equals ours the node itself is relinked:
+ *    no allocation, no key copy, and nh is left empty.
+ *  - Otherwise the key is moved into a node from our allocator and nh
+ *    keeps the old node, which it frees when destroyed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::adoptNode(node_type& nh, Node* parent, bool goLeft) {
+    bool sameAllocator = true;
+    if constexpr (!NodeAllocTraits::is_always_equal::value) {
+        sameAllocator = *nh.alloc == node_alloc;
+    }
+    Node* node;
+    if (sameAllocator) {
+        node = nh.release();
+        resetLinks(node);
+    }
+    else {
+        node = createNode(parent, std::move(nh.node->key));
+        if constexpr (Policy::multiset) {
+            node->repeat = nh.node->repeat;
+            if constexpr (Policy::order_statistics) {
+                node->count = node->repeat;
+            }
+        }
+    }
+    linkNode(node, parent, goLeft);
+    return node;
+}
+
+
+/***************************************
+ * extract (iterator)
+ *
+ * Unlinks the node at pos and hands it over without freeing it.
+ *
+ * Parameters:
+ *  - pos: A valid, dereferenceable iterator into this tree.
+ *
+ * Returns:
+ *  - A handle owning the node.
+ *
+ * Behavior:
+ *  - O(log n) rebalancing; iterators to other elements stay valid.
+ *  - A multiset node is extracted with all of its copies.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::node_type AVLTree<T, Compare, Allocator, Policy>::extract(const_iterator pos) {
+    Node* node = nodeOf(pos);
+    unlinkNode(node);
+    return node_type(node, node_alloc);
+}
+
+
+/***************************************
+ * extract (key)
+ *
+ * Unlinks the node holding key, if any.
+ *
+ * Parameters:
+ *  - key: The key to extract.
+ *
+ * Returns:
+ *  - A handle owning the node, or an empty handle if key is absent.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::node_type AVLTree<T, Compare, Allocator, Policy>::extract(const T& key) {
+    Node* node = findNode(key);
+    if (!node) {
+        return node_type();
+    }
+    unlinkNode(node);
+    return node_type(node, node_alloc);
+}
+
+
+/***************************************
+ * insert (node handle)
+ *
+ * Links an extracted node into this tree.
+ *
+ * Parameters:
+ *  - nh: The handle to insert; may be empty.
+ *
+ * Returns:
+ *  - position: The element with the handle's key, or end() for an
+ *    empty handle.
+ *  - inserted: Whether the node was linked.
+ *  - node: The handle itself if an equivalent key blocked insertion,
+ *    otherwise empty.
+ *
+ * Behavior:
+ *  - One descent and no allocation when the allocators compare equal.
+ *  - A multiset adds the handle's copies to an existing equivalent
+ *    node and frees the handle's node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::insert_return_type AVLTree<T, Compare, Allocator, Policy>::insert(node_type&& nh) {
+    if (nh.empty()) {
+        return insert_return_type{end(), false, node_type()};
+    }
+    Node* parent;
+    bool goLeft;
+    Node* existing = findInsertPosition(nh.node->key, parent, goLeft);
+    if (existing) {
+        if constexpr (Policy::multiset) {
+            addRepeat(existing, nh.node->repeat);
+            node_type discard(std::move(nh));
+            return insert_return_type{lastCopyOf(existing), true, node_type()};
+        }
+        return insert_return_type{iterator(existing, this), false, std::move(nh)};
+    }
+    node_type source(std::move(nh));
+    Node* node = adoptNode(source, parent, goLeft);
+    return insert_return_type{lastCopyOf(node), true, node_type()};
+}
+
+
+/***************************************
+ * insert (hinted node handle)
+ *
+ * Links an extracted node using a position hint.
+ *
+ * Parameters:
+ *  - hint: Iterator to the element the key should precede.
+ *  - nh: The handle to insert; may be empty.
+ *
+ * Returns:
+ *  - An iterator to the inserted element, to the equivalent element
+ *    that blocked insertion (nh keeps its node), or end() if nh is
+ *    empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::insert(const_iterator hint, node_type&& nh) {
+    if (nh.empty()) {
+        return end();
+    }
+    Node* parent;
+    bool goLeft;
+    Node* existing = findHintPosition(nodeOf(hint), nh.node->key, parent, goLeft);
+    if (existing) {
+        if constexpr (Policy::multiset) {
+            addRepeat(existing, nh.node->repeat);
+            node_type discard(std::move(nh));
+            return lastCopyOf(existing);
+        }
+        return iterator(existing, this);
+    }
+    node_type source(std::move(nh));
+    return lastCopyOf(adoptNode(source, parent, goLeft));
+}
+
+
+/***************************************
+ * merge
+ *
+ * Moves every element of source whose key is not already present
+ * into this tree.
+ *
+ * Parameters:
+ *  - source: The tree to take nodes from.
+ *
+ * Behavior:
+ *  - Nodes are relinked, not reallocated, when the allocators compare
+ *    equal; keys are never copied. O(m log(n + m)).
+ *  - Elements whose key is already present stay in source, except
+ *    that a multiset takes every element.
+ *  - Merging a tree into itself does nothing.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::merge(AVLTree& source) {
+    if (&source == this) {
+        return;
+    }
+    Node* n = source.leftmost;
+    while (n) {
+        Node* next = nextNode(n);
+        Node* parent;
+        bool goLeft;
+        Node* existing = findInsertPosition(n->key, parent, goLeft);
+        if (existing && !Policy::multiset) {
+            n = next;
+            continue;
+        }
+        source.unlinkNode(n);
+        node_type nh(n, source.node_alloc);
+        if (existing) {
+            // Multiset: fold the copies into our node; nh frees n.
+            addRepeat(existing, repeatCount(n));
+        }
+        else {
+            adoptNode(nh, parent, goLeft);
+        }
+        n = next;
+    }
+}
+
+
+/***************************************
+ * merge (rvalue)
+ *
+ * Same as merge(AVLTree&).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::merge(AVLTree&& source) {
+    merge(source);
+}
+
+
+/***************************************
+ * attachChildren (private helper)
+ *
+ * Makes left and right the children of node and refreshes it.
+ *
+ * Parameters:
+ *  - node: The new subtree root.
+ *  - left, right: Its children; either may be nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::attachChildren(Node* node, Node* left, Node* right) {
+    node->left = left;
+    node->right = right;
+    if (left) {
+        left->parent = node;
+    }
+    if (right) {
+        right->parent = node;
+    }
+    updateNode(node);
+}
+
+
+/***************************************
+ * joinRight (private helper)
+ *
+ * Joins subtrees whose heights differ by more than one, with the
+ * left one taller.
+ *
+ * Parameters:
+ *  - left: The taller subtree; every key is less than pivot's.
+ *  - pivot: A detached node.
+ *  - right: The shorter subtree; every key is greater than pivot's.
+ *
+ * Returns:
+ *  - Root of the joined subtree (its parent pointer is not set).
+ *
+ * Behavior:
+ *  - Descends left's right spine to the first subtree no more than one
+ *    level taller than right, hangs pivot there and rebalances on the
+ *    way back with the existing rotations. O(height difference).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::joinRight(Node* left, Node* pivot, Node* right) {
+    Node* spine = left->right;
+    if (height(spine) <= height(right) + 1) {
+        attachChildren(pivot, spine, right);
+        left->right = pivot;
+        pivot->parent = left;
+        if (height(pivot) > height(left->left) + 1) {
+            left->right = rightRotate(pivot);
+            updateNode(left);
+            this->countRotation(true);
+            return leftRotate(left);
+        }
+        updateNode(left);
+        return left;
+    }
+    Node* joined = joinRight(spine, pivot, right);
+    left->right = joined;
+    joined->parent = left;
+    updateNode(left);
+    if (height(joined) > height(left->left) + 1) {
+        this->countRotation(false);
+        return leftRotate(left);
+    }
+    return left;
+}
+
+
+/***************************************
+ * joinLeft (private helper)
+ *
+ * Mirror image of joinRight for a taller right subtree.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::joinLeft(Node* left, Node* pivot, Node* right) {
+    Node* spine = right->left;
+    if (height(spine) <= height(left) + 1) {
+        attachChildren(pivot, left, spine);
+        right->left = pivot;
+        pivot->parent = right;
+        if (height(pivot) > height(right->right) + 1) {
+            right->left = leftRotate(pivot);
+            updateNode(right);
+            this->countRotation(true);
+            return rightRotate(right);
+        }
+        updateNode(right);
+        return right;
+    }
+    Node* joined = joinLeft(left, pivot, spine);
+    right->left = joined;
+    joined->parent = right;
+    updateNode(right);
+    if (height(joined) > height(right->right) + 1) {
+        this->countRotation(false);
+        return rightRotate(right);
+    }
+    return right;
+}
+
+
+/***************************************
+ * joinNodes (private helper)
+ *
+ * Joins two AVL subtrees around a pivot node.
+ *
+ * Parameters:
+ *  - left: Subtree of keys less than pivot's; may be nullptr.
+ *  - pivot: A detached node.
+ *  - right: Subtree of keys greater than pivot's; may be nullptr.
+ *
+ * Returns:
+ *  - Root of the joined subtree, with its parent set to nullptr.
+ *
+ * Behavior:
+ *  - O(|height(left) - height(right)| + 1).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::joinNodes(Node* left, Node* pivot, Node* right) {
+    Node* joined;
+    if (height(left) > height(right) + 1) {
+        joined = joinRight(left, pivot, right);
+    }
+    else if (height(right) > height(left) + 1) {
+        joined = joinLeft(left, pivot, right);
+    }
+    else {
+        attachChildren(pivot, left, right);
+        joined = pivot;
+    }
+    joined->parent = nullptr;
+    return joined;
+}
+
+
+/***************************************
+ * splitLast (private helper)
+ *
+ * Detaches the largest node of a subtree.
+ *
+ * Parameters:
+ *  - node: Root of a non-empty subtree.
+ *  - rest: Receives the root of the remaining keys (parent nullptr).
+ *
+ * Returns:
+ *  - The detached node.
+ *
+ * Behavior:
+ *  - Rejoins the right spine on the way back up; O(log n).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::splitLast(Node* node, Node*& rest) {
+    if (!node->right) {
+        rest = node->left;
+        if (rest) {
+            rest->parent = nullptr;
+        }
+        return node;
+    }
+    Node* subtree;
+    Node* last = splitLast(node->right, subtree);
+    rest = joinNodes(node->left, node, subtree);
+    return last;
+}
+
+
+/***************************************
+ * splitNodes (private helper)
+ *
+ * Splits a subtree around a key.
+ *
+ * Parameters:
+ *  - node: Root of the subtree; may be nullptr.
+ *  - key: The split key.
+ *  - less: Receives the keys less than key.
+ *  - rest: Receives the keys not less than key.
+ *
+ * Behavior:
+ *  - Each node on the search path becomes the pivot of a join with
+ *    the pieces below it; the joins telescope to O(log n) in total.
+ *  - Both results have their parent pointers set to nullptr.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::splitNodes(Node* node, const T& key, Node*& less, Node*& rest) {
+    if (!node) {
+        less = nullptr;
+        rest = nullptr;
+        return;
+    }
+    Node* left = node->left;
+    Node* right = node->right;
+    if (keyLess(node->key, key)) {
+        Node* lower;
+        splitNodes(right, key, lower, rest);
+        less = joinNodes(left, node, lower);
+    }
+    else {
+        Node* upper;
+        splitNodes(left, key, less, upper);
+        rest = joinNodes(upper, node, right);
+    }
+}
+
+
+/***************************************
+ * sizeOfFirst (private helper)
+ *
+ * Counts the keys of the first of two subtrees that together hold
+ * total keys, without subtree counts.
+ *
+ * Parameters:
+ *  - first, second: Roots of detached subtrees; either may be nullptr.
+ *  - total: Number of keys in both.
+ *
+ * Returns:
+ *  - The number of keys in first.
+ *
+ * Behavior:
+ *  - Walks both subtrees in lockstep and stops when either runs out,
+ *    so only about twice the smaller one is visited.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::sizeOfFirst(Node* first, Node* second, std::size_t total) {
+    Node* a = first;
+    Node* b = second;
+    while (a && a->left) {
+        a = a->left;
+    }
+    while (b && b->left) {
+        b = b->left;
+    }
+    std::size_t countA = 0;
+    std::size_t countB = 0;
+    while (a && b) {
+        countA += repeatCount(a);
+        countB += repeatCount(b);
+        a = nextNode(a);
+        b = nextNode(b);
+    }
+    return a ? total - countB : countA;
+}
+
+
+/***************************************
+ * checkJoinable (private helper)
+ *
+ * Validates the preconditions of join() in O(1).
+ *
+ * Parameters:
+ *  - left, right: The trees to join.
+ *  - pivot: The pivot key, or nullptr when joining without one.
+ *
+ * Behavior:
+ *  - Throws std::invalid_argument if left's largest key is not less
+ *    than the pivot (or right's smallest key), if the pivot is not less
+ *    than right's smallest key, or if the trees' allocators differ and
+ *    so could not free each other's nodes.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::checkJoinable(const AVLTree& left, const T* pivot, const AVLTree& right) {
+    const Compare& comp = left.comp;
+    if (pivot) {
+        if ((left.rightmost && !comp(left.rightmost->key, *pivot)) ||
+            (right.leftmost && !comp(*pivot, right.leftmost->key))) {
+            throw std::invalid_argument("AVLTree::join: keys are not in order");
+        }
+    }
+    else if (left.rightmost && right.leftmost && !comp(left.rightmost->key, right.leftmost->key)) {
+        throw std::invalid_argument("AVLTree::join: keys are not in order");
+    }
+    if (right.root && !sameAllocator(left, right)) {
+        throw std::invalid_argument("AVLTree::join: allocators differ");
+    }
+}
+
+
+/***************************************
+ * sameAllocator (private helper)
+ *
+ * Returns true if nodes allocated by one tree may be freed by the
+ * other, so the two can exchange nodes.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+bool AVLTree<T, Compare, Allocator, Policy>::sameAllocator(const AVLTree& a, const AVLTree& b) {
+    if constexpr (NodeAllocTraits::is_always_equal::value) {
+        (void)a;
+        (void)b;
+        return true;
+    }
+    else {
+        return a.node_alloc == b.node_alloc;
+    }
+}
+
+
+/***************************************
+ * joinTrees (private helper)
+ *
+ * Builds the result of join() from two checked trees and a pivot.
+ *
+ * Parameters:
+ *  - left: Tree of smaller keys; emptied.
+ *  - pivot: A detached node owned by left's allocator.
+ *  - right: Tree of larger keys; emptied.
+ *
+ * Returns:
+ *  - The joined tree, which takes over left's comparator and allocator.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::joinTrees(AVLTree& left, Node* pivot, AVLTree& right) {
+    AVLTree result(std::move(left));
+    Node* rightRoot = right.root;
+    Node* rightMax = right.rightmost;
+    std::size_t rightSize = right.tree_size;
+    right.root = nullptr;
+    right.leftmost = nullptr;
+    right.rightmost = nullptr;
+    right.tree_size = 0;
+
+    if (!result.root) {
+        result.leftmost = pivot;
+    }
+    result.rightmost = rightRoot ? rightMax : pivot;
+    result.tree_size += repeatCount(pivot) + rightSize;
+    result.root = result.joinNodes(result.root, pivot, rightRoot);
+    return result;
+}
+
+
+/***************************************
+ * join (with pivot)
+ *
+ * Concatenates two trees around a new pivot key.
+ *
+ * Parameters:
+ *  - left: Tree whose keys are all less than pivot; emptied.
+ *  - pivot: The key placed between them.
+ *  - right: Tree whose keys are all greater than pivot; emptied.
+ *
+ * Returns:
+ *  - A tree holding every key of left, pivot and every key of right.
+ *
+ * Behavior:
+ *  - O(|height(left) - height(right)| + 1) using the height-difference
+ *    join; only the pivot node is allocated.
+ *  - Throws std::invalid_argument if the keys are out of order or the
+ *    allocators differ (see checkJoinable).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::join(AVLTree&& left, const T& pivot, AVLTree&& right) {
+    checkJoinable(left, &pivot, right);
+    return joinTrees(left, left.createNode(nullptr, pivot), right);
+}
+
+
+/***************************************
+ * join (with pivot, move)
+ *
+ * Same as join(AVLTree&&, const T&, AVLTree&&), moving the pivot
+ * into its node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::join(AVLTree&& left, T&& pivot, AVLTree&& right) {
+    checkJoinable(left, &pivot, right);
+    return joinTrees(left, left.createNode(nullptr, std::move(pivot)), right);
+}
+
+
+/***************************************
+ * join (concatenation)
+ *
+ * Concatenates two trees whose key ranges do not overlap.
+ *
+ * Parameters:
+ *  - left: Tree whose keys are all less than right's; emptied.
+ *  - right: Tree of the larger keys; emptied.
+ *
+ * Returns:
+ *  - A tree holding every key of both.
+ *
+ * Behavior:
+ *  - O(log n): left's largest node is split off and reused as the
+ *    pivot, so nothing is allocated.
+ *  - Throws std::invalid_argument as join(left, pivot, right) does.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::join(AVLTree&& left, AVLTree&& right) {
+    checkJoinable(left, nullptr, right);
+    if (!left.root) {
+        return AVLTree(std::move(right));
+    }
+    if (!right.root) {
+        return AVLTree(std::move(left));
+    }
+    Node* rest;
+    Node* pivot = left.splitLast(left.root, rest);
+    left.root = rest;
+    left.tree_size -= repeatCount(pivot);
+    if (!rest) {
+        left.leftmost = nullptr;
+    }
+    return joinTrees(left, pivot, right);
+}
+
+
+/***************************************
+ * split
+ *
+ * Partitions the tree at a key.
+ *
+ * Parameters:
+ *  - key: The cut-off key; it need not be present.
+ *
+ * Returns:
+ *  - first: A tree of the keys less than key.
+ *  - second: A tree of the keys not less than key.
+ *
+ * Behavior:
+ *  - This tree is left empty; both results share its comparator and
+ *    allocator. No node is allocated, copied or freed.
+ *  - The restructuring is O(log n). With order statistics the halves'
+ *    sizes are read off the roots; otherwise they are counted by a
+ *    lockstep walk costing O(min(|first|, |second|)).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::pair<AVLTree<T, Compare, Allocator, Policy>, AVLTree<T, Compare, Allocator, Policy> > AVLTree<T, Compare, Allocator, Policy>::split(const T& key) {
+    const Allocator alloc(node_alloc);
+    std::pair<AVLTree, AVLTree> result(AVLTree(comp, alloc), AVLTree(comp, alloc));
+    AVLTree& lo = result.first;
+    AVLTree& hi = result.second;
+
+    Node* oldMin = leftmost;
+    Node* oldMax = rightmost;
+    std::size_t total = tree_size;
+    Node* less;
+    Node* rest;
+    splitNodes(root, key, less, rest);
+    root = nullptr;
+    leftmost = nullptr;
+    rightmost = nullptr;
+    tree_size = 0;
+
+    lo.root = less;
+    hi.root = rest;
+    if (less) {
+        lo.leftmost = oldMin;
+        lo.rightmost = maxValueNode(less);
+    }
+    if (rest) {
+        hi.leftmost = minValueNode(rest);
+        hi.rightmost = oldMax;
+    }
+    if constexpr (Policy::order_statistics) {
+        lo.tree_size = subtreeCount(less);
+    }
+    else {
+        lo.tree_size = sizeOfFirst(less, rest, total);
+    }
+    hi.tree_size = total - lo.tree_size;
+    return result;
+}
+
+
+/***************************************
+ * joinTwo (private helper)
+ *
+ * Concatenates two detached subtrees without a pivot.
+ *
+ * Parameters:
+ *  - left: Subtree of the smaller keys; may be nullptr.
+ *  - right: Subtree of the larger keys; may be nullptr.
+ *
+ * Returns:
+ *  - Root of the joined subtree; O(log n).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::joinTwo(Node* left, Node* right) {
+    if (!left) {
+        return right;
+    }
+    if (!right) {
+        return left;
+    }
+    Node* rest;
+    Node* pivot = splitLast(left, rest);
+    return joinNodes(rest, pivot, right);
+}
+
+
+/***************************************
+ * eraseBetween (private helper)
+ *
+ * Frees the nodes whose keys lie in [*lo, *hi).
+ *
+ * Parameters:
+ *  - lo: The first key to remove, or nullptr for no lower bound.
+ *  - hi: The first key to keep, or nullptr for no upper bound.
+ *    Neither may compare greater than the other. Both are only read
+ *    while splitting, so they may point into nodes being removed.
+ *
+ * Returns:
+ *  - The number of keys removed.
+ *
+ * Behavior:
+ *  - Splits off the keys below lo and those from hi on, frees the
+ *    middle and joins the outer parts: O(log n + k).
+ *  - If the range covers the whole tree it is cleared instead, which
+ *    lets an exclusive arena drop its blocks in O(blocks).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::eraseBetween(const T* lo, const T* hi) {
+    Node* oldMin = leftmost;
+    Node* oldMax = rightmost;
+    Node* less = nullptr;
+    Node* middle = root;
+    Node* greater = nullptr;
+    if (lo) {
+        splitNodes(root, *lo, less, middle);
+    }
+    if (hi) {
+        Node* rest = middle;
+        splitNodes(rest, *hi, middle, greater);
+    }
+    if (!less && !greater) {
+        root = middle;
+        const std::size_t removed = tree_size;
+        clear();
+        return removed;
+    }
+
+    const std::size_t removed = clear(middle);
+    root = joinTwo(less, greater);
+    leftmost = less ? oldMin : minValueNode(root);
+    rightmost = greater ? oldMax : maxValueNode(root);
+    tree_size -= removed;
+    return removed;
+}
+
+
+/***************************************
+ * splitAround (private helper)
+ *
+ * Splits a subtree around a key, separating out an equivalent node.
+ *
+ * Parameters:
+ *  - node: Root of the subtree; may be nullptr.
+ *  - key: The split key.
+ *  - less: Receives the keys less than key.
+ *  - found: Receives the detached node equivalent to key, or nullptr.
+ *  - greater: Receives the keys greater than key.
+ *
+ * Behavior:
+ *  - Like splitNodes, O(log n) and allocation-free.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::splitAround(Node* node, const T& key, Node*& less, Node*& found, Node*& greater) {
+    if (!node) {
+        less = nullptr;
+        found = nullptr;
+        greater = nullptr;
+        return;
+    }
+    Node* left = node->left;
+    Node* right = node->right;
+    if (keyLess(node->key, key)) {
+        Node* lower;
+        splitAround(right, key, lower, found, greater);
+        less = joinNodes(left, node, lower);
+    }
+    else if (keyLess(key, node->key)) {
+        Node* upper;
+        splitAround(left, key, less, found, upper);
+        greater = joinNodes(upper, node, right);
+    }
+    else {
+        less = left;
+        greater = right;
+        if (less) {
+            less->parent = nullptr;
+        }
+        if (greater) {
+            greater->parent = nullptr;
+        }
+        node->left = nullptr;
+        node->right = nullptr;
+        found = node;
+    }
+}
+
+
+/***************************************
+ * setOpNodes (private helper)
+ *
+ * Join-based divide and conquer for set_union, set_intersection and
+ * set_difference.
+ *
+ * Parameters:
+ *  - a: Detached subtree of the first operand; consumed.
+ *  - b: Detached subtree of the second operand; consumed.
+ *  - delta: Receives the size bookkeeping for Op: copies dropped as
+ *    duplicates (union, insert), copies kept (intersection) or copies
+ *    removed (difference, erase).
+ *  - threads: How many threads this call may occupy.
+ *
+ * Returns:
+ *  - Root of the result subtree.
+ *
+ * Behavior:
+ *  - Splits b around a's root, recurses on the two independent halves
+ *    and joins the results back around a's root (or without it when
+ *    the key drops out). O(m log(n / m + 1)) work for sizes m <= n.
+ *  - Nodes of b that are not needed are freed; no node is allocated.
+ *  - With threads > 1 and a tall enough subtree, the lower half runs
+ *    on a std::async task while this thread takes the upper half, and
+ *    the thread budget is divided between them.
+ *  - Multiset repeat counts combine as std::set_union (max),
+ *    std::set_intersection (min) and std::set_difference (a - b) do;
+ *    Insert adds them and Erase drops a's node outright.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename AVLTree<T, Compare, Allocator, Policy>::SetOp Op>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::setOpNodes(Node* a, Node* b, std::size_t& delta, unsigned threads) {
+    if (!a || !b) {
+        if constexpr (Op == SetOp::Union || Op == SetOp::Insert) {
+            return a ? a : b;
+        }
+        else if constexpr (Op == SetOp::Intersection) {
+            clear(a);
+            clear(b);
+            return nullptr;
+        }
+        else {
+            clear(b);
+            return a;
+        }
+    }
+
+    Node* left = a->left;
+    Node* right = a->right;
+    Node* lessB;
+    Node* dup;
+    Node* greaterB;
+    splitAround(b, a->key, lessB, dup, greaterB);
+
+    std::size_t lowDelta = 0;
+    std::size_t highDelta = 0;
+    Node* low;
+    Node* high;
+    if (threads > 1 && height(a) >= parallel_min_height) {
+        unsigned lowThreads = threads / 2;
+        std::future<Node*> task = std::async(std::launch::async, [this, left, lessB, &lowDelta, lowThreads] {
+            return setOpNodes<Op>(left, lessB, lowDelta, lowThreads);
+        });
+        high = setOpNodes<Op>(right, greaterB, highDelta, threads - lowThreads);
+        low = task.get();
+    }
+    else {
+        low = setOpNodes<Op>(left, lessB, lowDelta, 1);
+        high = setOpNodes<Op>(right, greaterB, highDelta, 1);
+    }
+    delta += lowDelta + highDelta;
+
+    bool keep = true;
+    if (dup) {
+        std::size_t shared = std::min(repeatCount(a), repeatCount(dup));
+        if constexpr (Op == SetOp::Union) {
+            delta += shared;
+            if constexpr (Policy::multiset) {
+                a->repeat = std::max(a->repeat, dup->repeat);
+            }
+        }
+        else if constexpr (Op == SetOp::Intersection) {
+            delta += shared;
+            if constexpr (Policy::multiset) {
+                a->repeat = shared;
+            }
+        }
+        else if constexpr (Op == SetOp::Difference) {
+            delta += shared;
+            if constexpr (Policy::multiset) {
+                a->repeat -= shared;
+                keep = a->repeat != 0;
+            }
+            else {
+                keep = false;
+            }
+        }
+        else if constexpr (Op == SetOp::Insert) {
+            if constexpr (Policy::multiset) {
+                a->repeat += dup->repeat;
+            }
+            else {
+                delta += shared;
+            }
+        }
+        else {
+            delta += repeatCount(a);
+            keep = false;
+        }
+        destroyNode(dup);
+    }
+    else if constexpr (Op == SetOp::Intersection) {
+        keep = false;
+    }
+
+    if (keep) {
+        return joinNodes(low, a, high);
+    }
+    destroyNode(a);
+    Node* joined = joinTwo(low, high);
+    if (joined) {
+        joined->parent = nullptr;
+    }
+    return joined;
+}
+
+
+/***************************************
+ * setOperation (private helper)
+ *
+ * Runs setOpNodes over two whole trees and rebuilds the bookkeeping.
+ *
+ * Parameters:
+ *  - a, b: The operands; both are emptied.
+ *  - threads: Thread budget; 0 means std::thread::hardware_concurrency().
+ *
+ * Returns:
+ *  - The result, which takes over a's comparator and allocator.
+ *
+ * Behavior:
+ *  - If the allocators differ (e.g. two AVLPoolAllocator arenas), b is
+ *    first rebuilt in a's allocator in O(m) so nodes can be exchanged.
+ *  - Runs sequentially unless the allocator is stateless: stateful
+ *    allocators such as AVLPoolAllocator are not safe to share between
+ *    threads.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename AVLTree<T, Compare, Allocator, Policy>::SetOp Op>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::setOperation(AVLTree& a, AVLTree& b, unsigned threads) {
+    if (!a.root || !b.root) {
+        // Nothing to combine; a non-empty b is freed by its own allocator.
+        AVLTree result(std::move(a));
+        if ((Op == SetOp::Union || Op == SetOp::Insert) && !result.root && b.root) {
+            // The result is b's keys, still in a's comparator and allocator.
+            if (sameAllocator(result, b)) {
+                result.root = b.root;
+                result.leftmost = b.leftmost;
+                result.rightmost = b.rightmost;
+                result.tree_size = b.tree_size;
+                b.root = nullptr;
+                b.leftmost = nullptr;
+                b.rightmost = nullptr;
+                b.tree_size = 0;
+            }
+            else {
+                result.assign(b.cbegin(), b.cend());
+            }
+            return result;
+        }
+        if (Op == SetOp::Intersection) {
+            result.clear();
+        }
+        return result;
+    }
+    if (!sameAllocator(a, b)) {
+        AVLTree rehomed(a.comp, Allocator(a.node_alloc));
+        rehomed.assign(b.cbegin(), b.cend());
+        b.swap(rehomed);
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if constexpr (!NodeAllocTraits::is_always_equal::value) {
+        threads = 1;
+    }
+
+    AVLTree result(std::move(a));
+    Node* other = b.root;
+    std::size_t otherSize = b.tree_size;
+    b.root = nullptr;
+    b.leftmost = nullptr;
+    b.rightmost = nullptr;
+    b.tree_size = 0;
+
+    std::size_t delta = 0;
+    result.root = result.template setOpNodes<Op>(result.root, other, delta, threads);
+    if constexpr (Op == SetOp::Union || Op == SetOp::Insert) {
+        result.tree_size += otherSize - delta;
+    }
+    else if constexpr (Op == SetOp::Intersection) {
+        result.tree_size = delta;
+    }
+    else {
+        result.tree_size -= delta;
+    }
+    if (result.root) {
+        result.root->parent = nullptr;
+        result.leftmost = result.minValueNode(result.root);
+        result.rightmost = result.maxValueNode(result.root);
+    }
+    else {
+        result.leftmost = nullptr;
+        result.rightmost = nullptr;
+    }
+    return result;
+}
+
+
+/***************************************
+ * set_union
+ *
+ * Returns the keys present in either tree.
+ *
+ * Parameters:
+ *  - a, b: The operands, taken by value: pass std::move(tree) to
+ *    reuse its nodes, or a plain lvalue to work on a copy.
+ *
+ * Returns:
+ *  - The union, sharing a's comparator and allocator.
+ *
+ * Behavior:
+ *  - Join-based divide and conquer: O(m log(n / m + 1)) for operand
+ *    sizes m <= n, versus O(m + n) for a lockstep merge.
+ *  - The overload taking threads forks independent halves onto up to
+ *    that many threads (0 selects hardware_concurrency()).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::set_union(AVLTree a, AVLTree b) {
+    return setOperation<SetOp::Union>(a, b, 1);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::set_union(AVLTree a, AVLTree b, unsigned threads) {
+    return setOperation<SetOp::Union>(a, b, threads);
+}
+
+
+/***************************************
+ * set_intersection
+ *
+ * Returns the keys present in both trees; see set_union for the
+ * parameters and complexity.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::set_intersection(AVLTree a, AVLTree b) {
+    return setOperation<SetOp::Intersection>(a, b, 1);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::set_intersection(AVLTree a, AVLTree b, unsigned threads) {
+    return setOperation<SetOp::Intersection>(a, b, threads);
+}
+
+
+/***************************************
+ * set_difference
+ *
+ * Returns the keys of a that are not in b; see set_union for the
+ * parameters and complexity.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::set_difference(AVLTree a, AVLTree b) {
+    return setOperation<SetOp::Difference>(a, b, 1);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTree<T, Compare, Allocator, Policy> AVLTree<T, Compare, Allocator, Policy>::set_difference(AVLTree a, AVLTree b, unsigned threads) {
+    return setOperation<SetOp::Difference>(a, b, threads);
+}
+
+
+/***************************************
+ * rebuildInsert (private helper)
+ *
+ * Merges a batch tree into this one by relinking every node.
+ *
+ * Parameters:
+ *  - batch: A tree sharing this tree's allocator; emptied.
+ *
+ * Behavior:
+ *  - Walks both trees in order into one node array, then relinks it
+ *    with linkBalanced: O(n + m) with no allocation besides the array.
+ *  - Batch nodes whose key is already present are freed (a multiset
+ *    adds their repeat count instead).
+ *  - If the array cannot be allocated both trees are left unchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::rebuildInsert(AVLTree& batch) {
+    std::vector<Node*> nodes;
+    std::vector<std::pair<Node*, Node*> > dupes;
+    Node* a = leftmost;
+    Node* b = batch.leftmost;
+    while (a || b) {
+        if (!b || (a && keyLess(a->key, b->key))) {
+            nodes.push_back(a);
+            a = nextNode(a);
+        }
+        else if (!a || keyLess(b->key, a->key)) {
+            nodes.push_back(b);
+            b = nextNode(b);
+        }
+        else {
+            nodes.push_back(a);
+            dupes.emplace_back(a, b);
+            a = nextNode(a);
+            b = nextNode(b);
+        }
+    }
+
+    tree_size += batch.tree_size;
+    for (const std::pair<Node*, Node*>& dup : dupes) {
+        if constexpr (Policy::multiset) {
+            dup.first->repeat += dup.second->repeat;
+        }
+        else {
+            --tree_size;
+        }
+        destroyNode(dup.second);
+    }
+    batch.root = nullptr;
+    batch.leftmost = nullptr;
+    batch.rightmost = nullptr;
+    batch.tree_size = 0;
+
+    root = linkBalanced(nodes.data(), nodes.size());
+    leftmost = nodes.front();
+    rightmost = nodes.back();
+}
+
+
+/***************************************
+ * rebuildErase (private helper)
+ *
+ * Removes a sorted batch of keys by relinking the survivors.
+ *
+ * Parameters:
+ *  - keys: Strictly increasing keys to remove.
+ *
+ * Behavior:
+ *  - O(n + m); if the node arrays cannot be allocated the tree is left
+ *    unchanged.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::rebuildErase(const std::vector<T>& keys) {
+    std::vector<Node*> kept;
+    std::vector<Node*> doomed;
+    typename std::vector<T>::const_iterator key = keys.begin();
+    for (Node* node = leftmost; node; node = nextNode(node)) {
+        while (key != keys.end() && keyLess(*key, node->key)) {
+            ++key;
+        }
+        if (key != keys.end() && !keyLess(node->key, *key)) {
+            doomed.push_back(node);
+        }
+        else {
+            kept.push_back(node);
+        }
+    }
+
+    for (Node* node : doomed) {
+        tree_size -= repeatCount(node);
+        destroyNode(node);
+    }
+    root = linkBalanced(kept.data(), kept.size());
+    leftmost = kept.empty() ? nullptr : kept.front();
+    rightmost = kept.empty() ? nullptr : kept.back();
+}
+
+
+/***************************************
+ * insert_batch
+ *
+ * Inserts every key in [first, last), as repeated insert() would.
+ *
+ * Parameters:
+ *  - first, last: The batch, in any order.
+ *  - threads: Thread budget for sorting and merging; 0 selects
+ *    std::thread::hardware_concurrency(). The overload without it runs
+ *    on the calling thread.
+ *
+ * Returns:
+ *  - The number of keys added (counting multiset copies).
+ *
+ * Behavior:
+ *  - The batch is copied, stable-sorted (in parallel when large) and
+ *    deduplicated, then built into a balanced tree before this tree is
+ *    touched, so a throwing allocation leaves it unchanged.
+ *  - A batch of at least size() / batch_rebuild_ratio keys is merged
+ *    by relinking both trees in O(n + m); a smaller one is merged with
+ *    the join-based union in O(m log(n / m + 1)).
+ *  - Existing nodes are reused, so iterators stay valid.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::insert_batch(InputIt first, InputIt last) {
+    return insert_batch(first, last, 1);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::insert_batch(InputIt first, InputIt last, unsigned threads) {
+    std::vector<T> keys(first, last);
+    if (keys.empty()) {
+        return 0;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::size_t> repeats;
+    sortKeys(keys, threads);
+    foldRuns(keys, repeats);
+
+    AVLTree batch(comp, Allocator(node_alloc));
+    batch.assignSorted(std::make_move_iterator(keys.begin()), keys.size(), repeats.empty() ? nullptr : repeats.data());
+
+    const std::size_t before = tree_size;
+    if (keys.size() * batch_rebuild_ratio >= tree_size) {
+        rebuildInsert(batch);
+    }
+    else {
+        AVLTree merged = setOperation<SetOp::Insert>(*this, batch, threads);
+        swap(merged);
+    }
+    return tree_size - before;
+}
+
+
+/***************************************
+ * erase_batch
+ *
+ * Erases every key in [first, last), as repeated erase(key) would
+ * (a multiset loses all copies of each key).
+ *
+ * Parameters:
+ *  - first, last: The batch, in any order; absent keys are ignored.
+ *  - threads: As for insert_batch.
+ *
+ * Returns:
+ *  - The number of keys removed (counting multiset copies).
+ *
+ * Behavior:
+ *  - Sorts and deduplicates the batch like insert_batch. A large batch
+ *    is removed by relinking the survivors in O(n + m); a small one is
+ *    built into a temporary tree and removed with the join-based
+ *    difference in O(m log(n / m + 1)).
+ *  - Iterators to surviving keys stay valid.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::erase_batch(InputIt first, InputIt last) {
+    return erase_batch(first, last, 1);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename InputIt>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::erase_batch(InputIt first, InputIt last, unsigned threads) {
+    if (!root) {
+        return 0;
+    }
+    std::vector<T> keys(first, last);
+    if (keys.empty()) {
+        return 0;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::size_t> repeats;
+    sortKeys(keys, threads);
+    foldRuns(keys, repeats);
+
+    const std::size_t before = tree_size;
+    if (keys.size() * batch_rebuild_ratio >= tree_size) {
+        rebuildErase(keys);
+    }
+    else {
+        AVLTree batch(comp, Allocator(node_alloc));
+        batch.assignSorted(std::make_move_iterator(keys.begin()), keys.size());
+        AVLTree remaining = setOperation<SetOp::Erase>(*this, batch, threads);
+        swap(remaining);
+    }
+    return before - tree_size;
+}
+
+
+/***************************************
+ * clear (public interface)
+ *
+ * Clears the AVL tree of all nodes.
+ *
+ * Behavior:
+ *  - Calls the clear helper and resets the root and size.
+ *  - For an arena-backed tree that owns its arena exclusively and
+ *    whose nodes are trivially destructible (the key and, with an
+ *    augment, its aggregate value), the arena's blocks are released
+ *    in O(blocks) instead of freeing node by node.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::clear() {
+    if constexpr (AVLIsPoolAllocator<NodeAllocator>::value && std::is_trivially_destructible<Node>::value) {
+        if (node_alloc.exclusive()) {
+            node_alloc.release();
+            root = nullptr;
+            leftmost = nullptr;
+            rightmost = nullptr;
+            tree_size = 0;
+            return;
+        }
+    }
+    clear(root);
+    root = nullptr;
+    leftmost = nullptr;
+    rightmost = nullptr;
+    tree_size = 0;
+}
+
+
+/***************************************
+ * clear_async
+ *
+ * Empties the tree in O(1) and frees its nodes on a background thread.
+ *
+ * Returns:
+ *  - A future for the number of keys freed. Dropping it does not wait
+ *    for the thread; get() or wait() does.
+ *
+ * Behavior:
+ *  - For a stateless allocator (is_always_equal) the nodes are
+ *    detached and a detached std::thread frees them through a copy of
+ *    the allocator. The tree can be reused or destroyed at once.
+ *  - Any other allocator, such as AVLPoolAllocator or a
+ *    polymorphic_allocator over an unsynchronized resource, may not be
+ *    safe to call from a second thread, so the tree is cleared on the
+ *    calling thread with clear(). Set operations use the same test to
+ *    decide whether to fork.
+ *  - Nodes freed on the thread are not counted by stats().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::future<std::size_t> AVLTree<T, Compare, Allocator, Policy>::clear_async() {
+    if constexpr (!NodeAllocTraits::is_always_equal::value) {
+        const std::size_t keys = tree_size;
+        clear();
+        std::promise<std::size_t> ready;
+        ready.set_value(keys);
+        return ready.get_future();
+    }
+    else {
+        Node* detached = root;
+        root = nullptr;
+        leftmost = nullptr;
+        rightmost = nullptr;
+        tree_size = 0;
+        if (!detached) {
+            std::promise<std::size_t> ready;
+            ready.set_value(0);
+            return ready.get_future();
+        }
+        std::packaged_task<std::size_t()> task([detached, alloc = node_alloc]() mutable {
+            std::size_t nodes = 0;
+            return destroySubtree(detached, alloc, nodes);
+        });
+        std::future<std::size_t> done = task.get_future();
+        std::thread(std::move(task)).detach();
+        return done;
+    }
+}
+
+
+/***************************************
+ * find (non-const)
+ *
+ * Searches for a key in the AVL tree.
+ *
+ * Parameters:
+ *  - key: The key to search for.
+ *
+ * Returns:
+ *  - An iterator pointing to the found key or end() if not found.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::find(const T& key) {
+    return iterator(findNode(key), this);
+}
+
+
+/***************************************
+ * find (const version)
+ *
+ * Searches for a key in the AVL tree.
+ *
+ * Parameters:
+ *  - key: The key to search for.
+ *
+ * Returns:
+ *  - A const_iterator pointing to the found key or end() if not found.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::find(const T& key) const {
+    return const_iterator(findNode(key), this);
+}
+
+
+/***************************************
+ * find (heterogeneous)
+ *
+ * Searches for a key equivalent to a value of another type.
+ *
+ * Parameters:
+ *  - key: Any value the comparator can compare against T.
+ *
+ * Returns:
+ *  - An iterator pointing to the found key or end() if not found.
+ *
+ * Behavior:
+ *  - Only available when Compare::is_transparent is defined, so no
+ *    temporary T is constructed for the probe.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::find(const K& key) {
+    return iterator(findNode(key), this);
+}
+
+
+/***************************************
+ * find (heterogeneous, const)
+ *
+ * Const counterpart of the heterogeneous find.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::find(const K& key) const {
+    return const_iterator(findNode(key), this);
+}
+
+
+/***************************************
+ * lowerBoundNode (private helper)
+ *
+ * Finds the first node whose key is not less than key.
+ *
+ * Parameters:
+ *  - key: The probe; T or any type a transparent comparator accepts.
+ *
+ * Returns:
+ *  - Pointer to the node, or nullptr if every key is less than key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::lowerBoundNode(const K& key) const {
+    Node* result = nullptr;
+    Node* current = root;
+    std::size_t visited = 0;
+    while (current) {
+        ++visited;
+        if (!keyLess(current->key, key)) {
+            result = current;
+            current = current->left;
+        }
+        else {
+            current = current->right;
+        }
+    }
+    this->countSearch(visited);
+    return result;
+}
+
+
+/***************************************
+ * upperBoundNode (private helper)
+ *
+ * Finds the first node whose key is greater than key.
+ *
+ * Parameters:
+ *  - key: The probe; T or any type a transparent comparator accepts.
+ *
+ * Returns:
+ *  - Pointer to the node, or nullptr if no key is greater than key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::upperBoundNode(const K& key) const {
+    Node* result = nullptr;
+    Node* current = root;
+    std::size_t visited = 0;
+    while (current) {
+        ++visited;
+        if (keyLess(key, current->key)) {
+            result = current;
+            current = current->left;
+        }
+        else {
+            current = current->right;
+        }
+    }
+    this->countSearch(visited);
+    return result;
+}
+
+
+/***************************************
+ * lower_bound (non-const)
+ *
+ * Returns:
+ *  - An iterator to the first key not less than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::lower_bound(const T& key) {
+    return iterator(lowerBoundNode(key), this);
+}
+
+
+/***************************************
+ * lower_bound (const)
+ *
+ * Returns:
+ *  - A const_iterator to the first key not less than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::lower_bound(const T& key) const {
+    return const_iterator(lowerBoundNode(key), this);
+}
+
+
+/***************************************
+ * lower_bound (heterogeneous)
+ *
+ * Same as lower_bound(const T&) for transparent comparators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::lower_bound(const K& key) {
+    return iterator(lowerBoundNode(key), this);
+}
+
+
+/***************************************
+ * lower_bound (heterogeneous, const)
+ *
+ * Same as lower_bound(const T&) const for transparent comparators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::lower_bound(const K& key) const {
+    return const_iterator(lowerBoundNode(key), this);
+}
+
+
+/***************************************
+ * upper_bound (non-const)
+ *
+ * Returns:
+ *  - An iterator to the first key greater than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::upper_bound(const T& key) {
+    return iterator(upperBoundNode(key), this);
+}
+
+
+/***************************************
+ * upper_bound (const)
+ *
+ * Returns:
+ *  - A const_iterator to the first key greater than key, or end().
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::upper_bound(const T& key) const {
+    return const_iterator(upperBoundNode(key), this);
+}
+
+
+/***************************************
+ * upper_bound (heterogeneous)
+ *
+ * Same as upper_bound(const T&) for transparent comparators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::upper_bound(const K& key) {
+    return iterator(upperBoundNode(key), this);
+}
+
+
+/***************************************
+ * upper_bound (heterogeneous, const)
+ *
+ * Same as upper_bound(const T&) const for transparent comparators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::upper_bound(const K& key) const {
+    return const_iterator(upperBoundNode(key), this);
+}
+
+
+/***************************************
+ * equal_range (non-const)
+ *
+ * Returns:
+ *  - The pair (lower_bound(key), upper_bound(key)); the range holds at
+ *    most one key.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::iterator, typename AVLTree<T, Compare, Allocator, Policy>::iterator>
+AVLTree<T, Compare, Allocator, Policy>::equal_range(const T& key) {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+
+/***************************************
+ * equal_range (const)
+ *
+ * Returns:
+ *  - The pair (lower_bound(key), upper_bound(key)) as const_iterators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::const_iterator, typename AVLTree<T, Compare, Allocator, Policy>::const_iterator>
+AVLTree<T, Compare, Allocator, Policy>::equal_range(const T& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+
+/***************************************
+ * equal_range (heterogeneous)
+ *
+ * Same as equal_range(const T&) for transparent comparators; several
+ * keys may be equivalent to a single probe.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::iterator, typename AVLTree<T, Compare, Allocator, Policy>::iterator>
+AVLTree<T, Compare, Allocator, Policy>::equal_range(const K& key) {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+
+/***************************************
+ * equal_range (heterogeneous, const)
+ *
+ * Same as equal_range(const T&) const for transparent comparators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+std::pair<typename AVLTree<T, Compare, Allocator, Policy>::const_iterator, typename AVLTree<T, Compare, Allocator, Policy>::const_iterator>
+AVLTree<T, Compare, Allocator, Policy>::equal_range(const K& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+
+/***************************************
+ * range (non-const)
+ *
+ * Returns:
+ *  - A view of the keys k with lo <= k < hi; empty if hi <= lo.
+ *
+ * Behavior:
+ *  - O(log n) to locate both ends; nothing is copied, the view is
+ *    walked in place.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLRangeView<typename AVLTree<T, Compare, Allocator, Policy>::iterator> AVLTree<T, Compare, Allocator, Policy>::range(const T& lo, const T& hi) {
+    iterator first = lower_bound(lo);
+    return AVLRangeView<iterator>(first, keyLess(lo, hi) ? lower_bound(hi) : first);
+}
+
+
+/***************************************
+ * range (const)
+ *
+ * Returns:
+ *  - A view of the keys k with lo <= k < hi, over const_iterators.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLRangeView<typename AVLTree<T, Compare, Allocator, Policy>::const_iterator> AVLTree<T, Compare, Allocator, Policy>::range(const T& lo, const T& hi) const {
+    const_iterator first = lower_bound(lo);
+    return AVLRangeView<const_iterator>(first, keyLess(lo, hi) ? lower_bound(hi) : first);
+}
+
+
+/***************************************
+ * find_many
+ *
+ * Looks up a batch of keys at once.
+ *
+ * Parameters:
+ *  - first, last: The probes, e.g. a std::vector<T>; dereferencing
+ *    must yield references, not temporaries.
+ *  - out: Receives one const_iterator per probe, in input order:
+ *    the key found, or end().
+ *  - sort_probes: Visit the probes in key order so that their
+ *    descents share cached path prefixes.
+ *
+ * Returns:
+ *  - out advanced past the last result.
+ *
+ * Behavior:
+ *  - Same results as calling find() on each probe, but the descents
+ *    are interleaved with prefetching so cache misses overlap instead
+ *    of stalling one probe at a time. Worth it for batches of a few
+ *    dozen probes up; the probe pointers and results take O(m) space.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename ForwardIt, typename OutputIt>
+OutputIt AVLTree<T, Compare, Allocator, Policy>::find_many(ForwardIt first, ForwardIt last, OutputIt out, bool sort_probes) const {
+    for (const Node* node : findBatch(first, last, sort_probes)) {
+        *out = const_iterator(node, this);
+        ++out;
+    }
+    return out;
+}
+
+
+/***************************************
+ * contains_many
+ *
+ * Like find_many(), but writes one bool per probe: whether it is
+ * present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename ForwardIt, typename OutputIt>
+OutputIt AVLTree<T, Compare, Allocator, Policy>::contains_many(ForwardIt first, ForwardIt last, OutputIt out, bool sort_probes) const {
+    for (const Node* node : findBatch(first, last, sort_probes)) {
+        *out = node != nullptr;
+        ++out;
+    }
+    return out;
+}
 
-    // Update the node's height.
-    node->height = 1 + std::max(height(node->left), height(node->right));
 
-    int balance = getBalanceFactor(node);
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+bool AVLTree<T, Compare, Allocator, Policy>::contains(const T& key) const {
+    return findNode(key) != nullptr;
+}
 
-    // Left Left Case.
-    if (balance > 1 && comp(key, node->left->key)) {
-        return rightRotate(node);
-    }
-    // Right Right Case.
-    if (balance < -1 && comp(node->right->key, key)) {
-        return leftRotate(node);
-    }
-    // Left Right Case.
-    if (balance > 1 && comp(node->left->key, key)) {
-        node->left = leftRotate(node->left);
-        return rightRotate(node);
-    }
-    // Right Left Case.
-    if (balance < -1 && comp(key, node->right->key)) {
-        node->right = rightRotate(node->right);
-        return leftRotate(node);
-    }
-    return node;
+
+/***************************************
+ * contains (heterogeneous)
+ *
+ * Same as contains(const T&) for transparent comparators. Any one
+ * equivalent key settles it, so a single descent suffices even when
+ * several keys match the probe.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+bool AVLTree<T, Compare, Allocator, Policy>::contains(const K& key) const {
+    return findNode(key) != nullptr;
 }
 
 
 /***************************************
- * minValueNode
+ * count
  *
- * Finds the node with the minimum key in the subtree.
+ * Counts the keys equivalent to key.
  *
  * Parameters:
- *  - node: The root of the subtree.
+ *  - key: The key to look for.
  *
  * Returns:
- *  - Pointer to the node with the minimum key.
+ *  - The repeat count for a multiset, otherwise 0 or 1; O(log n).
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::minValueNode(Node* node) const {
-    Node* current = node;
-    while (current && current->left) {
-        current = current->left;
-    }
-    return current;
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::count(const T& key) const {
+    const Node* node = findNode(key);
+    return node ? repeatCount(node) : 0;
 }
 
 
 /***************************************
- * deleteNode
- *
- * Recursively deletes a key from the subtree.
+ * count (heterogeneous)
  *
- * Parameters:
- *  - node: The root of the subtree.
- *  - key: The key to delete.
+ * Counts the keys equivalent to a probe under a transparent
+ * comparator, where several distinct keys may match it.
  *
  * Returns:
- *  - The new root of the subtree.
+ *  - The number of keys in [lower_bound(key), upper_bound(key)),
+ *    copies included.
  *
  * Behavior:
- *  - Follows BST deletion rules.
- *  - Updates the height and rebalances the subtree.
+ *  - With order statistics, two rank descents, O(log n); otherwise
+ *    O(log n + k) for k matching nodes.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::deleteNode(Node* node, const T& key) {
-    if (!node) {
-        return node;
-    }
-
-    if (comp(key, node->key)) {
-        node->left = deleteNode(node->left, key);
-    }
-    else if (comp(node->key, key)) {
-        node->right = deleteNode(node->right, key);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K, typename C, typename>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::count(const K& key) const {
+    if constexpr (Policy::order_statistics) {
+        return rankOf(key, true) - rankOf(key, false);
     }
     else {
-        // This node is the one to be deleted.
-        if (!node->left || !node->right) {
-            Node* temp = node->left ? node->left : node->right;
-            if (!temp) {
-                // No child case.
-                temp = node;
-                node = nullptr;
-            }
-            else {
-                // One child case: copy the child into node.
-                temp->parent = node->parent;
-                *node = *temp;
-            }
-            delete temp;
-            --tree_size;
-        }
-        else {
-            // Node with two children: get the inorder successor.
-            Node* temp = minValueNode(node->right);
-            node->key = temp->key;
-            node->right = deleteNode(node->right, temp->key);
+        const Node* last = upperBoundNode(key);
+        std::size_t result = 0;
+        for (Node* node = lowerBoundNode(key); node != last; node = nextNode(node)) {
+            result += repeatCount(node);
         }
+        return result;
     }
-
-    if (!node) {
-        return node;
-    }
-    // Update height.
-    node->height = 1 + std::max(height(node->left), height(node->right));
-
-    int balance = getBalanceFactor(node);
-
-    // Rebalance the node if needed.
-    if (balance > 1 && getBalanceFactor(node->left) >= 0) {
-        return rightRotate(node);
-    }
-    if (balance > 1 && getBalanceFactor(node->left) < 0) {
-        node->left = leftRotate(node->left);
-        return rightRotate(node);
-    }
-    if (balance < -1 && getBalanceFactor(node->right) <= 0) {
-        return leftRotate(node);
-    }
-    if (balance < -1 && getBalanceFactor(node->right) > 0) {
-        node->right = rightRotate(node->right);
-        return leftRotate(node);
-    }
-    return node;
 }
 
 
 /***************************************
- * clear (private recursive helper)
+ * rankOf (private helper)
  *
- * Recursively deletes all nodes in the subtree.
+ * Counts the keys before a probe.
  *
  * Parameters:
- *  - node: The current root of the subtree.
+ *  - key: The probe; any type the comparator accepts.
+ *  - inclusive: Whether keys equivalent to the probe count as well.
+ *
+ * Returns:
+ *  - The number of keys less than key, or not greater than it when
+ *    inclusive is set.
  *
  * Behavior:
- *  - Frees memory allocated to each node.
+ *  - O(log n); requires an order-statistics policy.
  ***************************************/
-template <typename T, typename Compare>
-void AVLTree<T, Compare>::clear(Node* node) {
-    if (!node) {
-        return;
+template <typename T, typename Compare, typename Allocator, typename Policy>
+template <typename K>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::rankOf(const K& key, bool inclusive) const {
+    static_assert(Policy::order_statistics, "rankOf() requires an order-statistics policy");
+    std::size_t result = 0;
+    const Node* current = root;
+    while (current) {
+        if (inclusive ? !keyLess(key, current->key) : keyLess(current->key, key)) {
+            result += subtreeCount(current->left) + repeatCount(current);
+            current = current->right;
+        }
+        else {
+            current = current->left;
+        }
     }
-    clear(node->left);
-    clear(node->right);
-    delete node;
+    return result;
 }
 
 
 /***************************************
- * empty
+ * rank
  *
- * Checks if the AVL tree is empty.
+ * Counts the keys strictly less than a given key.
+ *
+ * Parameters:
+ *  - key: The key to rank; it need not be present.
  *
  * Returns:
- *  - true if the tree has no nodes; otherwise false.
+ *  - The number of keys that compare less than key.
+ *
+ * Behavior:
+ *  - O(log n); requires an order-statistics policy.
  ***************************************/
-template <typename T, typename Compare>
-bool AVLTree<T, Compare>::empty() const {
-    return tree_size == 0;
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::rank(const T& key) const {
+    static_assert(Policy::order_statistics, "rank() requires an order-statistics policy");
+    return rankOf(key, false);
 }
 
 
 /***************************************
- * size
+ * select (non-const)
  *
- * Returns the number of elements in the AVL tree.
+ * Finds the k-th smallest key.
+ *
+ * Parameters:
+ *  - k: Zero-based position in sorted order.
  *
  * Returns:
- *  - The tree's size.
+ *  - An iterator to the k-th key, or end() if k >= size().
+ *
+ * Behavior:
+ *  - O(log n); requires an order-statistics policy.
  ***************************************/
-template <typename T, typename Compare>
-std::size_t AVLTree<T, Compare>::size() const {
-    return tree_size;
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::select(std::size_t k) {
+    const_iterator it = static_cast<const AVLTree&>(*this).select(k);
+    return iterator(const_cast<Node*>(it.current), this, it.copyOffset());
 }
 
 
 /***************************************
- * insert (public interface)
+ * select (const)
  *
- * Inserts a key into the AVL tree.
+ * Finds the k-th smallest key.
  *
  * Parameters:
- *  - key: The key to insert.
+ *  - k: Zero-based position in sorted order.
  *
- * Behavior:
- *  - Calls the recursive helper to insert the key.
+ * Returns:
+ *  - A const_iterator to the k-th key, or end() if k >= size().
  ***************************************/
-template <typename T, typename Compare>
-void AVLTree<T, Compare>::insert(const T& key) {
-    root = insert(root, key, nullptr);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::select(std::size_t k) const {
+    static_assert(Policy::order_statistics, "select() requires an order-statistics policy");
+    const Node* current = root;
+    std::size_t offset = 0;
+    while (current) {
+        std::size_t leftCount = subtreeCount(current->left);
+        if (k < leftCount) {
+            current = current->left;
+        }
+        else if (k - leftCount < repeatCount(current)) {
+            offset = k - leftCount;
+            break;
+        }
+        else {
+            k -= leftCount + repeatCount(current);
+            current = current->right;
+        }
+    }
+    return const_iterator(current, this, offset);
 }
 
 
 /***************************************
- * erase
+ * count_range
  *
- * Erases a key from the AVL tree.
+ * Counts the keys in the half-open interval [lo, hi).
  *
  * Parameters:
- *  - key: The key to erase.
+ *  - lo: Inclusive lower bound.
+ *  - hi: Exclusive upper bound.
+ *
+ * Returns:
+ *  - The number of keys k with lo <= k < hi, or 0 if hi <= lo.
  *
  * Behavior:
- *  - Calls the recursive deleteNode function.
+ *  - Two rank() descents, O(log n); requires an order-statistics policy.
  ***************************************/
-template <typename T, typename Compare>
-void AVLTree<T, Compare>::erase(const T& key) {
-    root = deleteNode(root, key);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+std::size_t AVLTree<T, Compare, Allocator, Policy>::count_range(const T& lo, const T& hi) const {
+    if (!keyLess(lo, hi)) {
+        return 0;
+    }
+    return rank(hi) - rank(lo);
 }
 
 
 /***************************************
- * clear (public interface)
+ * aggregate (whole tree)
  *
- * Clears the AVL tree of all nodes.
+ * Returns:
+ *  - The augment monoid's combination of every key in order, or
+ *    identity() for an empty tree.
  *
  * Behavior:
- *  - Calls the clear helper and resets the root and size.
+ *  - O(1); requires a policy with an augment monoid.
  ***************************************/
-template <typename T, typename Compare>
-void AVLTree<T, Compare>::clear() {
-    clear(root);
-    root = nullptr;
-    tree_size = 0;
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::aggregate_type AVLTree<T, Compare, Allocator, Policy>::aggregate() const {
+    static_assert(augmented, "aggregate() requires a policy with an augment monoid");
+    return subtreeAggregate(root);
 }
 
 
 /***************************************
- * find (non-const)
+ * aggregate (range)
  *
- * Searches for a key in the AVL tree.
+ * Combines the keys in the half-open interval [lo, hi).
  *
  * Parameters:
- *  - key: The key to search for.
+ *  - lo: Inclusive lower bound.
+ *  - hi: Exclusive upper bound.
  *
  * Returns:
- *  - An iterator pointing to the found key or end() if not found.
+ *  - The augment monoid's combination, in key order, of every key k
+ *    with lo <= k < hi; identity() if there is none.
+ *
+ * Behavior:
+ *  - O(log n): descends to the highest node inside the interval, then
+ *    walks its left subtree towards lo and its right subtree towards
+ *    hi, combining the stored aggregates of the subtrees that lie
+ *    wholly inside.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::find(const T& key) {
-    Node* current = root;
-    while (current) {
-        if (comp(key, current->key)) {
-            current = current->left;
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::aggregate_type AVLTree<T, Compare, Allocator, Policy>::aggregate(const T& lo, const T& hi) const {
+    static_assert(augmented, "aggregate() requires a policy with an augment monoid");
+    if (!keyLess(lo, hi)) {
+        return Augment::identity();
+    }
+    const Node* split = root;
+    while (split) {
+        if (keyLess(split->key, lo)) {
+            split = split->right;
         }
-        else if (comp(current->key, key)) {
-            current = current->right;
+        else if (!keyLess(split->key, hi)) {
+            split = split->left;
         }
         else {
             break;
         }
     }
-    return iterator(current, this);
+    if (!split) {
+        return Augment::identity();
+    }
+
+    // Keys >= lo below split, gathered right to left.
+    aggregate_type low = Augment::identity();
+    for (const Node* node = split->left; node;) {
+        if (keyLess(node->key, lo)) {
+            node = node->right;
+        }
+        else {
+            low = Augment::combine(Augment::combine(ownAggregate(node), subtreeAggregate(node->right)), low);
+            node = node->left;
+        }
+    }
+    // Keys < hi below split, gathered left to right.
+    aggregate_type high = Augment::identity();
+    for (const Node* node = split->right; node;) {
+        if (keyLess(node->key, hi)) {
+            high = Augment::combine(high, Augment::combine(subtreeAggregate(node->left), ownAggregate(node)));
+            node = node->right;
+        }
+        else {
+            node = node->left;
+        }
+    }
+    return Augment::combine(Augment::combine(low, ownAggregate(split)), high);
 }
 
 
 /***************************************
- * find (const version)
+ * stats
  *
- * Searches for a key in the AVL tree.
+ * Returns:
+ *  - A snapshot of the counters together with the current size and
+ *    height; requires a policy with stats enabled.
+ *
+ * Behavior:
+ *  - O(1). Counts made concurrently with const searches on other
+ *    threads may be slightly low, never torn.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+AVLTreeStats AVLTree<T, Compare, Allocator, Policy>::stats() const {
+    static_assert(Policy::stats, "stats() requires a policy with stats enabled");
+    AVLTreeStats result;
+    this->fillStats(result);
+    result.size = tree_size;
+    result.height = height(root);
+    return result;
+}
+
+
+/***************************************
+ * reset_stats
+ *
+ * Zeroes every counter, e.g. at the start of a measurement window.
+ * An installed sampler stays installed.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::reset_stats() {
+    static_assert(Policy::stats, "reset_stats() requires a policy with stats enabled");
+    this->resetCounts();
+}
+
+
+/***************************************
+ * set_stats_sampler
+ *
+ * Installs a hook that receives a stats() snapshot periodically, e.g.
+ * to update Prometheus gauges from the writer thread.
  *
  * Parameters:
- *  - key: The key to search for.
+ *  - sampler: Called with the snapshot; an empty function removes
+ *    the hook. It must not modify the tree.
+ *  - period: Number of node insertions and removals between calls;
+ *    0 is treated as 1.
  *
- * Returns:
- *  - A const_iterator pointing to the found key or end() if not found.
+ * Behavior:
+ *  - Bulk operations that build or relink subtrees wholesale (assign,
+ *    join, split, set algebra) do not advance the period.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::find(const T& key) const {
-    const Node* current = root;
-    while (current) {
-        if (comp(key, current->key)) {
-            current = current->left;
-        }
-        else if (comp(current->key, key)) {
-            current = current->right;
-        }
-        else {
-            break;
-        }
-    }
-    return const_iterator(current, this);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::set_stats_sampler(std::function<void(const AVLTreeStats&)> sampler, std::size_t period) {
+    static_assert(Policy::stats, "set_stats_sampler() requires a policy with stats enabled");
+    this->sampler = std::move(sampler);
+    this->sample_period = period ? period : 1;
+    this->until_sample = this->sample_period;
 }
 
 
@@ -477,8 +4621,8 @@ typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::find(const T&
  * Returns:
  *  - Pointer to the leftmost (minimum) node.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::iterator::minimum(Node* node) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::iterator::minimum(Node* node) {
     while (node && node->left) {
         node = node->left;
     }
@@ -494,11 +4638,19 @@ typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::iterator::minimum(Node*
  * Returns:
  *  - A reference to the updated iterator.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator& AVLTree<T, Compare>::iterator::operator++() {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator& AVLTree<T, Compare, Allocator, Policy>::iterator::operator++() {
     if (!current) {
         return *this;
     }
+    if constexpr (Policy::multiset) {
+        // Step through the node's repeats before leaving it.
+        if (this->offset + 1 < current->repeat) {
+            ++this->offset;
+            return *this;
+        }
+        this->offset = 0;
+    }
     if (current->right) {
         current = minimum(current->right);
     }
@@ -522,8 +4674,8 @@ typename AVLTree<T, Compare>::iterator& AVLTree<T, Compare>::iterator::operator+
  * Returns:
  *  - The original iterator before increment.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::iterator::operator++(int) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::iterator::operator++(int) {
     iterator temp = *this;
     ++(*this);
     return temp;
@@ -538,16 +4690,17 @@ typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::iterator::operator++
  * Returns:
  *  - A reference to the updated iterator.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator& AVLTree<T, Compare>::iterator::operator--() {
-    if (!current) {
-        current = tree->root;
-        if (!current) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator& AVLTree<T, Compare, Allocator, Policy>::iterator::operator--() {
+    if constexpr (Policy::multiset) {
+        if (current && this->offset > 0) {
+            --this->offset;
             return *this;
         }
-        while (current->right) {
-            current = current->right;
-        }
+    }
+    if (!current) {
+        // Stepping back from end() lands on the cached rightmost node.
+        current = tree->rightmost;
     }
     else if (current->left) {
         current = current->left;
@@ -563,6 +4716,10 @@ typename AVLTree<T, Compare>::iterator& AVLTree<T, Compare>::iterator::operator-
         }
         current = p;
     }
+    if constexpr (Policy::multiset) {
+        // Arrive on the last repeat of the previous key.
+        this->offset = current ? current->repeat - 1 : 0;
+    }
     return *this;
 }
 
@@ -575,8 +4732,8 @@ typename AVLTree<T, Compare>::iterator& AVLTree<T, Compare>::iterator::operator-
  * Returns:
  *  - The original iterator before decrement.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::iterator::operator--(int) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::iterator::operator--(int) {
     iterator temp = *this;
     --(*this);
     return temp;
@@ -594,8 +4751,8 @@ typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::iterator::operator--
  * Returns:
  *  - Pointer to the leftmost (minimum) node (const).
  ***************************************/
-template <typename T, typename Compare>
-const typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::const_iterator::minimum(const Node* node) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+const typename AVLTree<T, Compare, Allocator, Policy>::Node* AVLTree<T, Compare, Allocator, Policy>::const_iterator::minimum(const Node* node) {
     while (node && node->left) {
         node = node->left;
     }
@@ -611,10 +4768,17 @@ const typename AVLTree<T, Compare>::Node* AVLTree<T, Compare>::const_iterator::m
  * Returns:
  *  - A reference to the updated const_iterator.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator& AVLTree<T, Compare>::const_iterator::operator++() {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator& AVLTree<T, Compare, Allocator, Policy>::const_iterator::operator++() {
     if (!current)
         return *this;
+    if constexpr (Policy::multiset) {
+        if (this->offset + 1 < current->repeat) {
+            ++this->offset;
+            return *this;
+        }
+        this->offset = 0;
+    }
     if (current->right) {
         const_cast<Node*&>(current) = current->right;
         while (current->left)
@@ -640,8 +4804,8 @@ typename AVLTree<T, Compare>::const_iterator& AVLTree<T, Compare>::const_iterato
  * Returns:
  *  - The original const_iterator before increment.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::const_iterator::operator++(int) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::const_iterator::operator++(int) {
     const_iterator temp = *this;
     ++(*this);
     return temp;
@@ -656,14 +4820,17 @@ typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::const_iterator
  * Returns:
  *  - A reference to the updated const_iterator.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator& AVLTree<T, Compare>::const_iterator::operator--() {
-    if (!current) {
-        current = tree->root;
-        if (!current)
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator& AVLTree<T, Compare, Allocator, Policy>::const_iterator::operator--() {
+    if constexpr (Policy::multiset) {
+        if (current && this->offset > 0) {
+            --this->offset;
             return *this;
-        while (current->right)
-            current = current->right;
+        }
+    }
+    if (!current) {
+        // Stepping back from end() lands on the cached rightmost node.
+        current = tree->rightmost;
     } 
     else if (current->left) {
         current = current->left;
@@ -678,6 +4845,9 @@ typename AVLTree<T, Compare>::const_iterator& AVLTree<T, Compare>::const_iterato
         }
         current = p;
     }
+    if constexpr (Policy::multiset) {
+        this->offset = current ? current->repeat - 1 : 0;
+    }
     return *this;
 }
 
@@ -690,8 +4860,8 @@ typename AVLTree<T, Compare>::const_iterator& AVLTree<T, Compare>::const_iterato
  * Returns:
  *  - The original const_iterator before decrement.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::const_iterator::operator--(int) {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::const_iterator::operator--(int) {
     const_iterator temp = *this;
     --(*this);
     return temp;
@@ -704,16 +4874,11 @@ typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::const_iterator
  * Returns an iterator to the first (smallest) element in the AVL tree.
  *
  * Returns:
- *  - An iterator pointing to the leftmost node.
+ *  - An iterator pointing to the cached leftmost node, in O(1).
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::begin() {
-    Node* current = root;
-    if (current) {
-        while (current->left)
-            current = current->left;
-    }
-    return iterator(current, this);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::begin() {
+    return iterator(leftmost, this);
 }
 
 
@@ -725,8 +4890,8 @@ typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::begin() {
  * Returns:
  *  - An iterator pointing to nullptr.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::end() {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::iterator AVLTree<T, Compare, Allocator, Policy>::end() {
     return iterator(nullptr, this);
 }
 
@@ -737,16 +4902,11 @@ typename AVLTree<T, Compare>::iterator AVLTree<T, Compare>::end() {
  * Returns a const_iterator to the first (smallest) element in the AVL tree.
  *
  * Returns:
- *  - A const_iterator pointing to the leftmost node.
+ *  - A const_iterator pointing to the cached leftmost node, in O(1).
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::begin() const {
-    Node* current = root;
-    if (current) {
-        while (current->left)
-            current = current->left;
-    }
-    return const_iterator(current, this);
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::begin() const {
+    return const_iterator(leftmost, this);
 }
 
 
@@ -758,8 +4918,8 @@ typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::begin() const
  * Returns:
  *  - A const_iterator pointing to nullptr.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::end() const {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::end() const {
     return const_iterator(nullptr, this);
 }
 
@@ -772,8 +4932,8 @@ typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::end() const {
  * Returns:
  *  - A const_iterator to the first element.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::cbegin() const {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::cbegin() const {
     return begin();
 }
 
@@ -786,7 +4946,138 @@ typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::cbegin() const
  * Returns:
  *  - A const_iterator to one past the last element.
  ***************************************/
-template <typename T, typename Compare>
-typename AVLTree<T, Compare>::const_iterator AVLTree<T, Compare>::cend() const {
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_iterator AVLTree<T, Compare, Allocator, Policy>::cend() const {
     return end();
 }
+
+
+/***************************************
+ * rbegin (non-const)
+ *
+ * Returns a reverse iterator to the last (largest) element.
+ *
+ * Returns:
+ *  - A reverse_iterator wrapping end(); dereferencing it reaches the
+ *    cached rightmost node in O(1).
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::reverse_iterator AVLTree<T, Compare, Allocator, Policy>::rbegin() {
+    return reverse_iterator(end());
+}
+
+
+/***************************************
+ * rend (non-const)
+ *
+ * Returns:
+ *  - A reverse_iterator one before the first element.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::reverse_iterator AVLTree<T, Compare, Allocator, Policy>::rend() {
+    return reverse_iterator(begin());
+}
+
+
+/***************************************
+ * rbegin (const)
+ *
+ * Returns:
+ *  - A const_reverse_iterator to the last (largest) element.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_reverse_iterator AVLTree<T, Compare, Allocator, Policy>::rbegin() const {
+    return const_reverse_iterator(end());
+}
+
+
+/***************************************
+ * rend (const)
+ *
+ * Returns:
+ *  - A const_reverse_iterator one before the first element.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_reverse_iterator AVLTree<T, Compare, Allocator, Policy>::rend() const {
+    return const_reverse_iterator(begin());
+}
+
+
+/***************************************
+ * crbegin
+ *
+ * Returns:
+ *  - A const_reverse_iterator to the last (largest) element.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_reverse_iterator AVLTree<T, Compare, Allocator, Policy>::crbegin() const {
+    return rbegin();
+}
+
+
+/***************************************
+ * crend
+ *
+ * Returns:
+ *  - A const_reverse_iterator one before the first element.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+typename AVLTree<T, Compare, Allocator, Policy>::const_reverse_iterator AVLTree<T, Compare, Allocator, Policy>::crend() const {
+    return rend();
+}
+
+
+/***************************************
+ * front
+ *
+ * Returns:
+ *  - The smallest key in O(1). The tree must not be empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+const T& AVLTree<T, Compare, Allocator, Policy>::front() const {
+    return leftmost->key;
+}
+
+
+/***************************************
+ * back
+ *
+ * Returns:
+ *  - The largest key in O(1). The tree must not be empty.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+const T& AVLTree<T, Compare, Allocator, Policy>::back() const {
+    return rightmost->key;
+}
+
+
+/***************************************
+ * pop_front
+ *
+ * Removes the smallest key. The tree must not be empty.
+ *
+ * Behavior:
+ *  - The leftmost node has no left child, so it is unlinked directly
+ *    (no successor search); the successor becomes the new leftmost
+ *    node. Suited to priority-queue style use.
+ *  - A multiset drops one copy at a time.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::pop_front() {
+    eraseOne(leftmost);
+}
+
+
+/***************************************
+ * pop_back
+ *
+ * Removes the largest key. The tree must not be empty.
+ *
+ * Behavior:
+ *  - The rightmost node has no right child, so it is unlinked directly.
+ *  - A multiset drops one copy at a time.
+ ***************************************/
+template <typename T, typename Compare, typename Allocator, typename Policy>
+void AVLTree<T, Compare, Allocator, Policy>::pop_back() {
+    eraseOne(rightmost);
+}
@@ -0,0 +1,137 @@
+#ifndef AVLTREESTATSHPP
+#define AVLTREESTATSHPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+
+/***************************************
+ * AVLTreeStats
+ *
+ * A snapshot of the counters an AVLTree keeps under a policy with
+ * stats enabled. Counts run from construction (or the last
+ * reset_stats()); size and height describe the tree at the time of
+ * the snapshot.
+ ***************************************/
+struct AVLTreeStats {
+    // Comparator calls made by the tree itself (sorting a batch with
+    // std::stable_sort is not included).
+    std::uint64_t comparisons = 0;
+    // find / lower_bound / upper_bound style descents, and the nodes
+    // they visited between them.
+    std::uint64_t searches = 0;
+    std::uint64_t nodes_visited = 0;
+    // Rebalancing: a double rotation counts once, not as two singles.
+    std::uint64_t single_rotations = 0;
+    std::uint64_t double_rotations = 0;
+    // Calls into the node allocator; a slab for a bulk build is one.
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::size_t size = 0;
+    int height = 0;
+
+    double mean_nodes_visited() const;
+    void write_prometheus(std::ostream& out, const std::string& prefix = "avl_tree",
+                          const std::string& labels = "") const;
+};
+
+
+/***************************************
+ * AVLStatCounter
+ *
+ * One event counter. const searches may run on several threads at
+ * once, so the value is atomic, but it is bumped with a relaxed load
+ * and store rather than a locked read-modify-write: that keeps the
+ * hot path a plain add, at the price of losing increments that race.
+ * Copies start from zero and assignment leaves the target alone, so
+ * counters stay with the tree object that made the calls.
+ ***************************************/
+class AVLStatCounter {
+private:
+    mutable std::atomic<std::uint64_t> value;
+
+public:
+    AVLStatCounter() : value(0) {}
+    AVLStatCounter(const AVLStatCounter&) : value(0) {}
+    AVLStatCounter& operator=(const AVLStatCounter&) {
+        return *this;
+    }
+
+    void add(std::uint64_t n = 1) const {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    std::uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+    void reset() {
+        value.store(0, std::memory_order_relaxed);
+    }
+};
+
+
+/***************************************
+ * AVLTreeCounters
+ *
+ * The counting state AVLTree inherits from. With stats disabled it is
+ * empty and every hook is an empty inline function, so the tree pays
+ * neither bytes (empty base) nor instructions.
+ ***************************************/
+template <bool Enabled>
+struct AVLTreeCounters {
+    void countComparison() const {}
+    void countSearch(std::size_t) const {}
+    void countRotation(bool) const {}
+    void countAllocation() const {}
+    void countDeallocation(std::size_t = 1) const {}
+};
+
+template <>
+struct AVLTreeCounters<true> {
+    AVLStatCounter comparison_count;
+    AVLStatCounter search_count;
+    AVLStatCounter visited_count;
+    AVLStatCounter single_rotation_count;
+    AVLStatCounter double_rotation_count;
+    AVLStatCounter allocation_count;
+    AVLStatCounter deallocation_count;
+
+    // Called with a snapshot every sample_period insertions/removals.
+    std::function<void(const AVLTreeStats&)> sampler;
+    std::size_t sample_period = 0;
+    std::size_t until_sample = 0;
+
+    AVLTreeCounters() = default;
+    // Like the counters, the sampler is not copied along with a tree.
+    AVLTreeCounters(const AVLTreeCounters&) {}
+    AVLTreeCounters& operator=(const AVLTreeCounters&) {
+        return *this;
+    }
+
+    void countComparison() const {
+        comparison_count.add();
+    }
+    void countSearch(std::size_t visited) const {
+        search_count.add();
+        visited_count.add(visited);
+    }
+    void countRotation(bool isDouble) const {
+        (isDouble ? double_rotation_count : single_rotation_count).add();
+    }
+    void countAllocation() const {
+        allocation_count.add();
+    }
+    void countDeallocation(std::size_t n = 1) const {
+        deallocation_count.add(n);
+    }
+
+    void fillStats(AVLTreeStats& stats) const;
+    void resetCounts();
+    bool sampleDue();
+};
+
+#include "AVLTreeStatsImplementation.tpp"
+
+#endif
@@ -0,0 +1,107 @@
+#include "AVLTreeStatsHeader.hpp"
+
+/***************************************
+ * AVLTreeStats::mean_nodes_visited
+ *
+ * Returns:
+ *  - Nodes visited per search, or 0 before the first search.
+ ***************************************/
+inline double AVLTreeStats::mean_nodes_visited() const {
+    return searches ? static_cast<double>(nodes_visited) / static_cast<double>(searches) : 0.0;
+}
+
+
+/***************************************
+ * AVLTreeStats::write_prometheus
+ *
+ * Writes the snapshot in the Prometheus text exposition format.
+ *
+ * Parameters:
+ *  - out: The stream to write to, e.g. a /metrics response body.
+ *  - prefix: Metric name prefix; one tree per prefix, or tell trees
+ *    apart with labels.
+ *  - labels: Extra labels without braces, e.g. tree="sessions";
+ *    values must already be escaped.
+ *
+ * Behavior:
+ *  - Counts become *_total counters, rotations one counter split by
+ *    a kind label, and size and height gauges.
+ ***************************************/
+inline void AVLTreeStats::write_prometheus(std::ostream& out, const std::string& prefix,
+                                           const std::string& labels) const {
+    const std::string plain = labels.empty() ? std::string() : "{" + labels + "}";
+    const std::string sep = labels.empty() ? std::string() : labels + ",";
+    auto metric = [&](const char* name, const char* type, const char* help) {
+        out << "# HELP " << prefix << '_' << name << ' ' << help << '\n';
+        out << "# TYPE " << prefix << '_' << name << ' ' << type << '\n';
+    };
+
+    metric("comparisons_total", "counter", "Comparator calls.");
+    out << prefix << "_comparisons_total" << plain << ' ' << comparisons << '\n';
+    metric("searches_total", "counter", "Lookup descents.");
+    out << prefix << "_searches_total" << plain << ' ' << searches << '\n';
+    metric("nodes_visited_total", "counter", "Nodes visited by lookup descents.");
+    out << prefix << "_nodes_visited_total" << plain << ' ' << nodes_visited << '\n';
+    metric("rotations_total", "counter", "Rebalancing rotations.");
+    out << prefix << "_rotations_total{" << sep << "kind=\"single\"} " << single_rotations << '\n';
+    out << prefix << "_rotations_total{" << sep << "kind=\"double\"} " << double_rotations << '\n';
+    metric("allocations_total", "counter", "Node allocator calls.");
+    out << prefix << "_allocations_total" << plain << ' ' << allocations << '\n';
+    metric("deallocations_total", "counter", "Node deallocator calls.");
+    out << prefix << "_deallocations_total" << plain << ' ' << deallocations << '\n';
+    metric("size", "gauge", "Number of keys.");
+    out << prefix << "_size" << plain << ' ' << size << '\n';
+    metric("height", "gauge", "Height of the tree.");
+    out << prefix << "_height" << plain << ' ' << height << '\n';
+}
+
+
+/***************************************
+ * AVLTreeCounters<true>::fillStats
+ *
+ * Copies the event counts into a snapshot; the tree fills in size and
+ * height.
+ ***************************************/
+inline void AVLTreeCounters<true>::fillStats(AVLTreeStats& stats) const {
+    stats.comparisons = comparison_count.get();
+    stats.searches = search_count.get();
+    stats.nodes_visited = visited_count.get();
+    stats.single_rotations = single_rotation_count.get();
+    stats.double_rotations = double_rotation_count.get();
+    stats.allocations = allocation_count.get();
+    stats.deallocations = deallocation_count.get();
+}
+
+
+/***************************************
+ * AVLTreeCounters<true>::resetCounts
+ *
+ * Zeroes every event count; the sampler and its period are kept.
+ ***************************************/
+inline void AVLTreeCounters<true>::resetCounts() {
+    comparison_count.reset();
+    search_count.reset();
+    visited_count.reset();
+    single_rotation_count.reset();
+    double_rotation_count.reset();
+    allocation_count.reset();
+    deallocation_count.reset();
+}
+
+
+/***************************************
+ * AVLTreeCounters<true>::sampleDue
+ *
+ * Records one insertion or removal.
+ *
+ * Returns:
+ *  - true if a sampler is installed and this was the sample_period-th
+ *    change since the last sample.
+ ***************************************/
+inline bool AVLTreeCounters<true>::sampleDue() {
+    if (!sampler || --until_sample != 0) {
+        return false;
+    }
+    until_sample = sample_period;
+    return true;
+}
@@ -0,0 +1,142 @@
+#ifndef STATICAVLTREEHPP
+#define STATICAVLTREEHPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+/***************************************
+ * StaticAVLTree
+ *
+ * A fixed-capacity AVL set whose nodes live in a std::array and link
+ * to each other by index, so that every operation is constexpr. A
+ * table declared
+ *
+ *     static constexpr StaticAVLTree<int, 4> opcodes{0x10, 0x20, 0x31, 0x7f};
+ *
+ * is built by the compiler, placed in read-only data and costs nothing
+ * at startup. It can also be filled at run time like any other set.
+ *
+ *  - Indices are the narrowest unsigned type that can hold N plus a
+ *    null marker, so a table of up to 254 keys spends three bytes on
+ *    links per node.
+ *  - T must be a literal type with a default constructor (integers,
+ *    enums, std::string_view, small structs); the comparator must be
+ *    usable in constant expressions, as std::less is.
+ *  - Inserting past N keys throws std::length_error, which in a
+ *    constant expression is a compile error. There is no erase: the
+ *    tree is meant for tables that are written once.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare = std::less<T> >
+class StaticAVLTree {
+    static_assert(N > 0, "StaticAVLTree needs a capacity of at least one key");
+    static_assert(std::is_default_constructible<T>::value, "StaticAVLTree keys must be default constructible");
+
+public:
+    using index_type = typename std::conditional<(N < 0xFF), std::uint8_t,
+                       typename std::conditional<(N < 0xFFFF), std::uint16_t, std::uint32_t>::type>::type;
+
+private:
+    static constexpr index_type nil = static_cast<index_type>(-1);
+
+    struct Node {
+        T key{};
+        index_type left = nil;
+        index_type right = nil;
+        index_type parent = nil;
+        std::int8_t height = 0;
+    };
+
+    std::array<Node, N> nodes{};
+    index_type root = nil;
+    index_type node_count = 0;
+    Compare comp{};
+
+    constexpr int height(index_type node) const;
+    constexpr int getBalanceFactor(index_type node) const;
+    constexpr void updateHeight(index_type node);
+    constexpr index_type rightRotate(index_type y);
+    constexpr index_type leftRotate(index_type x);
+    constexpr void replaceChild(index_type parent, index_type oldChild, index_type newChild);
+    constexpr void rebalance(index_type node);
+    constexpr index_type minIndex(index_type node) const;
+    constexpr index_type maxIndex(index_type node) const;
+    constexpr index_type nextIndex(index_type node) const;
+    constexpr index_type prevIndex(index_type node) const;
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+
+    class const_iterator {
+        friend class StaticAVLTree;
+    private:
+        const StaticAVLTree* tree = nullptr;
+        index_type index = nil;
+
+        constexpr const_iterator(const StaticAVLTree* t, index_type i) : tree(t), index(i) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        constexpr const_iterator() = default;
+
+        constexpr reference operator*() const {
+            return tree->nodes[index].key;
+        }
+        constexpr pointer operator->() const {
+            return &tree->nodes[index].key;
+        }
+        constexpr const_iterator& operator++();
+        constexpr const_iterator operator++(int);
+        constexpr const_iterator& operator--();
+        constexpr const_iterator operator--(int);
+
+        constexpr bool operator==(const const_iterator& other) const {
+            return index == other.index;
+        }
+
+        constexpr bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    using iterator = const_iterator;
+
+    constexpr StaticAVLTree() = default;
+    constexpr explicit StaticAVLTree(const Compare& compare);
+    constexpr StaticAVLTree(std::initializer_list<T> keys, const Compare& compare = Compare());
+
+    constexpr bool insert(const T& key);
+
+    constexpr const_iterator begin() const;
+    constexpr const_iterator end() const;
+    constexpr const_iterator cbegin() const;
+    constexpr const_iterator cend() const;
+
+    constexpr bool empty() const;
+    constexpr std::size_t size() const;
+    static constexpr std::size_t capacity() {
+        return N;
+    }
+
+    constexpr const_iterator find(const T& key) const;
+    constexpr const_iterator lower_bound(const T& key) const;
+    constexpr const_iterator upper_bound(const T& key) const;
+    constexpr bool contains(const T& key) const;
+    constexpr std::size_t count(const T& key) const;
+};
+
+#include "StaticAVLTreeImplementation.tpp"
+
+#endif
@@ -0,0 +1,497 @@
+#include "StaticAVLTreeHeader.hpp"
+
+/***************************************
+ * StaticAVLTree Constructor (comparator)
+ *
+ * Initializes an empty tree with a custom comparator.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr StaticAVLTree<T, N, Compare>::StaticAVLTree(const Compare& compare)
+    : comp(compare) {}
+
+
+/***************************************
+ * StaticAVLTree Constructor (key list)
+ *
+ * Inserts each key in turn; duplicates are ignored.
+ *
+ * Parameters:
+ *  - keys: The keys, in any order; at most N distinct ones.
+ *  - compare: The comparison functor to order keys.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr StaticAVLTree<T, N, Compare>::StaticAVLTree(std::initializer_list<T> keys, const Compare& compare)
+    : comp(compare) {
+    for (const T& key : keys) {
+        insert(key);
+    }
+}
+
+
+/***************************************
+ * height (private helper)
+ *
+ * Returns:
+ *  - The node's height, or 0 for nil.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr int StaticAVLTree<T, N, Compare>::height(index_type node) const {
+    return node == nil ? 0 : nodes[node].height;
+}
+
+
+/***************************************
+ * getBalanceFactor (private helper)
+ *
+ * Returns:
+ *  - Height of the left subtree minus height of the right subtree.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr int StaticAVLTree<T, N, Compare>::getBalanceFactor(index_type node) const {
+    return height(nodes[node].left) - height(nodes[node].right);
+}
+
+
+/***************************************
+ * updateHeight (private helper)
+ *
+ * Recomputes a node's height from its children.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr void StaticAVLTree<T, N, Compare>::updateHeight(index_type node) {
+    const int left = height(nodes[node].left);
+    const int right = height(nodes[node].right);
+    nodes[node].height = static_cast<std::int8_t>(1 + (left > right ? left : right));
+}
+
+
+/***************************************
+ * rightRotate (private helper)
+ *
+ * Performs a right rotation on the subtree rooted at y.
+ *
+ * Returns:
+ *  - The new subtree root; its parent link is taken over from y, but
+ *    the parent's child link is left to the caller.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::index_type StaticAVLTree<T, N, Compare>::rightRotate(index_type y) {
+    const index_type x = nodes[y].left;
+    const index_type T2 = nodes[x].right;
+
+    nodes[x].right = y;
+    nodes[y].left = T2;
+
+    nodes[x].parent = nodes[y].parent;
+    nodes[y].parent = x;
+    if (T2 != nil) {
+        nodes[T2].parent = y;
+    }
+
+    updateHeight(y);
+    updateHeight(x);
+    return x;
+}
+
+
+/***************************************
+ * leftRotate (private helper)
+ *
+ * Mirror image of rightRotate.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::index_type StaticAVLTree<T, N, Compare>::leftRotate(index_type x) {
+    const index_type y = nodes[x].right;
+    const index_type T2 = nodes[y].left;
+
+    nodes[y].left = x;
+    nodes[x].right = T2;
+
+    nodes[y].parent = nodes[x].parent;
+    nodes[x].parent = y;
+    if (T2 != nil) {
+        nodes[T2].parent = x;
+    }
+
+    updateHeight(x);
+    updateHeight(y);
+    return y;
+}
+
+
+/***************************************
+ * replaceChild (private helper)
+ *
+ * Re-points the link that referred to oldChild; updates root when
+ * parent is nil.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr void StaticAVLTree<T, N, Compare>::replaceChild(index_type parent, index_type oldChild, index_type newChild) {
+    if (parent == nil) {
+        root = newChild;
+    }
+    else if (nodes[parent].left == oldChild) {
+        nodes[parent].left = newChild;
+    }
+    else {
+        nodes[parent].right = newChild;
+    }
+}
+
+
+/***************************************
+ * rebalance (private helper)
+ *
+ * Restores the AVL property at a node whose balance factor is +-2 and
+ * links the new subtree root into place.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr void StaticAVLTree<T, N, Compare>::rebalance(index_type node) {
+    const index_type parent = nodes[node].parent;
+    index_type subtree = node;
+    if (getBalanceFactor(node) > 1) {
+        if (getBalanceFactor(nodes[node].left) < 0) {
+            nodes[node].left = leftRotate(nodes[node].left);
+        }
+        subtree = rightRotate(node);
+    }
+    else {
+        if (getBalanceFactor(nodes[node].right) > 0) {
+            nodes[node].right = rightRotate(nodes[node].right);
+        }
+        subtree = leftRotate(node);
+    }
+    replaceChild(parent, node, subtree);
+}
+
+
+/***************************************
+ * minIndex / maxIndex (private helpers)
+ *
+ * Returns:
+ *  - The first or last node of a subtree, or nil if it is empty.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::index_type StaticAVLTree<T, N, Compare>::minIndex(index_type node) const {
+    while (node != nil && nodes[node].left != nil) {
+        node = nodes[node].left;
+    }
+    return node;
+}
+
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::index_type StaticAVLTree<T, N, Compare>::maxIndex(index_type node) const {
+    while (node != nil && nodes[node].right != nil) {
+        node = nodes[node].right;
+    }
+    return node;
+}
+
+
+/***************************************
+ * nextIndex / prevIndex (private helpers)
+ *
+ * Returns:
+ *  - The in-order successor or predecessor of a node, or nil.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::index_type StaticAVLTree<T, N, Compare>::nextIndex(index_type node) const {
+    if (nodes[node].right != nil) {
+        return minIndex(nodes[node].right);
+    }
+    index_type parent = nodes[node].parent;
+    while (parent != nil && node == nodes[parent].right) {
+        node = parent;
+        parent = nodes[parent].parent;
+    }
+    return parent;
+}
+
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::index_type StaticAVLTree<T, N, Compare>::prevIndex(index_type node) const {
+    if (nodes[node].left != nil) {
+        return maxIndex(nodes[node].left);
+    }
+    index_type parent = nodes[node].parent;
+    while (parent != nil && node == nodes[parent].left) {
+        node = parent;
+        parent = nodes[parent].parent;
+    }
+    return parent;
+}
+
+
+/***************************************
+ * insert
+ *
+ * Inserts a key unless an equivalent one is present.
+ *
+ * Returns:
+ *  - true if the key was inserted.
+ *
+ * Behavior:
+ *  - Takes the next free slot of the array and rebalances with the
+ *    usual AVL retrace, stopping at the first rotation or unchanged
+ *    height.
+ *  - Throws std::length_error if N keys are already stored.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr bool StaticAVLTree<T, N, Compare>::insert(const T& key) {
+    index_type parent = nil;
+    index_type current = root;
+    bool goLeft = false;
+    while (current != nil) {
+        parent = current;
+        if (comp(key, nodes[current].key)) {
+            current = nodes[current].left;
+            goLeft = true;
+        }
+        else if (comp(nodes[current].key, key)) {
+            current = nodes[current].right;
+            goLeft = false;
+        }
+        else {
+            return false;
+        }
+    }
+    if (node_count == N) {
+        throw std::length_error("StaticAVLTree capacity exceeded");
+    }
+
+    const index_type node = node_count++;
+    nodes[node].key = key;
+    nodes[node].left = nil;
+    nodes[node].right = nil;
+    nodes[node].parent = parent;
+    nodes[node].height = 1;
+    if (parent == nil) {
+        root = node;
+    }
+    else if (goLeft) {
+        nodes[parent].left = node;
+    }
+    else {
+        nodes[parent].right = node;
+    }
+
+    for (index_type p = parent; p != nil; p = nodes[p].parent) {
+        const int oldHeight = nodes[p].height;
+        updateHeight(p);
+        const int balance = getBalanceFactor(p);
+        if (balance > 1 || balance < -1) {
+            rebalance(p);
+            break;
+        }
+        if (nodes[p].height == oldHeight) {
+            break;
+        }
+    }
+    return true;
+}
+
+
+/***************************************
+ * begin
+ *
+ * Returns:
+ *  - An iterator to the smallest key.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::begin() const {
+    return const_iterator(this, minIndex(root));
+}
+
+
+/***************************************
+ * end
+ *
+ * Returns:
+ *  - The past-the-end iterator.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::end() const {
+    return const_iterator(this, nil);
+}
+
+
+/***************************************
+ * cbegin
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::cbegin() const {
+    return begin();
+}
+
+
+/***************************************
+ * cend
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::cend() const {
+    return end();
+}
+
+
+/***************************************
+ * empty
+ *
+ * Returns:
+ *  - true if the tree holds no keys.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr bool StaticAVLTree<T, N, Compare>::empty() const {
+    return node_count == 0;
+}
+
+
+/***************************************
+ * size
+ *
+ * Returns:
+ *  - The number of keys.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr std::size_t StaticAVLTree<T, N, Compare>::size() const {
+    return node_count;
+}
+
+
+/***************************************
+ * find
+ *
+ * Returns:
+ *  - An iterator to the key equivalent to key, or end().
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::find(const T& key) const {
+    index_type current = root;
+    while (current != nil) {
+        if (comp(key, nodes[current].key)) {
+            current = nodes[current].left;
+        }
+        else if (comp(nodes[current].key, key)) {
+            current = nodes[current].right;
+        }
+        else {
+            break;
+        }
+    }
+    return const_iterator(this, current);
+}
+
+
+/***************************************
+ * lower_bound
+ *
+ * Returns:
+ *  - An iterator to the first key not less than key, or end().
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::lower_bound(const T& key) const {
+    index_type current = root;
+    index_type result = nil;
+    while (current != nil) {
+        if (!comp(nodes[current].key, key)) {
+            result = current;
+            current = nodes[current].left;
+        }
+        else {
+            current = nodes[current].right;
+        }
+    }
+    return const_iterator(this, result);
+}
+
+
+/***************************************
+ * upper_bound
+ *
+ * Returns:
+ *  - An iterator to the first key greater than key, or end().
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::upper_bound(const T& key) const {
+    index_type current = root;
+    index_type result = nil;
+    while (current != nil) {
+        if (comp(key, nodes[current].key)) {
+            result = current;
+            current = nodes[current].left;
+        }
+        else {
+            current = nodes[current].right;
+        }
+    }
+    return const_iterator(this, result);
+}
+
+
+/***************************************
+ * contains
+ *
+ * Returns:
+ *  - true if a key equivalent to key is present.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr bool StaticAVLTree<T, N, Compare>::contains(const T& key) const {
+    return find(key) != end();
+}
+
+
+/***************************************
+ * count
+ *
+ * Returns:
+ *  - 1 if key is present, 0 otherwise.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr std::size_t StaticAVLTree<T, N, Compare>::count(const T& key) const {
+    return contains(key) ? 1 : 0;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Pre-increment)
+ *
+ * Advances to the in-order successor.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator& StaticAVLTree<T, N, Compare>::const_iterator::operator++() {
+    index = tree->nextIndex(index);
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator++ (Post-increment)
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::const_iterator::operator++(int) {
+    const_iterator temp = *this;
+    ++(*this);
+    return temp;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Pre-decrement)
+ *
+ * Moves to the in-order predecessor; from end() it moves to the
+ * largest key.
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator& StaticAVLTree<T, N, Compare>::const_iterator::operator--() {
+    index = index == nil ? tree->maxIndex(tree->root) : tree->prevIndex(index);
+    return *this;
+}
+
+
+/***************************************
+ * const_iterator::operator-- (Post-decrement)
+ ***************************************/
+template <typename T, std::size_t N, typename Compare>
+constexpr typename StaticAVLTree<T, N, Compare>::const_iterator StaticAVLTree<T, N, Compare>::const_iterator::operator--(int) {
+    const_iterator temp = *this;
+    --(*this);
+    return temp;
+}
@@ -0,0 +1,690 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "AVLTreeHeader.hpp"
+#include "AVLCompactTreeHeader.hpp"
+#include "AVLBlockTreeHeader.hpp"
+#include "AVLIndexedTreeHeader.hpp"
+
+// Self-contained benchmark harness comparing the AVL containers against
+// std::set. Build with:
+//
+//   g++ -std=c++17 -O2 -DNDEBUG -o avl_bench benchmark.cpp
+//
+// and run `./avl_bench --help` for the options.
+
+using Key = std::uint32_t;
+
+namespace {
+
+/***************************************
+ * Options
+ *
+ * Command-line settings for a benchmark run.
+ ***************************************/
+struct Options {
+    std::size_t min_size = 1000;
+    std::size_t max_size = 1000000;
+    std::string filter;
+    bool csv = false;
+    std::uint64_t seed = 42;
+};
+
+
+/***************************************
+ * Zipf
+ *
+ * Draws ranks in [1, n] with P(k) proportional to 1 / k^s using
+ * rejection-inversion sampling (Hoermann & Derflinger), so no table
+ * of n probabilities is needed even for 100M keys.
+ ***************************************/
+class Zipf {
+public:
+    Zipf(std::size_t n, double exponent) : n(static_cast<double>(n)), s(exponent) {
+        hIntegralX1 = hIntegral(1.5) - 1.0;
+        hIntegralN = hIntegral(this->n + 0.5);
+        cutoff = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+
+    template <typename Rng>
+    std::size_t operator()(Rng& rng) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (;;) {
+            double u = hIntegralN + uniform(rng) * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            double k = std::floor(x + 0.5);
+            if (k < 1.0) {
+                k = 1.0;
+            }
+            else if (k > n) {
+                k = n;
+            }
+            if (k - x <= cutoff || u >= hIntegral(k + 0.5) - h(k)) {
+                return static_cast<std::size_t>(k);
+            }
+        }
+    }
+
+private:
+    static double helper1(double x) {
+        return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+    static double helper2(double x) {
+        return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+    }
+    double h(double x) const {
+        return std::exp(-s * std::log(x));
+    }
+    double hIntegral(double x) const {
+        double logX = std::log(x);
+        return helper2((1.0 - s) * logX) * logX;
+    }
+    double hIntegralInverse(double x) const {
+        double t = x * (1.0 - s);
+        if (t < -1.0) {
+            t = -1.0;
+        }
+        return std::exp(helper1(t) * x);
+    }
+
+    double n;
+    double s;
+    double hIntegralX1;
+    double hIntegralN;
+    double cutoff;
+};
+
+
+/***************************************
+ * CacheMissCounter
+ *
+ * Wraps a perf_event hardware cache-miss counter. Reports -1 when the
+ * counter is unavailable (non-Linux, containers, perf_event_paranoid).
+ ***************************************/
+class CacheMissCounter {
+public:
+    CacheMissCounter() : fd(-1) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    void start() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long value = 0;
+            if (read(fd, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))) {
+                return value;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd;
+};
+
+
+/***************************************
+ * heapBytes
+ *
+ * Returns:
+ *  - Bytes currently in use on the heap (glibc 2.33+), otherwise the
+ *    resident set size of the process, or 0 if neither is known.
+ *
+ * Behavior:
+ *  - The heap figure still counts memory recycled from earlier
+ *    containers, which an RSS delta would miss.
+ ***************************************/
+std::size_t heapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#elif defined(__linux__)
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) {
+        return 0;
+    }
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    int read = std::fscanf(f, "%lu %lu", &pages, &resident);
+    std::fclose(f);
+    if (read != 2) {
+        return 0;
+    }
+    return static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+
+/***************************************
+ * Result
+ *
+ * One measured workload.
+ ***************************************/
+struct Result {
+    double ns_per_op;
+    long long cache_misses;
+    std::size_t ops;
+    // AVL rotations performed, or -1 for a container without stats().
+    long long rotations;
+};
+
+// Written to after every workload so the optimizer cannot drop lookups.
+volatile std::size_t sink;
+
+
+/***************************************
+ * measure
+ *
+ * Times a workload and samples the cache-miss counter around it.
+ *
+ * Parameters:
+ *  - ops: Number of operations the workload performs.
+ *  - body: The workload itself.
+ ***************************************/
+template <typename Body>
+Result measure(std::size_t ops, Body&& body) {
+    static CacheMissCounter counter;
+    counter.start();
+    auto begin = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    long long misses = counter.stop();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    return Result{ops ? ns / static_cast<double>(ops) : 0.0, misses, ops, -1};
+}
+
+
+// Trees built with a stats policy also report rotations per op.
+template <typename Container>
+struct HasStats : std::false_type {};
+
+template <typename T, typename Compare, typename Allocator, typename Policy>
+struct HasStats<AVLTree<T, Compare, Allocator, Policy> > : std::integral_constant<bool, Policy::stats> {};
+
+
+/***************************************
+ * measureOn
+ *
+ * Same as measure(), and for a tree with stats() also records the
+ * rotations the workload made in it.
+ *
+ * Parameters:
+ *  - tree: The container the workload runs against.
+ ***************************************/
+template <typename Container, typename Body>
+Result measureOn(const Container& tree, std::size_t ops, Body&& body) {
+    if constexpr (HasStats<Container>::value) {
+        const AVLTreeStats before = tree.stats();
+        Result r = measure(ops, std::forward<Body>(body));
+        const AVLTreeStats after = tree.stats();
+        r.rotations = static_cast<long long>((after.single_rotations + after.double_rotations) -
+                                             (before.single_rotations + before.double_rotations));
+        return r;
+    }
+    else {
+        (void)tree;
+        return measure(ops, std::forward<Body>(body));
+    }
+}
+
+
+/***************************************
+ * Reporter
+ *
+ * Prints results either as an aligned table or as CSV.
+ ***************************************/
+class Reporter {
+public:
+    explicit Reporter(bool csv) : csv(csv) {
+        if (csv) {
+            std::printf("container,workload,size,ns_per_op,cache_misses_per_op,mem_bytes_per_key,rotations_per_op\n");
+        }
+        else {
+            std::printf("%-16s %-16s %11s %11s %14s %12s %10s\n",
+                        "container", "workload", "size", "ns/op", "misses/op", "mem B/key", "rot/op");
+        }
+    }
+
+    void row(const char* container, const char* workload, std::size_t size, const Result& r, double memPerKey) {
+        double missesPerOp = r.cache_misses < 0 || r.ops == 0 ? -1.0
+                           : static_cast<double>(r.cache_misses) / static_cast<double>(r.ops);
+        double rotationsPerOp = r.rotations < 0 || r.ops == 0 ? -1.0
+                              : static_cast<double>(r.rotations) / static_cast<double>(r.ops);
+        if (csv) {
+            std::printf("%s,%s,%zu,%.2f,%.3f,%.1f,%.4f\n", container, workload, size, r.ns_per_op, missesPerOp, memPerKey,
+                        rotationsPerOp);
+            return;
+        }
+        char misses[32];
+        char mem[32];
+        char rotations[32];
+        if (missesPerOp < 0) {
+            std::snprintf(misses, sizeof(misses), "-");
+        }
+        else {
+            std::snprintf(misses, sizeof(misses), "%.3f", missesPerOp);
+        }
+        if (memPerKey < 0) {
+            std::snprintf(mem, sizeof(mem), "-");
+        }
+        else {
+            std::snprintf(mem, sizeof(mem), "%.1f", memPerKey);
+        }
+        if (rotationsPerOp < 0) {
+            std::snprintf(rotations, sizeof(rotations), "-");
+        }
+        else {
+            std::snprintf(rotations, sizeof(rotations), "%.4f", rotationsPerOp);
+        }
+        std::printf("%-16s %-16s %11zu %11.2f %14s %12s %10s\n", container, workload, size, r.ns_per_op, misses, mem,
+                    rotations);
+        std::fflush(stdout);
+    }
+
+private:
+    bool csv;
+};
+
+
+/***************************************
+ * Workload keys
+ *
+ * Key sequences shared by every container at a given size.
+ ***************************************/
+struct Workload {
+    std::vector<Key> sorted;
+    std::vector<Key> shuffled;
+    std::vector<Key> zipf;
+    std::vector<Key> mixedKeys;
+    std::vector<std::uint8_t> mixedOps;
+};
+
+Workload makeWorkload(std::size_t n, std::uint64_t seed) {
+    Workload w;
+    std::mt19937_64 rng(seed);
+    // Even keys are present after the build; odd keys are misses.
+    w.sorted.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        w.sorted[i] = static_cast<Key>(2 * i);
+    }
+    w.shuffled = w.sorted;
+    std::shuffle(w.shuffled.begin(), w.shuffled.end(), rng);
+
+    // Hot ranks are scattered over the key space by indexing the
+    // shuffled order rather than the sorted one.
+    Zipf zipf(n, 0.99);
+    w.zipf.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        w.zipf[i] = w.shuffled[zipf(rng) - 1];
+    }
+
+    // Mixed read/write: 80% finds, 10% inserts, 10% erases over a
+    // Zipf-distributed key space that includes absent (odd) keys.
+    w.mixedKeys.resize(n);
+    w.mixedOps.resize(n);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (std::size_t i = 0; i < n; ++i) {
+        int p = percent(rng);
+        w.mixedOps[i] = static_cast<std::uint8_t>(p < 80 ? 0 : (p < 90 ? 1 : 2));
+        w.mixedKeys[i] = w.zipf[i] + static_cast<Key>(p & 1);
+    }
+    return w;
+}
+
+
+// Containers with a batched contains_many() also run find-batch.
+template <typename Container, typename = void>
+struct HasFindMany : std::false_type {};
+
+template <typename Container>
+struct HasFindMany<Container, decltype(void(std::declval<const Container&>().contains_many(
+    std::declval<const Key*>(), std::declval<const Key*>(), std::declval<char*>())))> : std::true_type {};
+
+
+/***************************************
+ * containsBatched
+ *
+ * Probes every key through contains_many() in batches of 4096, the
+ * way a join probes a batch of rows.
+ *
+ * Returns:
+ *  - The number of hits.
+ ***************************************/
+template <typename Container>
+std::size_t containsBatched(const Container& c, const std::vector<Key>& keys) {
+    const std::size_t batch = 4096;
+    std::vector<char> found(batch);
+    std::size_t hits = 0;
+    for (std::size_t i = 0; i < keys.size(); i += batch) {
+        const std::size_t m = std::min(batch, keys.size() - i);
+        c.contains_many(keys.data() + i, keys.data() + i + m, found.data());
+        hits += static_cast<std::size_t>(std::count(found.begin(), found.begin() + m, 1));
+    }
+    return hits;
+}
+
+
+/***************************************
+ * runContainer
+ *
+ * Runs every workload against one container type.
+ *
+ * Parameters:
+ *  - name: Label printed in the report.
+ *  - w: The shared key sequences.
+ *  - opts: Command-line options (for the filter).
+ *  - report: Where results go.
+ ***************************************/
+template <typename Container>
+void runContainer(const char* name, const Workload& w, const Options& opts, Reporter& report) {
+    const std::size_t n = w.sorted.size();
+    auto wanted = [&](const char* workload) {
+        if (opts.filter.empty()) {
+            return true;
+        }
+        std::string label = std::string(name) + "/" + workload;
+        return label.find(opts.filter) != std::string::npos;
+    };
+    auto insertAll = [](Container& c, const std::vector<Key>& keys) {
+        for (Key k : keys) {
+            c.insert(k);
+        }
+    };
+
+    if (wanted("insert-sorted")) {
+        Container c;
+        Result r = measureOn(c, n, [&] { insertAll(c, w.sorted); });
+        report.row(name, "insert-sorted", n, r, -1.0);
+    }
+    if (wanted("insert-reverse")) {
+        std::vector<Key> reverse(w.sorted.rbegin(), w.sorted.rend());
+        Container c;
+        Result r = measureOn(c, n, [&] { insertAll(c, reverse); });
+        report.row(name, "insert-reverse", n, r, -1.0);
+    }
+
+    // The random build doubles as the fixture for the read workloads.
+    std::size_t memBefore = heapBytes();
+    Container c;
+    Result build = measureOn(c, n, [&] { insertAll(c, w.shuffled); });
+    std::size_t memAfter = heapBytes();
+    double memPerKey = memBefore && memAfter >= memBefore
+                     ? static_cast<double>(memAfter - memBefore) / static_cast<double>(n) : -1.0;
+    if (wanted("insert-random")) {
+        report.row(name, "insert-random", n, build, memPerKey);
+    }
+
+    if (wanted("find-random")) {
+        Result r = measureOn(c, n, [&] {
+            std::size_t hits = 0;
+            for (Key k : w.shuffled) {
+                hits += c.find(k) != c.end();
+            }
+            sink = hits;
+        });
+        report.row(name, "find-random", n, r, -1.0);
+    }
+    if (wanted("find-miss")) {
+        Result r = measureOn(c, n, [&] {
+            std::size_t hits = 0;
+            for (Key k : w.shuffled) {
+                hits += c.find(k + 1) != c.end();
+            }
+            sink = hits;
+        });
+        report.row(name, "find-miss", n, r, -1.0);
+    }
+    if (wanted("find-zipf")) {
+        Result r = measureOn(c, n, [&] {
+            std::size_t hits = 0;
+            for (Key k : w.zipf) {
+                hits += c.find(k) != c.end();
+            }
+            sink = hits;
+        });
+        report.row(name, "find-zipf", n, r, -1.0);
+    }
+    if constexpr (HasFindMany<Container>::value) {
+        if (wanted("find-batch")) {
+            Result r = measureOn(c, n, [&] { sink = containsBatched(c, w.shuffled); });
+            report.row(name, "find-batch", n, r, -1.0);
+        }
+    }
+    if (wanted("iterate")) {
+        Result r = measureOn(c, n, [&] {
+            std::size_t sum = 0;
+            for (Key k : c) {
+                sum += k;
+            }
+            sink = sum;
+        });
+        report.row(name, "iterate", n, r, -1.0);
+    }
+    if (wanted("mixed")) {
+        Container m = c;
+        Result r = measureOn(m, n, [&] {
+            std::size_t hits = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                Key k = w.mixedKeys[i];
+                switch (w.mixedOps[i]) {
+                case 0:
+                    hits += m.find(k) != m.end();
+                    break;
+                case 1:
+                    m.insert(k);
+                    break;
+                default:
+                    m.erase(k);
+                    break;
+                }
+            }
+            sink = hits;
+        });
+        report.row(name, "mixed-80r20w", n, r, -1.0);
+    }
+    if (wanted("erase-random")) {
+        Result r = measureOn(c, n, [&] {
+            for (Key k : w.shuffled) {
+                c.erase(k);
+            }
+        });
+        report.row(name, "erase-random", n, r, -1.0);
+    }
+}
+
+
+/***************************************
+ * runFrozen
+ *
+ * Runs the read-only workloads against an AVLTree frozen into its
+ * Eytzinger layout. The build row times insert-random plus freeze().
+ ***************************************/
+void runFrozen(const char* name, const Workload& w, const Options& opts, Reporter& report) {
+    const std::size_t n = w.sorted.size();
+    auto wanted = [&](const char* workload) {
+        if (opts.filter.empty()) {
+            return true;
+        }
+        std::string label = std::string(name) + "/" + workload;
+        return label.find(opts.filter) != std::string::npos;
+    };
+
+    AVLFrozenTree<Key> c;
+    Result build = measure(n, [&] {
+        AVLTree<Key> tree;
+        for (Key k : w.shuffled) {
+            tree.insert(k);
+        }
+        c = tree.freeze();
+    });
+    if (wanted("insert-random")) {
+        report.row(name, "insert-random", n, build, static_cast<double>(sizeof(Key)));
+    }
+    if (wanted("find-random")) {
+        Result r = measure(n, [&] {
+            std::size_t hits = 0;
+            for (Key k : w.shuffled) {
+                hits += c.find(k) != c.end();
+            }
+            sink = hits;
+        });
+        report.row(name, "find-random", n, r, -1.0);
+    }
+    if (wanted("find-miss")) {
+        Result r = measure(n, [&] {
+            std::size_t hits = 0;
+            for (Key k : w.shuffled) {
+                hits += c.find(k + 1) != c.end();
+            }
+            sink = hits;
+        });
+        report.row(name, "find-miss", n, r, -1.0);
+    }
+    if (wanted("find-zipf")) {
+        Result r = measure(n, [&] {
+            std::size_t hits = 0;
+            for (Key k : w.zipf) {
+                hits += c.find(k) != c.end();
+            }
+            sink = hits;
+        });
+        report.row(name, "find-zipf", n, r, -1.0);
+    }
+    if (wanted("iterate")) {
+        Result r = measure(n, [&] {
+            std::size_t sum = 0;
+            for (Key k : c) {
+                sum += k;
+            }
+            sink = sum;
+        });
+        report.row(name, "iterate", n, r, -1.0);
+    }
+}
+
+/***************************************
+ * parseSize
+ *
+ * Parses sizes such as 1000, 1e6, 10K, 100M.
+ ***************************************/
+std::size_t parseSize(const char* text) {
+    char* end = nullptr;
+    double value = std::strtod(text, &end);
+    if (end && (*end == 'k' || *end == 'K')) {
+        value *= 1e3;
+    }
+    else if (end && (*end == 'm' || *end == 'M')) {
+        value *= 1e6;
+    }
+    return static_cast<std::size_t>(value);
+}
+
+
+void usage() {
+    std::printf(
+        "usage: avl_bench [--min N] [--max N] [--filter TEXT] [--seed S] [--csv]\n"
+        "  --min N        smallest size (default 1K)\n"
+        "  --max N        largest size (default 1M; sizes grow by 10x, up to e.g. 100M)\n"
+        "  --filter TEXT  only run container/workload labels containing TEXT\n"
+        "  --seed S       random seed for the key sequences\n"
+        "  --csv          machine-readable output for regression tracking\n");
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--min" && i + 1 < argc) {
+            opts.min_size = parseSize(argv[++i]);
+        }
+        else if (arg == "--max" && i + 1 < argc) {
+            opts.max_size = parseSize(argv[++i]);
+        }
+        else if (arg == "--filter" && i + 1 < argc) {
+            opts.filter = argv[++i];
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            opts.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--csv") {
+            opts.csv = true;
+        }
+        else {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Reporter report(opts.csv);
+    for (std::size_t n = opts.min_size; n && n <= opts.max_size; n *= 10) {
+        Workload w = makeWorkload(n, opts.seed);
+        runContainer<std::set<Key> >("std::set", w, opts, report);
+        runContainer<AVLTree<Key> >("AVLTree", w, opts, report);
+        runContainer<AVLTree<Key, std::less<Key>, AVLPoolAllocator<Key> > >("AVLTree+pool", w, opts, report);
+        runContainer<AVLTree<Key, std::less<Key>, std::allocator<Key>, AVLStatsPolicy> >("AVLTree+stats", w, opts, report);
+        runContainer<AVLCompactTree<Key> >("AVLCompactTree", w, opts, report);
+        runContainer<AVLBlockTree<Key> >("AVLBlockTree", w, opts, report);
+        runContainer<AVLIndexedTree<Key> >("AVLIndexedTree", w, opts, report);
+        runFrozen("AVLFrozenTree", w, opts, report);
+    }
+    return 0;
+}